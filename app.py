@@ -36,6 +36,8 @@ try:
 except ImportError:
     sys.exit("Missing: flask\n  pip3 install flask")
 
+from log_codec import BINARY_MARKER, parse_binary_block
+
 app = Flask(__name__)
 APP_DIR = Path(__file__).resolve().parent
 
@@ -75,6 +77,7 @@ def _is_csv_data(line: str, ncols: int) -> bool:
 
 
 def _try_salvage_csv(line: str, ncols: int) -> str | None:
+    # old CSV logs only; serial_rx.py captures telemetry_v2 frames without loss
     parts = line.split(",")
     if len(parts) < ncols:
         return None
@@ -99,7 +102,16 @@ def parse_blocks(text: str) -> list[TestBlock]:
 
     while i < len(lines):
         line = lines[i].strip()
-        
+
+        if line == BINARY_MARKER:
+            res, i, meta, _expected = parse_binary_block(lines, i + 1, TEST_HEADERS)
+            if res.schema and res.rows:
+                df = pd.DataFrame(res.rows, columns=res.schema.fields)
+                note = "; ".join(res.warnings)
+                blocks.append(TestBlock(test_type=res.schema.name, df=df,
+                                        meta=meta + (" | " + note if note else "")))
+            continue
+
         test_type = None
         for key in sorted(TEST_HEADERS.keys(), key=len, reverse=True):
             if line == key or line.startswith(key + " "):
@@ -125,7 +137,7 @@ def parse_blocks(text: str) -> list[TestBlock]:
         while i < len(lines):
             row = lines[i].strip()
             is_new_test = any(row == k or row.startswith(k + " ") for k in TEST_HEADERS)
-            if not row or row.startswith("---") or is_new_test:
+            if not row or row.startswith("---") or is_new_test or row == BINARY_MARKER:
                 break
             if _is_csv_data(row, ncols):
                 csv_rows.append(row)
@@ -742,6 +754,37 @@ function renderTelemetryV1(div, trial) {
       ],
     });
     Plotly.newPlot(div, data, layout, plotConfig);
+  } else if (action === 8) { // Relay autotune: action 8 rows are the limit cycle, action 9 rows the results
+    const idx = c.action.map((a, i) => a === 8 ? i : -1).filter(i => i >= 0);
+    const pick = (col) => idx.map(i => col[i]);
+    const ts = pick(t);
+    const data = [
+      { x: ts, y: pick(c.current), name: 'Measured', type:'scatter', mode:'lines', line:{color:C.BLUE,width:1.5}, xaxis:'x', yaxis:'y' },
+      { x: ts, y: pick(c.target), name: 'Setpoint', type:'scatter', mode:'lines', line:{color:C.TEAL,width:1.2,dash:'dash'}, xaxis:'x', yaxis:'y' },
+      { x: ts, y: pick(c.total_out), name: 'Relay Output', type:'scatter', mode:'lines', line:{color:C.PEACH,width:1.5,shape:'hv'}, xaxis:'x2', yaxis:'y2' },
+    ];
+    const rules = ['Z-N', 'Pessen', 'Some OS', 'No OS'];
+    const dirs = { '0': 'both', '1': 'fwd', '-1': 'rev' };
+    const rows = [];
+    c.action.forEach((a, i) => {
+      if (a !== 9) return;
+      rows.push(`${rules[c.error[i]] || c.error[i]} ${dirs[String(c.aux_deriv[i])] || '?'}: ` +
+        `Ku=${c.target[i].toFixed(2)} Tu=${c.current[i].toFixed(3)} kp=${c.p_out[i].toFixed(3)} ` +
+        `ki=${c.i_out[i].toFixed(3)} kd=${c.d_out[i].toFixed(4)}`);
+    });
+    const layout = Object.assign(baseLayout('', 600), {
+      xaxis:  axisStyle('Time (s)', { domain: xL, anchor:'y' }),
+      xaxis2: axisStyle('Time (s)', { domain: xR, anchor:'y2' }),
+      yaxis:  axisStyle('deg',       { domain: [0.45, 1.0], anchor:'x' }),
+      yaxis2: axisStyle('Power (%)', { domain: [0.45, 1.0], anchor:'x2' }),
+      annotations: [
+        { text: '<b>Limit Cycle</b>',  x: 0.235, y: 1.04, xref:'paper', yref:'paper', showarrow: false, font:{color:C.TEXT,size:12} },
+        { text: '<b>Relay Output</b>', x: 0.765, y: 1.04, xref:'paper', yref:'paper', showarrow: false, font:{color:C.TEXT,size:12} },
+        { text: rows.length ? rows.join('<br>') : '(no result rows: experiment failed)', x: 0, y: 0.36, xref:'paper', yref:'paper',
+          xanchor:'left', yanchor:'top', align:'left', showarrow: false, font:{color:C.TEXT,size:11,family:'monospace'} },
+      ],
+    });
+    Plotly.newPlot(div, data, layout, plotConfig);
   } else { // Run / Straight
     const data = [
       { x: t, y: c.current, name: 'Enc pos', type:'scatter', mode:'lines', line:{color:C.BLUE,width:1.5}, xaxis:'x', yaxis:'y' },
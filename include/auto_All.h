@@ -161,7 +161,7 @@ void E_D()//从中桥到填装区到长桥
   Run(-30);
 
   Get_Ball(1);//0：停；1：中高桥；-1：低桥；2：吸球
-  while (Brain.timer(timeUnits::sec)<=14.8){}
+  while (Brain.timer(timeUnits::sec)<=14.8){task_spin("skill_hold");}
   Up.set(false);
   Load.set(false);
   wait(200);
@@ -0,0 +1,274 @@
+/**
+ * @file autotune.h
+ * @brief 继电反馈(Åström–Hägglund)PID 自整定: 原地转向与直线各一个测试模式
+ *
+ * 1. 以当前航向/编码器位置为设定值, 输出只取 ±relay 两个值(带滞环), 底盘在设定值附近自激振荡
+ * 2. 跳过前 AUTOTUNE_SKIP 个周期的过渡过程, 取后 AUTOTUNE_CYCLES 个周期的平均周期 Tu 与振幅 a
+ * 3. 临界增益 Ku = 4*relay / (π*sqrt(a² - ε²)), ε 为滞环宽度
+ * 4. 按选择的整定规则由 Ku/Tu 给出 kp/ki/kd
+ *
+ * 给出的 ki/kd 为连续时间单位(对 ∫e·dt 与 de/dt), 与 Turn_Gyro_new 一致;
+ * JAR_PID 按节拍累加/差分, 换算为 ki*CONTROL_DT 与 kd/CONTROL_DT 一并输出。
+ * 直线模式另按正负半波振幅分别给出前进/后退两套参数, 对应 run_gyro_JAR 的两套参数。
+ *
+ * 日志与其他测试共用 telemetry_v1:
+ *   action=8 为振荡过程(target 设定值, current 测量值, total_out 继电输出)
+ *   action=9 为整定结果, 每条规则一行:
+ *     target=Ku current=Tu error=规则编号 p_out/i_out/d_out=kp/ki/kd(连续单位)
+ *     aux_error=振幅 aux_deriv=方向(0 双向, 1 前进, -1 后退)
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 参数
+///////////////////////////////////////////////////////////////////////////////
+const int   AUTOTUNE_SKIP = 2;           // 丢弃的起振周期数
+const int   AUTOTUNE_CYCLES = 4;         // 参与平均的周期数
+const float AUTOTUNE_TIMEOUT = 8000;     // 单次实验超时(ms)
+const float AUTOTUNE_TURN_HYST = 1.0;    // 转向滞环(度)
+const float AUTOTUNE_DRIVE_HYST = 5.0;   // 直线滞环(编码器度)
+
+///////////////////////////////////////////////////////////////////////////////
+// 整定规则
+///////////////////////////////////////////////////////////////////////////////
+enum TuneRule {
+  TUNE_ZIEGLER_NICHOLS = 0,  // 经典 Z-N: 响应快, 过冲约 25%
+  TUNE_PESSEN,               // Pessen 积分规则: 更快, 过冲更大
+  TUNE_SOME_OVERSHOOT,       // 少量过冲
+  TUNE_NO_OVERSHOOT,         // 无过冲(底盘定位默认)
+  TUNE_RULE_COUNT
+};
+
+// kp = a*Ku, Ti = b*Tu, Td = c*Tu
+const float TUNE_RULE_TABLE[TUNE_RULE_COUNT][3] = {
+  {0.60, 0.50, 0.125},
+  {0.70, 0.40, 0.150},
+  {0.33, 0.50, 0.330},
+  {0.20, 0.50, 0.330},
+};
+const char *TUNE_RULE_NAME[TUNE_RULE_COUNT] = {"ziegler_nichols", "pessen", "some_overshoot", "no_overshoot"};
+
+struct PIDGains {
+    float kp, ki, kd;
+};
+
+/**
+ * @brief 按规则由临界增益/周期计算 PID 参数(连续时间单位)
+ */
+PIDGains tune_rule_gains(TuneRule rule, float ku, float tu)
+{
+  PIDGains g;
+  const float *r = TUNE_RULE_TABLE[rule];
+  g.kp = r[0] * ku;
+  g.ki = g.kp / (r[1] * tu);
+  g.kd = g.kp * r[2] * tu;
+  return g;
+}
+
+/**
+ * @brief 继电实验结果
+ */
+struct RelayResult {
+    bool ok;          // 是否采到足够的完整周期
+    int cycles;       // 参与平均的周期数
+    float tu;         // 平均周期(秒)
+    float amp;        // 平均半峰峰值
+    float amp_pos;    // 设定值上方的平均振幅(前进/顺时针)
+    float amp_neg;    // 设定值下方的平均振幅(后退/逆时针)
+};
+
+// 由振幅求临界增益(滞环修正); 振幅不大于滞环时返回 0
+float relay_ku(float relay, float amp, float hyst)
+{
+  if (amp <= hyst) return 0;
+  return 4 * relay / (3.14159265 * sqrt(amp * amp - hyst * hyst));
+}
+
+/**
+ * @brief 继电实验
+ * @param drive true: 直线(编码器度, 带航向保持); false: 原地转向(度)
+ * @param relay 继电输出幅值(功率), 需明显大于静摩擦 kS
+ * @param hyst 滞环宽度(与测量值同单位)
+ *
+ * 误差 e = 设定值 - 测量值; e > hyst 时输出 +relay, e < -hyst 时输出 -relay, 其间保持。
+ * 每次由负切到正记为一个周期的起点, 周期内记录测量值的最大/最小值。
+ */
+RelayResult relay_experiment(bool drive, float relay, float hyst)
+{
+  RelayResult res = {false, 0, 0, 0, 0, 0};
+  float setpoint = drive ? drive_position() : sensors().heading;
+  float heading0 = sensors().heading;
+  JAR_PID headingPID(0, 2.5, 0.0, 18.0, 0, 1.0, 100, 0); // 直线时保持航向, 同 run_gyro_JAR
+
+  float u = relay;             // 先正向推, 制造初始误差
+  int edges = 0;               // 已检测到的 负->正 切换次数
+  float t = 0, last_edge = 0;
+  float cyc_max = -1e9, cyc_min = 1e9;
+  float sum_tu = 0, sum_pos = 0, sum_neg = 0;
+  unsigned int tick = control_tick;
+  float dt = CONTROL_DT;   // 两次快照的实际间隔
+
+  while (t * 1000 < AUTOTUNE_TIMEOUT) {
+    float y = drive ? drive_position() : sensors().heading;
+    float e = setpoint - y;
+    if (y > cyc_max) cyc_max = y;
+    if (y < cyc_min) cyc_min = y;
+
+    if (e > hyst && u < 0) {
+      // 负 -> 正: 上一个完整周期结束
+      u = relay;
+      edges++;
+      if (edges > AUTOTUNE_SKIP + 1) {
+        sum_tu += t - last_edge;
+        sum_pos += cyc_max - setpoint;
+        sum_neg += setpoint - cyc_min;
+        res.cycles++;
+      }
+      last_edge = t;
+      cyc_max = -1e9;
+      cyc_min = 1e9;
+      if (res.cycles >= AUTOTUNE_CYCLES) break;
+    } else if (e < -hyst && u > 0) {
+      u = -relay;
+    }
+
+    float h = 0;
+    if (drive) {
+      h = headingPID.compute(reduce_negative_180_to_180(heading0 - sensors().heading), dt);
+      if (fabs(h) > 40) h = sgn(h) * 40;
+      Run_Ctrl(u + h, u - h);
+    } else {
+      Turn(u);
+    }
+
+    current_telemetry.action = 8; // 标记为 8 (继电自整定)
+    current_telemetry.target = setpoint;
+    current_telemetry.current = y;
+    current_telemetry.error = e;
+    current_telemetry.error_deriv = 0;
+    current_telemetry.dt = dt;
+    current_telemetry.p_out = 0;
+    current_telemetry.i_out = 0;
+    current_telemetry.d_out = 0;
+    current_telemetry.total_out = u;
+    current_telemetry.aux_error = drive ? headingPID.error : 0;
+    current_telemetry.aux_deriv = drive ? headingPID.current_deriv : 0;
+    current_telemetry.aux_out = h;
+    current_telemetry.gyro_pitch = sensors().pitch;
+    telemetry_publish(current_telemetry);
+
+    dt = control_wait(tick);
+    t += dt;
+  }
+  RunStop(brake);
+
+  if (res.cycles > 0) {
+    res.tu = sum_tu / res.cycles;
+    res.amp_pos = sum_pos / res.cycles;
+    res.amp_neg = sum_neg / res.cycles;
+    res.amp = (res.amp_pos + res.amp_neg) / 2;
+    res.ok = res.cycles >= AUTOTUNE_CYCLES && res.amp > hyst;
+  }
+  return res;
+}
+
+// 把一条整定结果追加到日志缓冲(日志任务已停止后调用)
+void autotune_log_result(TuneRule rule, float ku, float tu, float amp, int dir)
+{
+  if (test_log_count >= TEST_LOG_MAX) return;
+  PIDGains g = tune_rule_gains(rule, ku, tu);
+  TestLogEntry &e = test_log_buf[test_log_count++];
+  e.time_s = test_log_count > 1 ? test_log_buf[test_log_count - 2].time_s : 0;
+  e.left_avg = 0;
+  e.right_avg = 0;
+  e.t = {0};
+  e.t.action = 9;
+  e.t.target = ku;
+  e.t.current = tu;
+  e.t.error = rule;
+  e.t.p_out = g.kp;
+  e.t.i_out = g.ki;
+  e.t.d_out = g.kd;
+  e.t.aux_error = amp;
+  e.t.aux_deriv = dir;
+}
+
+// 输出一行建议参数: 连续单位 + JAR_PID 节拍单位
+void autotune_print(const char *mode, const char *dir, TuneRule rule, float ku, float tu)
+{
+  PIDGains g = tune_rule_gains(rule, ku, tu);
+  printf("autotune: mode=%s dir=%s rule=%s Ku=%.3f Tu=%.3fs kp=%.3f ki=%.3f kd=%.4f jar_ki=%.4f jar_kd=%.3f\n",
+         mode, dir, TUNE_RULE_NAME[rule], ku, tu, g.kp, g.ki, g.kd, g.ki * CONTROL_DT, g.kd / CONTROL_DT);
+}
+
+/**
+ * @brief 原地转向继电自整定
+ * @param relay 继电输出幅值(功率)
+ * @param rule 建议参数使用的整定规则 TuneRule(日志中包含全部规则)
+ *
+ * 结果对应 Turn_Gyro_new 的 kp/ki/kd; turn_side_JAR 等 JAR 控制器取 jar_ki/jar_kd。
+ */
+void test_autotune_turn(float relay = 30, int rule = TUNE_NO_OVERSHOOT)
+{
+  if (rule < 0 || rule >= TUNE_RULE_COUNT) rule = TUNE_NO_OVERSHOOT;
+  Side = 1;
+  current_telemetry = {0};
+  current_telemetry.action = 8; // 日志首行即标记为继电实验, 便于上位机识别
+  printf("test_autotune_turn\n");
+  test_log_start();
+
+  RelayResult r = relay_experiment(false, relay, AUTOTUNE_TURN_HYST);
+
+  test_log_active = false;
+  vex::task::sleep(100);
+  if (!r.ok) {
+    printf("autotune: mode=turn failed cycles=%d amp=%.2f\n", r.cycles, r.amp);
+  } else {
+    float ku = relay_ku(relay, r.amp, AUTOTUNE_TURN_HYST);
+    for (int i = 0; i < TUNE_RULE_COUNT; i++) autotune_log_result((TuneRule)i, ku, r.tu, r.amp, 0);
+    autotune_print("turn", "both", (TuneRule)rule, ku, r.tu);
+  }
+  test_log_dump();
+  printf("--- test_autotune_turn complete, relay=%.0f ---\n", relay);
+  vex::task::sleep(500);
+}
+
+/**
+ * @brief 直线继电自整定(带航向保持)
+ * @param relay 继电输出幅值(功率)
+ * @param rule 建议参数使用的整定规则 TuneRule(日志中包含全部规则)
+ *
+ * 双向振幅给出一套参数, 正/负半波振幅分别给出前进/后退两套,
+ * 对应 run_gyro_JAR 中按方向分开的 drive_kp/ki/kd(取 jar_ki/jar_kd)。
+ */
+void test_autotune_drive(float relay = 30, int rule = TUNE_NO_OVERSHOOT)
+{
+  if (rule < 0 || rule >= TUNE_RULE_COUNT) rule = TUNE_NO_OVERSHOOT;
+  Side = 1;
+  current_telemetry = {0};
+  current_telemetry.action = 8; // 日志首行即标记为继电实验, 便于上位机识别
+  printf("test_autotune_drive\n");
+  test_log_start();
+
+  RelayResult r = relay_experiment(true, relay, AUTOTUNE_DRIVE_HYST);
+
+  test_log_active = false;
+  vex::task::sleep(100);
+  if (!r.ok) {
+    printf("autotune: mode=drive failed cycles=%d amp=%.2f\n", r.cycles, r.amp);
+  } else {
+    float ku = relay_ku(relay, r.amp, AUTOTUNE_DRIVE_HYST);
+    float ku_fwd = relay_ku(relay, r.amp_pos, AUTOTUNE_DRIVE_HYST);
+    float ku_rev = relay_ku(relay, r.amp_neg, AUTOTUNE_DRIVE_HYST);
+    for (int i = 0; i < TUNE_RULE_COUNT; i++) {
+      autotune_log_result((TuneRule)i, ku, r.tu, r.amp, 0);
+      if (ku_fwd > 0) autotune_log_result((TuneRule)i, ku_fwd, r.tu, r.amp_pos, 1);
+      if (ku_rev > 0) autotune_log_result((TuneRule)i, ku_rev, r.tu, r.amp_neg, -1);
+    }
+    autotune_print("drive", "both", (TuneRule)rule, ku, r.tu);
+    if (ku_fwd > 0) autotune_print("drive", "fwd", (TuneRule)rule, ku_fwd, r.tu);
+    if (ku_rev > 0) autotune_print("drive", "rev", (TuneRule)rule, ku_rev, r.tu);
+  }
+  test_log_dump();
+  printf("--- test_autotune_drive complete, relay=%.0f ---\n", relay);
+  vex::task::sleep(500);
+}
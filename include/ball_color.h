@@ -0,0 +1,246 @@
+/**
+ * @file ball_color.h
+ * @brief 球颜色分类: 色相 + 饱和度 + 亮度 + 接近检测, 每个颜色传感器一组阈值
+ *
+ * 1. 不再用 optical::color() 的枚举: 它在场馆灯光下和高速过球时容易误判
+ * 2. 判色条件: 接近检测为真, 亮度 >= min_bright, 饱和度 >= min_sat,
+ *    色相与红/蓝中心的圆周距离在各自容差内(取较近的一类)
+ * 3. 阈值由 calibrate_ball_colors() 现场采样拟合(开机选自动界面按手柄 X 进入): 分别过红球、蓝球,
+ *    不接近时的读数作为背景; 拟合结果直接生效, 并存到 SD 卡 ball_models.bin
+ * 4. 开机时 pre_auton() 调用 ball_models_load() 读回上次标定的阈值; 没插卡、没有文件或文件损坏
+ *    (长度、版本或 CRC 不对)时沿用下面编译进去的默认值
+ *
+ * 读数统一用 sensors.h 的 OpticalReading(饱和度与亮度百分比由 getRgb(false) 计算)。
+ * VEX 的 C++ 接口没有原始接近值, 接近条件用 isNearObject() 加亮度阈值。
+ * 分类结果: 1 红, -1 蓝, 0 无球或不确定(与 Alliance 取值一致)。
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 每个传感器的阈值
+///////////////////////////////////////////////////////////////////////////////
+enum BallSensor { BALL_LOW = 0, BALL_UP = 1, BALL_OUT = 2, BALL_SENSORS = 3 }; // Color_2, Color, Color_3
+
+struct BallColorModel {
+    float red_hue;      // 红球色相中心(度)
+    float red_tol;      // 红球色相容差(度)
+    float blue_hue;     // 蓝球色相中心(度)
+    float blue_tol;     // 蓝球色相容差(度)
+    float min_sat;      // 有色球最低饱和度(0-1)
+    float min_bright;   // 有球时最低亮度(%)
+};
+
+// 默认值与原先固定的色相区间一致: 红 <30 或 >330, 蓝 180~260
+BallColorModel ball_models[BALL_SENSORS] = {
+    {0, 30, 220, 40, 0.3, 20},   // Color_2 进球口下方
+    {0, 30, 220, 40, 0.3, 20},   // Color   进球口上方
+    {0, 30, 220, 40, 0.3, 20},   // Color_3 吐球口
+};
+
+const char *ball_sensor_name[BALL_SENSORS] = {"low", "up", "out"};
+
+///////////////////////////////////////////////////////////////////////////////
+// SD 卡存取
+///////////////////////////////////////////////////////////////////////////////
+const char *const BALL_MODEL_FILE = "ball_models.bin";
+const unsigned int BALL_MODEL_MAGIC = 0x314D4342;   // "BCM1"
+
+struct BallModelFile {
+    unsigned int magic;
+    BallColorModel models[BALL_SENSORS];
+    unsigned short crc;      // magic + models 的 crc16_ccitt(log_codec.h)
+};
+const int BALL_MODEL_CRC_LEN = sizeof(unsigned int) + sizeof(BallColorModel) * BALL_SENSORS;
+
+/**
+ * @brief 把当前阈值写到 SD 卡
+ * @return 是否写入成功
+ */
+bool ball_models_save()
+{
+  if (!Brain.SDcard.isInserted()) {
+    printf("ball_model: save skipped, no SD card\n");
+    return false;
+  }
+  BallModelFile f;
+  memset(&f, 0, sizeof(f));
+  f.magic = BALL_MODEL_MAGIC;
+  memcpy(f.models, ball_models, sizeof(ball_models));
+  f.crc = crc16_ccitt((const unsigned char *)&f, BALL_MODEL_CRC_LEN);
+  int n = Brain.SDcard.savefile(BALL_MODEL_FILE, (unsigned char *)&f, sizeof(f));
+  printf("ball_model: saved=%d file=%s\n", n == (int)sizeof(f), BALL_MODEL_FILE);
+  return n == (int)sizeof(f);
+}
+
+/**
+ * @brief 开机读回 SD 卡上的阈值, 读不到时保留默认值
+ * @return 是否读到有效的标定
+ */
+bool ball_models_load()
+{
+  BallModelFile f;
+  if (!Brain.SDcard.isInserted() || !Brain.SDcard.exists(BALL_MODEL_FILE) ||
+      Brain.SDcard.size(BALL_MODEL_FILE) != (int)sizeof(f) ||
+      Brain.SDcard.loadfile(BALL_MODEL_FILE, (unsigned char *)&f, sizeof(f)) != (int)sizeof(f) ||
+      f.magic != BALL_MODEL_MAGIC ||
+      f.crc != crc16_ccitt((const unsigned char *)&f, BALL_MODEL_CRC_LEN)) {
+    printf("ball_model: loaded=0, using defaults\n");
+    return false;
+  }
+  memcpy(ball_models, f.models, sizeof(ball_models));
+  printf("ball_model: loaded=1 file=%s\n", BALL_MODEL_FILE);
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 分类
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief 色相圆周距离(0~180度)
+ */
+float hue_distance(float a, float b)
+{
+  float d = fmod(fabs(a - b), 360.0f);
+  return d > 180 ? 360 - d : d;
+}
+
+/**
+ * @brief 单次读数分类
+ * @param sensor BALL_LOW / BALL_UP / BALL_OUT
+ * @return 1 红, -1 蓝, 0 无球或不确定
+ */
+int ball_classify(int sensor, bool near, float hue, float sat, float bright)
+{
+  const BallColorModel &m = ball_models[sensor];
+  if (!near || bright < m.min_bright || sat < m.min_sat) return 0;
+  float dr = hue_distance(hue, m.red_hue);
+  float db = hue_distance(hue, m.blue_hue);
+  if (dr <= m.red_tol && dr <= db) return 1;
+  if (db <= m.blue_tol) return -1;
+  return 0;
+}
+
+int ball_classify(int sensor, const OpticalReading &r)
+{
+  return ball_classify(sensor, r.near, r.hue, r.saturation, r.brightness);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 现场标定
+///////////////////////////////////////////////////////////////////////////////
+struct BallCalibStats {
+    int n;
+    double hx, hy;          // 色相单位向量和(圆周均值)
+    double sat, bright;     // 饱和度/亮度和
+};
+
+BallCalibStats ball_calib[BALL_SENSORS][3];   // [传感器][0 红, 1 蓝, 2 背景]
+
+void ball_calib_reset()
+{
+  for (int s = 0; s < BALL_SENSORS; s++)
+    for (int c = 0; c < 3; c++) ball_calib[s][c] = {0, 0, 0, 0, 0};
+}
+
+/**
+ * @brief 采样一段时间: 接近时的读数计入 color 类, 不接近时计入背景
+ * @param color 1 红, -1 蓝(这段时间只过这一种颜色的球)
+ * @param ms 采样时长
+ */
+void ball_calib_capture(int color, int ms)
+{
+  optical *sensors[BALL_SENSORS] = {&Color_2, &Color, &Color_3};
+  unsigned int t0 = timer::system();
+  while (timer::system() - t0 < (unsigned int)ms) {
+    for (int s = 0; s < BALL_SENSORS; s++) {
+      OpticalReading r = optical_read(*sensors[s]);
+      BallCalibStats &st = ball_calib[s][r.near ? (color > 0 ? 0 : 1) : 2];
+      st.n++;
+      st.hx += cos(r.hue * 3.14159265 / 180.0);
+      st.hy += sin(r.hue * 3.14159265 / 180.0);
+      st.sat += r.saturation;
+      st.bright += r.brightness;
+    }
+    wait(5, msec);
+  }
+}
+
+/**
+ * @brief 由圆周均值的向量长度估计色相标准差(度)
+ */
+float calib_hue_spread(const BallCalibStats &st)
+{
+  double r = sqrt(st.hx * st.hx + st.hy * st.hy) / st.n;
+  if (r >= 1) return 0;
+  return sqrt(-2 * log(r)) * 180 / 3.14159265;
+}
+
+float calib_hue_mean(const BallCalibStats &st)
+{
+  float h = atan2(st.hy, st.hx) * 180 / 3.14159265;
+  return h < 0 ? h + 360 : h;
+}
+
+/**
+ * @brief 由采样拟合阈值并生效
+ * 色相容差取 4 倍标准差(不小于 15 度), 且不超过红蓝中心距离的一半;
+ * 饱和度与亮度阈值取背景均值与两色球均值中较小者的中点。
+ * 每个传感器红、蓝样本各至少 10 个才更新, 否则保留原值。有传感器更新时存到 SD 卡。
+ * 输出: ball_model: sensor=.. red_hue= red_tol= blue_hue= blue_tol= min_sat= min_bright= n=红/蓝/背景
+ */
+void ball_calib_finish()
+{
+  int updated = 0;
+  for (int s = 0; s < BALL_SENSORS; s++) {
+    BallCalibStats &r = ball_calib[s][0], &b = ball_calib[s][1], &bg = ball_calib[s][2];
+    if (r.n < 10 || b.n < 10) {
+      printf("ball_model: sensor=%s skipped n=%d/%d/%d\n", ball_sensor_name[s], r.n, b.n, bg.n);
+      continue;
+    }
+    BallColorModel m;
+    m.red_hue = calib_hue_mean(r);
+    m.blue_hue = calib_hue_mean(b);
+    float half_gap = hue_distance(m.red_hue, m.blue_hue) / 2;
+    m.red_tol = fmin(fmax(4 * calib_hue_spread(r), 15.0f), half_gap);
+    m.blue_tol = fmin(fmax(4 * calib_hue_spread(b), 15.0f), half_gap);
+    float ball_sat = fmin(r.sat / r.n, b.sat / b.n);
+    float ball_bright = fmin(r.bright / r.n, b.bright / b.n);
+    float bg_sat = bg.n ? bg.sat / bg.n : 0;
+    float bg_bright = bg.n ? bg.bright / bg.n : 0;
+    m.min_sat = (ball_sat + bg_sat) / 2;
+    m.min_bright = (ball_bright + bg_bright) / 2;
+    ball_models[s] = m;
+    updated++;
+    printf("ball_model: sensor=%s red_hue=%.1f red_tol=%.1f blue_hue=%.1f blue_tol=%.1f min_sat=%.2f min_bright=%.1f n=%d/%d/%d\n",
+           ball_sensor_name[s], m.red_hue, m.red_tol, m.blue_hue, m.blue_tol, m.min_sat, m.min_bright, r.n, b.n, bg.n);
+  }
+  if (updated) ball_models_save();
+}
+
+/**
+ * @brief 现场标定流程(手柄提示): 先过红球, 再过蓝球, 各采样 5 秒
+ * 采样时吸球与分球电机低速正转、关闭自动分球, 操作手按 A 开始每一段。
+ */
+void calibrate_ball_colors()
+{
+  auto_color_ctrl = 0;
+  ball_calib_reset();
+  const char *prompt[2] = {"RED balls, A", "BLUE balls, A"};
+  int colors[2] = {1, -1};
+  for (int i = 0; i < 2; i++) {
+    Controller1.Screen.clearLine(3);
+    Controller1.Screen.setCursor(3, 1);
+    Controller1.Screen.print(prompt[i]);
+    while (!Controller1.ButtonA.pressing()) wait(20, msec);
+    while (Controller1.ButtonA.pressing()) wait(20, msec);
+    Intake(30);
+    Ball(30);
+    ball_calib_capture(colors[i], 5000);
+    Intake(0);
+    Ball(0);
+  }
+  ball_calib_finish();
+  Controller1.Screen.clearLine(3);
+  Controller1.Screen.setCursor(3, 1);
+  Controller1.Screen.print("calib done");
+}
@@ -0,0 +1,181 @@
+/**
+ * @file boomerang.h
+ * @brief 到位姿(Boomerang)控制: 一次运动开到 (x, y) 并以航向 θ 停下
+ *
+ * 每个节拍在目标点后方放一个"胡萝卜点":
+ *   carrot = 目标点 - lead * 当前距离 * (目标航向方向)
+ * 车头追胡萝卜点, 离得越近胡萝卜点越贴近目标, 轨迹自然弯成弧线并以目标航向进入。
+ * 距离小于 BOOMERANG_PIN 后不再追点, 角度环改为直接对准目标航向, 直线环只沿车头方向收敛。
+ *
+ * 退出规则(与 JAR_PID::is_settled 同样的思路):
+ * 1. 距离 < settle_error 且 航向误差 < heading_settle, 持续 settle_time
+ * 2. 两个误差都在 1.5 倍容差内且底盘基本静止, 立即退出
+ * 3. 超时
+ * 坐标为 odom.h 场地坐标(mm / 度)。
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 参数
+///////////////////////////////////////////////////////////////////////////////
+const float BOOMERANG_PIN = 120;            // 小于此距离后锁定最终航向(mm)
+const float BOOMERANG_SETTLE_ERROR = 10;    // 位置稳定误差(mm)
+const float BOOMERANG_HEADING_SETTLE = 2;   // 航向稳定误差(度)
+const float BOOMERANG_SETTLE_TIME = 60;     // 稳定时间(ms)
+
+/**
+ * @brief 到位姿运动
+ * @param x 目标场地坐标(mm)
+ * @param y 目标场地坐标(mm)
+ * @param theta 目标航向(度, 场地坐标)
+ * @param lead 胡萝卜点提前系数(0~1), 越大弧线越宽
+ * @param max_voltage 最大输出功率 (0-100)
+ * @param timeout 超时(ms)
+ * @param reverse 是否倒车进入
+ * @return 运动结果(motion_result.h), 目标和误差为到目标点的距离(mm)
+ */
+MotionResult move_to_pose(float x, float y, float theta, float lead = 0.6, float max_voltage = 100, float timeout = 3000, bool reverse = false)
+{
+  bool chained = motion_begin();
+  MotionWatch watch("move_to_pose", timeout + WATCHDOG_MARGIN_MS);
+  float chain_exit = chain_exit_error(CHAIN_DRIVE_EXIT) * ODOM_MM_PER_DEG;
+  now = (theta - Start) * Side;   // 与转向函数一致, now 记录换算前的目标航向
+
+  // 直线环: 误差单位 mm(JAR 直线参数按 ODOM_MM_PER_DEG 换算); 角度环: 误差单位度
+  JAR_PID linearPID(0, 0.6, 0, 2.5, 0, BOOMERANG_SETTLE_ERROR, BOOMERANG_SETTLE_TIME, 0);
+  JAR_PID angularPID(0, 2.5, 0, 18.0, 0, BOOMERANG_HEADING_SETTLE, BOOMERANG_SETTLE_TIME, 0);
+
+  Pose start = odom_pose();
+  float total = sqrt((x - start.x) * (x - start.x) + (y - start.y) * (y - start.y));
+  float time_spent = 0, time_settled = 0;
+  float last_dist = total;
+  float lin_out = 0;
+  float tr = theta * 3.14159265 / 180.0;
+  unsigned int tick = control_tick;
+  float dt = CONTROL_DT;   // 两次快照的实际间隔
+  MotionMeter meter("move_to_pose", total, total, BOOMERANG_SETTLE_ERROR);
+  bool settled = false, chain_hit = false;
+
+  while (time_spent < timeout && !motion_cancelled()) {
+    Pose p = odom_pose();
+    float heading = p.theta + (reverse ? 180 : 0);
+    float dx = x - p.x, dy = y - p.y;
+    float dist = sqrt(dx * dx + dy * dy);
+    motion_progress(total - dist, total);
+    meter.update(dist);
+
+    // 胡萝卜点: 沿目标航向反方向后退 lead*dist(倒车时目标航向反向)
+    float sign = reverse ? -1 : 1;
+    float cx = x - sign * lead * dist * sin(tr);
+    float cy = y - sign * lead * dist * cos(tr);
+
+    float ang_err, lin_err;
+    float final_err = reduce_negative_180_to_180(theta - p.theta);
+    if (dist > BOOMERANG_PIN) {
+      float ccx = cx - p.x, ccy = cy - p.y;
+      float to_carrot = atan2(ccx, ccy) * 180 / 3.14159265;
+      ang_err = reduce_negative_180_to_180(to_carrot - heading);
+      // 只按车头方向的分量前进, 朝向偏差大时自动减速
+      lin_err = sqrt(ccx * ccx + ccy * ccy) * cos(ang_err * 3.14159265 / 180.0);
+    } else {
+      ang_err = final_err;
+      float hr = heading * 3.14159265 / 180.0;
+      lin_err = dx * sin(hr) + dy * cos(hr);
+    }
+
+    lin_out = linearPID.compute(lin_err, dt);
+    float ang_out = angularPID.compute(ang_err, dt);
+    // 末段补静摩擦前馈(同 run_gyro_profile), 避免小输出推不动底盘; 倒车时按实际行驶方向取 kS
+    if (dist < BOOMERANG_PIN && dist > BOOMERANG_SETTLE_ERROR / 2) {
+      float move = reverse ? -lin_err : lin_err;
+      float ks = (ff_left_static(move) + ff_right_static(move)) / 2;
+      lin_out += reverse ? -ks : ks;
+    }
+    if (fabs(lin_out) > max_voltage) lin_out = sgn(lin_out) * max_voltage;
+    if (fabs(ang_out) > max_voltage) ang_out = sgn(ang_out) * max_voltage;
+    // 两环叠加超过上限时优先保证转向, 防止弧线被压直
+    if (fabs(lin_out) + fabs(ang_out) > max_voltage) {
+      lin_out = sgn(lin_out) * (max_voltage - fabs(ang_out));
+    }
+    if (reverse) lin_out = -lin_out;
+
+    current_telemetry.action = 7; // 标记为 7 (到位姿)
+    current_telemetry.target = 0;
+    current_telemetry.current = dist;
+    current_telemetry.error = lin_err;
+    current_telemetry.error_deriv = linearPID.current_deriv;
+    current_telemetry.dt = dt;
+    current_telemetry.p_out = linearPID.kp * lin_err;
+    current_telemetry.i_out = 0;
+    current_telemetry.d_out = linearPID.kd * linearPID.current_deriv;
+    current_telemetry.total_out = lin_out;
+    current_telemetry.aux_error = ang_err;
+    current_telemetry.aux_deriv = angularPID.current_deriv;
+    current_telemetry.aux_out = ang_out;
+    current_telemetry.gyro_pitch = sensors().pitch;
+    telemetry_publish(current_telemetry);
+
+    Run_Ctrl(lin_out + ang_out, lin_out - ang_out);
+
+    // 退出判断
+    if (chained && dist < chain_exit) {
+      chain_hit = true;
+      break;
+    }
+    if (dist < BOOMERANG_SETTLE_ERROR && fabs(final_err) < BOOMERANG_HEADING_SETTLE) time_settled += dt * 1000;
+    else time_settled = 0;
+    float speed = fabs(dist - last_dist) / dt; // mm/s
+    last_dist = dist;
+    settled = time_settled > BOOMERANG_SETTLE_TIME ||
+              (dist < BOOMERANG_SETTLE_ERROR * 1.5 && fabs(final_err) < BOOMERANG_HEADING_SETTLE * 1.5 &&
+               speed < 20 && fabs(angularPID.current_deriv) < 0.3);
+    if (settled) break;
+
+    dt = control_wait(tick);
+    time_spent += dt * 1000;
+  }
+  if (motion_should_stop()) RunStop(brake);
+  // 链式退出时目标点在车头方向上还差的距离(倒车为负), 交给下一段直线
+  Pose fin = odom_pose();
+  float fr = fin.theta * 3.14159265 / 180.0;
+  motion_end(lin_out, ((x - fin.x) * sin(fr) + (y - fin.y) * cos(fr)) / ODOM_MM_PER_DEG);
+  return meter.finish(settled, chain_hit);
+}
+
+/**
+ * @brief 到位姿测试函数(含遥测日志)
+ * @param three_step false: move_to_pose 一次到位; true: 转向 -> 直线 -> 转向三段(对照)
+ *
+ * 以当前位置为原点开到 (500, 800) 并朝向 90 度, 输出一行汇总:
+ * boomerang: mode=.. time=用时 pos_err=位置误差(mm) heading_err=航向误差(度)
+ */
+void test_boomerang(bool three_step = false)
+{
+  Side = 1;
+  Start = sensors().heading;
+  now = 0;
+  odom_set_pose(0, 0, 0);
+  float tx = 500, ty = 800, tt = 90;
+
+  current_telemetry = {0};
+  printf("test_boomerang_%s\n", three_step ? "three_step" : "pose");
+  test_log_start();
+
+  unsigned int t0 = timer::system();
+  if (three_step) {
+    float heading = atan2(tx, ty) * 180 / 3.14159265;
+    Turn_Gyro_new(heading);
+    run_gyro_JAR(sqrt(tx * tx + ty * ty) / ODOM_MM_PER_DEG, heading);
+    Turn_Gyro_new(tt);
+  } else {
+    move_to_pose(tx, ty, tt);
+  }
+  unsigned int t1 = timer::system();
+
+  test_log_active = false;
+  vex::task::sleep(300);
+  Pose p = odom_pose();
+  test_log_dump();
+  printf("boomerang: mode=%s time=%.3fs pos_err=%.1f heading_err=%.2f\n",
+         three_step ? "three_step" : "pose", (t1 - t0) / 1000.0,
+         sqrt((tx - p.x) * (tx - p.x) + (ty - p.y) * (ty - p.y)), reduce_negative_180_to_180(tt - p.theta));
+}
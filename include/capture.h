@@ -0,0 +1,197 @@
+/**
+ * @file capture.h
+ * @brief 异常窗口抓取: 持续覆盖的预触发环, 出现异常时冻结触发前后一段样本, 赛后统一输出
+ *
+ * 1. 挂在 100Hz 执行器上, 每节拍往预触发环写一条样本, 环满了直接覆盖最旧的样本, 平时不输出任何东西:
+ *    上一节拍有运动函数 telemetry_publish() 过, 就取那条完整样本(遥测与快照同一节拍, 晚一拍入环);
+ *    没有运动在发布时只记本节拍快照(sensors.h), 遥测字段为 0
+ * 2. 触发源(原因见 void.h 的 CaptureReason):
+ *    - JAR_PID 因超时退出(run_gyro_JAR / turn_side_JAR), Turn_Gyro_new 超时
+ *    - Wall_Stop 检测到堵转
+ *    - run_gyro_JAR 行驶中航向误差比本段运动中最小时大出 heading_error(按遥测检测, 每段运动最多一次;
+ *      直线带转向时起步误差大是正常的, 只看误差重新变大)
+ *    - 看门狗(watchdog.h)结束了运动
+ * 3. 触发后再采 post_ms, 把触发前 pre_ms 到触发后 post_ms 的样本拷进一个窗口,
+ *    样本时间改为相对触发时刻(触发前为负)。采集期间的其它触发合并进同一窗口
+ * 4. 最多保留 CAPTURE_WINDOWS 个窗口(保留最早的, 之后的触发只计数),
+ *    capture_dump() 逐个窗口按 telemetry_v2 块输出, plot.py/app.py 直接画图
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 参数(可在运行中修改)
+///////////////////////////////////////////////////////////////////////////////
+struct CaptureConfig {
+    int pre_ms;             // 触发前保留的时长
+    int post_ms;            // 触发后继续采集的时长
+    float heading_error;    // run_gyro_JAR 航向误差回升超过此值触发(度), 0 关闭
+};
+
+CaptureConfig capture_cfg = {1000, 500, 10};
+
+const unsigned int CAPTURE_RING = 256;   // 预触发环容量(2.56 秒), 须为 2 的幂
+const int CAPTURE_WINDOWS = 4;           // 最多保留的窗口数
+const int CAPTURE_WINDOW_MAX = 200;      // 单个窗口最多样本数(pre + post 超出时截掉最早的)
+
+///////////////////////////////////////////////////////////////////////////////
+// 状态
+///////////////////////////////////////////////////////////////////////////////
+struct CaptureWindow {
+    int reason;               // CaptureReason
+    float value;              // 触发时的相关数值(剩余误差/转速/航向误差)
+    uint64_t trigger_us;      // 触发时刻(微秒)
+    int triggers;             // 本窗口采集期间的触发次数(含第一次)
+    int count;                // 样本数
+    TestLogEntry samples[CAPTURE_WINDOW_MAX];
+};
+
+TelemetrySample capture_ring[CAPTURE_RING];
+unsigned int capture_head = 0;            // 下一个样本写入位置(只由执行器写)
+CaptureWindow capture_windows[CAPTURE_WINDOWS];
+int capture_count = 0;                    // 已冻结的窗口数
+unsigned int capture_missed = 0;          // 窗口已满时丢掉的触发次数
+
+volatile bool capture_pending = false;    // 已触发, 正在采触发后的样本
+unsigned int capture_trigger_head = 0;    // 触发时的 capture_head
+unsigned int capture_heading_id = 0;      // 正在检测航向误差的运动编号
+float capture_heading_min = 0;            // 本段运动中航向误差绝对值的最小值
+bool capture_heading_done = false;        // 本段运动已触发过
+
+const char *capture_reason_name(int reason)
+{
+  switch (reason) {
+    case CAPTURE_JAR_TIMEOUT: return "jar_timeout";
+    case CAPTURE_WALL_STALL: return "wall_stall";
+    case CAPTURE_HEADING: return "heading";
+    case CAPTURE_WATCHDOG: return "watchdog";
+    default: return "manual";
+  }
+}
+
+/**
+ * @brief 触发一次抓取(任意任务调用, 不阻塞)
+ */
+void capture_trigger(int reason, float value)
+{
+  if (capture_pending) {
+    capture_windows[capture_count].triggers++;
+    return;
+  }
+  if (capture_count >= CAPTURE_WINDOWS) {
+    capture_missed++;
+    return;
+  }
+  CaptureWindow &w = capture_windows[capture_count];
+  w.reason = reason;
+  w.value = value;
+  w.trigger_us = clock_us();
+  w.triggers = 1;
+  w.count = 0;
+  capture_trigger_head = capture_head;
+  __sync_synchronize();
+  capture_pending = true;
+}
+
+// 触发后的样本采够了: 把 [触发前 pre, 当前) 拷进窗口
+void capture_freeze()
+{
+  CaptureWindow &w = capture_windows[capture_count];
+  unsigned int pre = capture_cfg.pre_ms / CONTROL_PERIOD_MS;
+  unsigned int start = capture_trigger_head > pre ? capture_trigger_head - pre : 0;
+  if (capture_head - start > CAPTURE_RING) start = capture_head - CAPTURE_RING;
+  if (capture_head - start > (unsigned int)CAPTURE_WINDOW_MAX) start = capture_head - CAPTURE_WINDOW_MAX;
+  for (unsigned int i = start; i != capture_head; i++) {
+    const TelemetrySample &s = capture_ring[i % CAPTURE_RING];
+    TestLogEntry &e = w.samples[w.count++];
+    e.time_s = (int)(s.time_us - w.trigger_us) / 1e6;
+    e.left_avg = s.left_avg;
+    e.right_avg = s.right_avg;
+    e.t = s.t;
+  }
+  printf("capture: window=%d reason=%s t=%u value=%.2f samples=%d\n",
+         capture_count, capture_reason_name(w.reason), (unsigned int)(w.trigger_us / 1000), w.value, w.count);
+  capture_count++;
+  capture_pending = false;
+}
+
+/**
+ * @brief 执行器任务: 写预触发环, 检查航向误差, 到时冻结窗口
+ */
+void capture_job(float dt)
+{
+  SensorSnapshot snap = sensors();
+  TelemetrySample latest = telemetry_read_latest();
+  TelemetrySample &s = capture_ring[capture_head % CAPTURE_RING];
+  if (latest.time_us && latest.tick + 1 == snap.tick) {
+    s = latest;   // 运动函数上一节拍发布的完整样本
+  } else {
+    s.time_us = snap.time_us;
+    s.tick = snap.tick;
+    s.left_avg = snap.left_speed;
+    s.right_avg = snap.right_speed;
+    s.t = TelemetryData();
+  }
+  capture_head++;
+
+  // run_gyro_JAR 的航向误差在遥测的 aux_error 里
+  if (capture_cfg.heading_error > 0 && drive_motion.running && s.t.action == 3) {
+    float err = fabs(s.t.aux_error);
+    if (drive_motion.id != capture_heading_id) {
+      capture_heading_id = drive_motion.id;
+      capture_heading_min = err;
+      capture_heading_done = false;
+    }
+    if (err < capture_heading_min) capture_heading_min = err;
+    if (!capture_heading_done && err - capture_heading_min > capture_cfg.heading_error) {
+      capture_heading_done = true;
+      capture_trigger(CAPTURE_HEADING, s.t.aux_error);
+    }
+  }
+
+  if (capture_pending && capture_head - capture_trigger_head >= (unsigned int)(capture_cfg.post_ms / CONTROL_PERIOD_MS))
+    capture_freeze();
+}
+bool capture_started = control_register(capture_job);
+
+/**
+ * @brief 清空已冻结的窗口
+ */
+void capture_clear()
+{
+  capture_count = 0;
+  capture_missed = 0;
+}
+
+/**
+ * @brief 串口输出全部窗口(跑完后调用), 每个窗口一个 telemetry_v2 块
+ * capture: window= reason= t= value= triggers= samples=
+ * capture: windows= missed=
+ */
+void capture_dump()
+{
+  while (capture_pending) task::sleep(CONTROL_PERIOD_MS);   // 等正在采集的窗口采完
+  for (int i = 0; i < capture_count; i++) {
+    CaptureWindow &w = capture_windows[i];
+    printf("capture: window=%d reason=%s t=%u value=%.2f triggers=%d samples=%d\n",
+           i, capture_reason_name(w.reason), (unsigned int)(w.trigger_us / 1000), w.value, w.triggers, w.count);
+    log_dump_entries(w.samples, w.count, 0);
+  }
+  printf("capture: windows=%d missed=%u\n", capture_count, capture_missed);
+}
+
+/**
+ * @brief 抓取测试: 倒车撞墙(Wall_Stop 堵转), 再往墙里开一段 JAR 直线(超时), 输出两个窗口
+ * 顶墙的 JAR 直线原地不动, 看门狗 1 秒无进展会先结束它; 第二段关掉无进展检测
+ * (硬截止仍在), 让 JAR_PID 自己的超时(2.5 秒)触发 jar_timeout 窗口
+ */
+void test_capture()
+{
+  capture_clear();
+  Wall_Stop(-40, 2000);
+  wait(300, msec);
+  int idle_ms = watchdog_cfg.idle_ms;
+  watchdog_cfg.idle_ms = 0;
+  run_gyro_JAR(-600, 0, 60);
+  watchdog_cfg.idle_ms = idle_ms;
+  wait(600, msec);
+  capture_dump();
+}
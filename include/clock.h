@@ -0,0 +1,48 @@
+/**
+ * @file clock.h
+ * @brief 单调微秒时钟: 控制环 dt、超时判断和日志时间戳的统一时间基准
+ *
+ * 1. 基于 timer::systemHighResolution()(开机以来的微秒数, 64 位整数), 不受
+ *    Brain.resetTimer() 影响, 不会回退; 不用 float 存绝对时间, 长时间运行也不丢精度
+ * 2. 绝对时刻一律用 uint64_t 微秒保存, 只有算出的时间差才换成秒(float)
+ * 3. 用法:
+ *      uint64_t t0 = clock_us();
+ *      while (clock_since(t0) <= timeout) { ... }          // 超时
+ *      uint64_t last = clock_us();
+ *      float dt = clock_dt(last);                          // 距上次调用的秒数, 并更新 last
+ */
+
+/**
+ * @brief 当前时刻(开机以来的微秒数)
+ */
+uint64_t clock_us()
+{
+  return timer::systemHighResolution();
+}
+
+/**
+ * @brief 自 t0 以来的微秒数
+ */
+uint64_t clock_since_us(uint64_t t0)
+{
+  return clock_us() - t0;
+}
+
+/**
+ * @brief 自 t0 以来的秒数
+ */
+float clock_since(uint64_t t0)
+{
+  return clock_since_us(t0) / 1e6f;
+}
+
+/**
+ * @brief 循环 dt: 返回距 last 的秒数, 并把 last 更新为当前时刻
+ */
+float clock_dt(uint64_t &last)
+{
+  uint64_t now = clock_us();
+  float dt = (now - last) / 1e6f;
+  last = now;
+  return dt;
+}
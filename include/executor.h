@@ -0,0 +1,147 @@
+/**
+ * @file executor.h
+ * @brief 100Hz 固定周期控制执行器
+ *
+ * 所有控制环统一由一个高优先级任务按绝对截止时刻节拍驱动:
+ * 1. 注册的后台控制器(ControlJob)在每个节拍内依次执行, 拿到相同的 dt
+ * 2. 运动函数的 while 循环用 control_wait() 对齐到节拍, 不再各自 sleep
+ * 3. 截止时刻按 +CONTROL_PERIOD_MS 累加, 不会因单次延迟产生漂移
+ * 4. 统计节拍晚到(overrun)和控制环错过节拍的次数
+ * 5. 每个节拍开始时刻按微秒记下(clock.h), 后台控制器和 control_wait() 给出的 dt 是
+ *    相邻两次采样的实际间隔, 不是名义上的 10ms
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 执行器参数
+///////////////////////////////////////////////////////////////////////////////
+const int   CONTROL_PERIOD_MS = 10;                        //控制周期(毫秒)
+const float CONTROL_DT = CONTROL_PERIOD_MS / 1000.0;       //控制周期(秒), 所有控制器共用
+const int   CONTROL_MAX_JOBS = 8;                          //最多注册的后台控制器数量
+const int   CONTROL_TICK_HISTORY = 16;                     //保留开始时刻的节拍数, 须为 2 的幂
+
+typedef void (*ControlJob)(float dt);
+
+/**
+ * @brief 执行器运行统计
+ */
+struct ExecutorStats {
+    unsigned int ticks;          // 已执行节拍数
+    unsigned int overruns;       // 醒来时已超过截止时刻一个周期以上的次数
+    unsigned int max_late_ms;    // 单次最大晚到时间(毫秒)
+    unsigned int missed_ticks;   // 控制环因单次迭代过长而错过的节拍数
+};
+
+ControlJob control_jobs[CONTROL_MAX_JOBS] = {0};
+volatile unsigned int control_tick = 0; //节拍计数, 每个周期 +1
+uint64_t control_tick_us[CONTROL_TICK_HISTORY] = {0}; //节拍开始时刻(微秒), 按节拍号取模存放
+ExecutorStats executor_stats = {0};
+
+/**
+ * @brief 注册后台控制器, 每个节拍调用一次 job(CONTROL_DT)
+ * @return 是否注册成功(已注册或槽位已满返回false)
+ */
+bool control_register(ControlJob job)
+{
+  for (int i = 0; i < CONTROL_MAX_JOBS; i++) {
+    if (control_jobs[i] == job) return false;
+  }
+  for (int i = 0; i < CONTROL_MAX_JOBS; i++) {
+    if (control_jobs[i] == 0) {
+      control_jobs[i] = job;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief 注销后台控制器
+ */
+void control_unregister(ControlJob job)
+{
+  for (int i = 0; i < CONTROL_MAX_JOBS; i++) {
+    if (control_jobs[i] == job) control_jobs[i] = 0;
+  }
+}
+
+/**
+ * @brief 执行器任务: 按绝对截止时刻每 10ms 节拍一次
+ * @return 0
+ */
+int control_executor_fn()
+{
+  TaskProf *prof = task_prof("executor");
+  unsigned int deadline = timer::system() + CONTROL_PERIOD_MS;
+  uint64_t last_us = 0;
+  while (true) {
+    unsigned int t = timer::system();
+    if (t < deadline) {
+      task_prof_sleep(prof, deadline - t);
+      task::sleep(deadline - t);
+      task_prof_wake(prof);
+      t = timer::system();
+    }
+
+    // 晚到统计: 超过一个周期视为 overrun, 直接重新对齐, 避免追赶式连发
+    unsigned int late = t - deadline;
+    if (late > executor_stats.max_late_ms) executor_stats.max_late_ms = late;
+    if (late >= (unsigned int)CONTROL_PERIOD_MS) {
+      executor_stats.overruns++;
+      deadline = t;
+    }
+
+    // 本节拍开始时刻: 传感器快照紧接着采样, dt 取与上一节拍的实际间隔
+    uint64_t now_us = clock_us();
+    float dt = last_us ? (now_us - last_us) / 1e6f : CONTROL_DT;
+    last_us = now_us;
+    control_tick_us[control_tick % CONTROL_TICK_HISTORY] = now_us;
+
+    for (int i = 0; i < CONTROL_MAX_JOBS; i++) {
+      ControlJob job = control_jobs[i];
+      if (job) job(dt);
+    }
+    executor_stats.ticks++;
+    control_tick++;
+    deadline += CONTROL_PERIOD_MS;
+  }
+  return 0;
+}
+
+task ControlExecutorTask = task(control_executor_fn, task::kPriorityHigh); //创建执行器任务
+
+/**
+ * @brief 控制环等待下一个节拍
+ * @param last_tick 调用方保存的上次节拍号(首次传入 control_tick 当前值)
+ * @return 本次迭代的 dt(秒): 上次与本次所见快照的采样间隔(微秒精度), 正常约为 CONTROL_DT,
+ *         错过节拍时约为其整数倍
+ *
+ * 用法:
+ *   unsigned int tick = control_tick;
+ *   while (...) { float dt = control_wait(tick); ... }
+ */
+float control_wait(unsigned int &last_tick)
+{
+  while (control_tick == last_tick) {
+    this_thread::sleep_for(1);
+  }
+  unsigned int now_tick = control_tick;
+  unsigned int elapsed = now_tick - last_tick;
+  if (elapsed > 1) executor_stats.missed_ticks += elapsed - 1;
+  // 快照节拍号 = control_tick - 1; 太久以前或还没有记录时按名义周期
+  uint64_t now_us = control_tick_us[(now_tick - 1) % CONTROL_TICK_HISTORY];
+  uint64_t last_us = control_tick_us[(last_tick - 1) % CONTROL_TICK_HISTORY];
+  last_tick = now_tick;
+  if (elapsed >= (unsigned int)CONTROL_TICK_HISTORY || last_us == 0 || now_us <= last_us)
+    return elapsed * CONTROL_DT;
+  return (now_us - last_us) / 1e6f;
+}
+
+/**
+ * @brief 串口输出执行器统计
+ */
+void executor_report()
+{
+  printf("executor: ticks=%u overruns=%u max_late=%ums missed=%u\n",
+         executor_stats.ticks, executor_stats.overruns,
+         executor_stats.max_late_ms, executor_stats.missed_ticks);
+}
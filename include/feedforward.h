@@ -0,0 +1,132 @@
+/**
+ * @file feedforward.h
+ * @brief 底盘前馈模型: 功率 = kS*sgn(v) + kV*v + kA*a
+ *
+ * 1. 左右两侧、前进后退各一组 kS/kV/kA(四组), 由 test_minspeed() 的电压斜坡+阶跃数据拟合
+ * 2. kS 为静摩擦(功率), kV 为每 度/秒 所需功率, kA 为每 度/秒^2 所需功率
+ * 3. 所有直线/转向控制器的"最小功率"都从这里取, 不再各自写死
+ * 4. drive_ff_fitted 为 false(实车上电默认)时模型还没有拟合, 各控制器沿用原来手调的
+ *    最小功率钳位(FF_LEGACY_*), 以前馈为主的 run_gyro_profile 改走 run_gyro_JAR;
+ *    test_minspeed() 四组都拟合成功后置 true, 仿真入口直接置 true
+ *
+ * 单位: 速度为电机编码器 度/秒(直连车轮), 输出为功率(0-100, 对应 0-12V)。
+ * 默认值仅适用于仿真: 取自仿真电机模型(sim/sim_runtime.cpp 的 g_cfg)的常数, 不是实车数据。
+ * 实车必须先用 test_minspeed() 拟合, 再把输出的 ff: 行填回 drive_ff。
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 模型参数
+///////////////////////////////////////////////////////////////////////////////
+struct FFGains {
+    float kS;   // 静摩擦(功率)
+    float kV;   // 速度前馈(功率 / 度每秒)
+    float kA;   // 加速度前馈(功率 / 度每秒^2)
+};
+
+struct DriveFeedforward {
+    FFGains left_fwd;
+    FFGains left_rev;
+    FFGains right_fwd;
+    FFGains right_rev;
+};
+
+DriveFeedforward drive_ff = {   // 仿真值, 实车未拟合
+    {7.5, 0.077, 0.012},
+    {7.5, 0.077, 0.012},
+    {7.5, 0.077, 0.012},
+    {7.5, 0.077, 0.012},
+};
+
+bool drive_ff_fitted = false;       // drive_ff 是否为本车拟合值
+
+// 拟合前沿用的手调钳位(功率)
+const float FF_LEGACY_CREEP = 24;       // 比例减速类直线的末段下限(原 motor_min_speed)
+const float FF_LEGACY_DRIVE_MIN = 12;   // run_gyro_JAR 最小起步功率
+const float FF_LEGACY_SWING_MIN = 20;   // turn_side_JAR 最小电压
+const float FF_LEGACY_TURN_MIN = 12;    // Turn_Gyro 最低功率保底
+
+const float FF_CREEP_VEL = 200;     // 旧版直线末段的最低爬行速度(度/秒), 原 motor_min_speed=24 约对应此速度
+
+///////////////////////////////////////////////////////////////////////////////
+// 模型计算
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief 单侧前馈输出
+ * 方向按速度符号选择; 速度为 0 时按加速度符号(起步), 两者都为 0 时输出 0
+ */
+float ff_side(const FFGains &fwd, const FFGains &rev, float vel, float acc)
+{
+  float dir = vel != 0 ? vel : acc;
+  if (dir == 0) return 0;
+  const FFGains &g = dir > 0 ? fwd : rev;
+  return (dir > 0 ? g.kS : -g.kS) + g.kV * vel + g.kA * acc;
+}
+
+float ff_left(float vel, float acc = 0)  { return ff_side(drive_ff.left_fwd, drive_ff.left_rev, vel, acc); }
+float ff_right(float vel, float acc = 0) { return ff_side(drive_ff.right_fwd, drive_ff.right_rev, vel, acc); }
+
+/**
+ * @brief 单侧静摩擦(带符号), dir 为期望运动方向
+ */
+float ff_left_static(float dir)
+{
+  if (dir == 0) return 0;
+  return dir > 0 ? drive_ff.left_fwd.kS : -drive_ff.left_rev.kS;
+}
+
+float ff_right_static(float dir)
+{
+  if (dir == 0) return 0;
+  return dir > 0 ? drive_ff.right_fwd.kS : -drive_ff.right_rev.kS;
+}
+
+/**
+ * @brief 原地转向的静摩擦(带符号), dir>0 为顺时针(左进右退)
+ */
+float ff_turn_static(float dir)
+{
+  return (ff_left_static(dir) - ff_right_static(-dir)) / 2;
+}
+
+/**
+ * @brief 直线最低爬行功率(正值), 用于比例减速类直线的末段下限(未拟合时为原 24)
+ * @param dir 行驶方向(正前进, 负后退)
+ */
+float drive_creep_power(float dir)
+{
+  if (!drive_ff_fitted) return FF_LEGACY_CREEP;
+  float v = dir < 0 ? -FF_CREEP_VEL : FF_CREEP_VEL;
+  return fabs(ff_left(v) + ff_right(v)) / 2;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 最小二乘拟合: 功率 = kS + kV*v + kA*a (单侧单方向, 只累加和, 不存样本)
+///////////////////////////////////////////////////////////////////////////////
+struct FFFit {
+    double n, sv, sa, svv, saa, sva;   // 设计矩阵 [1 v a] 的 X'X
+    double su, suv, sua;               // X'u
+
+    void reset() { n = sv = sa = svv = saa = sva = su = suv = sua = 0; }
+
+    // 加入一个样本: v/a 取绝对方向(后退时已取反), u 为同方向的功率
+    void add(float v, float a, float u) {
+        n += 1; sv += v; sa += a;
+        svv += v * v; saa += a * a; sva += v * a;
+        su += u; suv += u * v; sua += u * a;
+    }
+
+    // 解 3x3 正规方程(克拉默法则), 样本不足或矩阵奇异时返回 false
+    bool solve(FFGains &g) {
+        if (n < 10) return false;
+        double det = n * (svv * saa - sva * sva) - sv * (sv * saa - sva * sa) + sa * (sv * sva - svv * sa);
+        if (fabs(det) < 1e-9) return false;
+        double d0 = su * (svv * saa - sva * sva) - sv * (suv * saa - sva * sua) + sa * (suv * sva - svv * sua);
+        double d1 = n * (suv * saa - sua * sva) - su * (sv * saa - sva * sa) + sa * (sv * sua - suv * sa);
+        double d2 = n * (svv * sua - sva * suv) - sv * (sv * sua - suv * sa) + su * (sv * sva - svv * sa);
+        g.kS = d0 / det;
+        g.kV = d1 / det;
+        g.kA = d2 / det;
+        return true;
+    }
+};
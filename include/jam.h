@@ -0,0 +1,159 @@
+/**
+ * @file jam.h
+ * @brief 卡球保护: 监测 Intake_1/Ball_1/Shoot_1 的转速、电流、扭矩, 堵转时自动反转再恢复
+ *
+ * 1. 挂在 100Hz 执行器上, 用本节拍快照(sensors.h), 不额外读设备
+ * 2. 堵转判定: 指令 |cmd| >= min_cmd 且已过启动时间, 沿指令方向的转速 < stall_rpm,
+ *    且电流 >= stall_current 或扭矩 >= stall_torque, 连续 detect_ms 即判为卡球
+ * 3. 卡球后接管该电机(mech_hold): 反方向 reverse_power 转 reverse_ms, 再恢复
+ *    Intake()/Ball()/Shoot() 最近一次的指令; 接管期间其它线程的指令只记录不生效
+ * 4. retry_ms 内连续卡球超过 max_retries 次则停转放弃, 直到指令换向或归零
+ * 5. 每次事件打印一行 jam: ..., 次数计入 jam_count
+ *
+ * 自动(Get_Ball(2))和手动(Intake_Shoot_ctrl)都经过 Intake()/Ball()/Shoot(), 两种模式都生效。
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 参数(可在运行中修改)
+///////////////////////////////////////////////////////////////////////////////
+struct JamConfig {
+    int min_cmd;            // 指令绝对值低于此值不监测(如射球轮 -40/-50 的顶球保持)
+    int start_ms;           // 指令启动或换向后多久开始监测(避开启动电流)
+    float stall_rpm;        // 沿指令方向转速低于此值视为不转(rpm)
+    float stall_current;    // 堵转电流(A)
+    float stall_torque;     // 堵转扭矩(Nm)
+    int detect_ms;          // 持续多久判为卡球
+    int reverse_power;      // 反转功率(0-100)
+    int reverse_ms;         // 反转时长
+    int retry_ms;           // 恢复后多久内再卡算作连续卡球
+    int max_retries;        // 连续卡球超过此次数停转放弃
+};
+
+JamConfig jam_cfg = {60, 200, 20, 2.0, 1.5, 60, 100, 150, 1000, 3};
+
+///////////////////////////////////////////////////////////////////////////////
+// 监测状态
+///////////////////////////////////////////////////////////////////////////////
+enum JamState { JAM_WATCH = 0, JAM_REVERSE = 1, JAM_STOPPED = 2 };
+
+struct JamMonitor {
+    int state;
+    int dir;                // 当前指令方向(1/-1/0), 换向时重新计启动时间
+    unsigned int since;     // 指令启动/反转开始/放弃时刻(ms)
+    int stall_ms;           // 持续堵转时间
+    unsigned int last_jam;  // 上次卡球时刻
+    int retries;            // 连续卡球次数
+};
+
+JamMonitor jam_mon[MECH_MOTORS];
+int jam_count[MECH_MOTORS] = {0, 0, 0};
+const char *mech_name[MECH_MOTORS] = {"intake", "ball", "shoot"};
+
+// 按各自的原始方式重新下发最近一次指令
+void mech_apply(int i)
+{
+  if (i == MECH_INTAKE) Intake(mech_cmd[i]);
+  else if (i == MECH_BALL) Ball(mech_cmd[i]);
+  else Shoot(mech_cmd[i]);
+}
+
+motor &mech_motor(int i)
+{
+  if (i == MECH_INTAKE) return Intake_1;
+  if (i == MECH_BALL) return Ball_1;
+  return Shoot_1;
+}
+
+void jam_log(int i, const char *what, const MechReading &r)
+{
+  printf("jam: t=%u motor=%s %s cmd=%d vel=%.0f cur=%.2f torque=%.2f n=%d\n",
+         (unsigned int)timer::system(), mech_name[i], what, mech_cmd[i],
+         r.velocity, r.current, r.torque, jam_count[i]);
+}
+
+/**
+ * @brief 单个电机一个节拍的监测
+ */
+void jam_step(int i, const MechReading &r, unsigned int now, float dt)
+{
+  JamMonitor &j = jam_mon[i];
+  int cmd = mech_cmd[i];
+  int dir = abs(cmd) >= jam_cfg.min_cmd ? sgn(cmd) : 0;
+
+  if (j.state == JAM_REVERSE) {
+    m(mech_motor(i), -j.dir * jam_cfg.reverse_power);   // 每节拍重新下发, 防止被其它线程覆盖
+    if (now - j.since < (unsigned int)jam_cfg.reverse_ms) return;
+    mech_hold[i] = false;
+    mech_apply(i);
+    j.state = JAM_WATCH;
+    j.dir = dir;
+    j.since = now;
+    j.stall_ms = 0;
+    jam_log(i, "resume", r);
+    return;
+  }
+  if (j.state == JAM_STOPPED) {
+    if (dir == j.dir) return;
+    mech_hold[i] = false;     // 操作手/自动程序已换向或停下, 解除放弃
+    mech_apply(i);
+    j.state = JAM_WATCH;
+    j.retries = 0;
+    jam_log(i, "release", r);
+  }
+
+  if (dir != j.dir) {
+    j.dir = dir;
+    j.since = now;
+    j.stall_ms = 0;
+  }
+  bool stalled = dir != 0 && now - j.since >= (unsigned int)jam_cfg.start_ms &&
+                 r.velocity * dir < jam_cfg.stall_rpm &&
+                 (r.current >= jam_cfg.stall_current || r.torque >= jam_cfg.stall_torque);
+  j.stall_ms = stalled ? j.stall_ms + (int)(dt * 1000 + 0.5) : 0;
+  if (j.stall_ms < jam_cfg.detect_ms) return;
+
+  // 卡球
+  jam_count[i]++;
+  j.retries = now - j.last_jam < (unsigned int)(jam_cfg.retry_ms + jam_cfg.reverse_ms) ? j.retries + 1 : 1;
+  j.last_jam = now;
+  j.stall_ms = 0;
+  j.since = now;
+  mech_hold[i] = true;
+  if (j.retries > jam_cfg.max_retries) {
+    j.state = JAM_STOPPED;
+    mech_motor(i).stop(coast);
+    jam_log(i, "gave_up", r);
+    return;
+  }
+  j.state = JAM_REVERSE;
+  m(mech_motor(i), -j.dir * jam_cfg.reverse_power);
+  jam_log(i, "reverse", r);
+}
+
+/**
+ * @brief 执行器任务: 每节拍检查三个机构电机
+ */
+void jam_job(float dt)
+{
+  SensorSnapshot snap = sensors();
+  jam_step(MECH_INTAKE, snap.intake, snap.time, dt);
+  jam_step(MECH_BALL, snap.ball, snap.time, dt);
+  jam_step(MECH_SHOOT, snap.shoot, snap.time, dt);
+}
+bool jam_started = control_register(jam_job);
+
+/**
+ * @brief 卡球测试: 自动吸球 6 秒, 输出各电机卡球次数
+ * jam_robot: intake= ball= shoot= (卡球次数) hold=仍在接管的电机数
+ */
+void test_jam()
+{
+  Get_Ball(2);
+  wait(6000, msec);
+  Get_Ball(0);
+  wait(300, msec);
+  int hold = 0;
+  for (int i = 0; i < MECH_MOTORS; i++) if (mech_hold[i]) hold++;
+  printf("jam_robot: intake=%d ball=%d shoot=%d hold=%d\n",
+         jam_count[MECH_INTAKE], jam_count[MECH_BALL], jam_count[MECH_SHOOT], hold);
+}
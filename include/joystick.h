@@ -3,6 +3,7 @@
 //bool auto_stop=false;
 int first_auto_stop=1;
 int mode_ctrl=2;
+// 吸球卡球自动反转见 jam.h(电流/扭矩/转速监测, 自动与手动都生效)
 /*void auto_Intake(){
   while(true){
     if(Intake_1.torque()>=0.35){
@@ -50,7 +51,7 @@ void base_control(){
     // if(auto_control==1){
     //   break;
     // }
-    wait(5, msec);
+    task_wait("base_control", 5);
   }
 }
 void hook_control(){
@@ -64,7 +65,7 @@ void hook_control(){
     if(auto_control==1){
       break;
     }
-    wait(20, msec);
+    task_wait("hook_control", 20);
   }
 }
 void hold_ctrl(){
@@ -79,13 +80,14 @@ void hold_ctrl(){
         auto_stop=true;
       }
       while(Controller1.ButtonY.pressing()){
+        task_spin("hold_ctrl_spin");   // 等松开, 忙等
         continue;
       }
     }
     if(auto_control==1){
       break;
     }
-    wait(20, msec);
+    task_wait("hold_ctrl", 20);
   }
 }
 void load_ctrl(){
@@ -99,7 +101,7 @@ void load_ctrl(){
     if(auto_control==1){
       break;
     }
-    wait(20, msec);
+    task_wait("load_ctrl", 20);
   }
 }
 void Intake_Shoot_ctrl(){
@@ -166,7 +168,7 @@ void Intake_Shoot_ctrl(){
     if(auto_control==1){
       break;
     }
-    wait(5, msec);
+    task_wait("Intake_Shoot_ctrl", 5);
   }
 }
 void Up_ctrl(){
@@ -177,7 +179,7 @@ void Up_ctrl(){
     if(auto_control==1){
       break;
     }
-    wait(5, msec);
+    task_wait("Up_ctrl", 5);
   }
 }
 void Ball_ctrl(){
@@ -191,7 +193,7 @@ void Ball_ctrl(){
     if(auto_control==1){
       break;
     }
-    wait(5, msec);
+    task_wait("Ball_ctrl", 5);
   }
 }
 void choose_ctrl(){
@@ -233,7 +235,7 @@ void choose_ctrl(){
     if(auto_control==1){
       break;
     }
-    wait(20, msec);
+    task_wait("choose_ctrl", 20);
   }
 }
 void hook_auto_ctrl(){
@@ -268,34 +270,36 @@ void hook_auto_ctrl(){
     if(auto_control==1){
       break;
     }
-    wait(20, msec);
+    task_wait("hook_auto_ctrl", 20);
   }
 }
 void anchor_ctrl(){
   bool target_set = false;  // 是否已设置目标位置
+  control_register(Anchor_Job); // P控制由执行器按10ms节拍执行
   
   while(true){
     if(Controller1.ButtonRight.pressing()){
-      // 首次按下：记录目标位置
+      // 首次按下：记录目标位置并开启锁定
       if(!target_set) {
         Anchor_SetTarget();
         target_set = true;
+        anchor_enabled = true;
       }
-      // 持续执行P控制锁定
-      Anchor_Lock(true);
     } else {
       // 按键松开：立即停止锁定
       if(target_set) {
-        Anchor_Lock(false);
+        anchor_enabled = false;
         RunStop(coast);
         target_set = false;
       }
     }
     
     if(auto_control==1){
+      anchor_enabled = false;
+      control_unregister(Anchor_Job);
       break;
     }
-    wait(10, msec);  // 10ms控制周期
+    task_wait("anchor_ctrl", 10);  // 按键检测周期
   }
 }
 void Joystick(void){
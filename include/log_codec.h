@@ -0,0 +1,197 @@
+/**
+ * @file log_codec.h
+ * @brief 日志二进制帧编码: 模式头 + 增量/变长整数 + 每帧 CRC, 每帧一行 base64 输出
+ *
+ * 帧格式(小端):
+ *   [类型 1B]['S' 模式头 / 'D' 数据] [帧序号 2B] [载荷] [CRC-16/CCITT 2B, 覆盖前面全部字节]
+ * 模式头载荷:
+ *   [版本 1B] [字段数 1B] [模式名: 长度 1B + 字符] 每个字段 [比例 varint] [名字: 长度 1B + 字符]
+ * 数据帧载荷:
+ *   [首样本序号 varint] [样本数 1B] 每个样本每个字段一个 zigzag varint:
+ *   字段值乘比例取整, 帧内第一个样本存绝对值, 之后存与上一样本之差
+ *   (每帧可单独解码, 丢帧只丢这一段)
+ * 文本行: '~' + base64(帧), 上位机在终端文本里按行找帧, CRC 不对的帧整帧丢弃。
+ *
+ * 解码见上位机 log_codec.py。
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 参数
+///////////////////////////////////////////////////////////////////////////////
+const int LOG_FIELDS_MAX = 24;       // 单个模式最多字段数
+const int LOG_FRAME_BYTES = 384;     // 单帧最大字节数
+const int LOG_FRAME_SAMPLES = 8;     // 每个数据帧最多样本数
+const int LOG_CODEC_VERSION = 1;
+
+struct LogSchema {
+    const char *name;              // 模式名(上位机按此选图表)
+    int nfields;
+    const char *const *fields;     // 字段名
+    const int *scales;             // 量化比例: 传输值 = round(值 * 比例)
+};
+
+struct LogFrame {
+    unsigned char buf[LOG_FRAME_BYTES];
+    int len;
+};
+
+typedef void (*LogEmit)(const LogFrame &frame);
+
+///////////////////////////////////////////////////////////////////////////////
+// 基本编码
+///////////////////////////////////////////////////////////////////////////////
+unsigned short crc16_ccitt(const unsigned char *data, int len, unsigned short crc = 0xFFFF)
+{
+  for (int i = 0; i < len; i++) {
+    crc ^= (unsigned short)data[i] << 8;
+    for (int b = 0; b < 8; b++) crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+void log_put_u8(LogFrame &f, unsigned int v)
+{
+  if (f.len < LOG_FRAME_BYTES) f.buf[f.len++] = (unsigned char)v;
+}
+
+void log_put_varint(LogFrame &f, unsigned int v)
+{
+  while (v >= 0x80) {
+    log_put_u8(f, (v & 0x7F) | 0x80);
+    v >>= 7;
+  }
+  log_put_u8(f, v);
+}
+
+// zigzag: 小幅正负值都编成短 varint
+void log_put_svarint(LogFrame &f, int v)
+{
+  log_put_varint(f, ((unsigned int)v << 1) ^ (unsigned int)(v >> 31));
+}
+
+void log_put_string(LogFrame &f, const char *s)
+{
+  int n = strlen(s);
+  if (n > 255) n = 255;
+  log_put_u8(f, n);
+  for (int i = 0; i < n; i++) log_put_u8(f, s[i]);
+}
+
+void log_frame_begin(LogFrame &f, char type, unsigned int seq)
+{
+  f.len = 0;
+  log_put_u8(f, type);
+  log_put_u8(f, seq & 0xFF);
+  log_put_u8(f, (seq >> 8) & 0xFF);
+}
+
+void log_frame_end(LogFrame &f)
+{
+  unsigned short crc = crc16_ccitt(f.buf, f.len);
+  log_put_u8(f, crc & 0xFF);
+  log_put_u8(f, crc >> 8);
+}
+
+/**
+ * @brief 按一行文本输出一帧: '~' + base64
+ */
+void log_print_frame(const LogFrame &f)
+{
+  static const char *B64 = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  char line[LOG_FRAME_BYTES / 3 * 4 + 8];
+  int n = 0;
+  line[n++] = '~';
+  for (int i = 0; i < f.len; i += 3) {
+    unsigned int v = f.buf[i] << 16;
+    if (i + 1 < f.len) v |= f.buf[i + 1] << 8;
+    if (i + 2 < f.len) v |= f.buf[i + 2];
+    line[n++] = B64[(v >> 18) & 63];
+    line[n++] = B64[(v >> 12) & 63];
+    line[n++] = i + 1 < f.len ? B64[(v >> 6) & 63] : '=';
+    line[n++] = i + 2 < f.len ? B64[v & 63] : '=';
+  }
+  line[n] = 0;
+  printf("%s\n", line);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 样本流编码
+///////////////////////////////////////////////////////////////////////////////
+struct LogEncoder {
+    const LogSchema *schema;
+    LogEmit emit;
+    unsigned int seq;            // 下一帧序号
+    unsigned int index;          // 下一样本序号
+    int count;                   // 当前数据帧内样本数
+    int count_at;                // 样本数字节在帧内的位置
+    int prev[LOG_FIELDS_MAX];    // 上一样本的量化值
+    LogFrame frame;
+};
+
+int log_quantize(float v, int scale)
+{
+  double q = v * (double)scale;
+  if (q > 1e9) q = 1e9;          // 限幅保证相邻差值不溢出 int
+  if (q < -1e9) q = -1e9;
+  return (int)(q < 0 ? q - 0.5 : q + 0.5);
+}
+
+void log_encoder_flush(LogEncoder &e)
+{
+  if (e.count == 0) return;
+  e.frame.buf[e.count_at] = e.count;   // 回填样本数
+  log_frame_end(e.frame);
+  e.emit(e.frame);
+  e.count = 0;
+}
+
+/**
+ * @brief 开始一个样本流: 先发模式头帧
+ */
+void log_encoder_begin(LogEncoder &e, const LogSchema &schema, LogEmit emit)
+{
+  e.schema = &schema;
+  e.emit = emit;
+  e.seq = 0;
+  e.index = 0;
+  e.count = 0;
+  log_frame_begin(e.frame, 'S', e.seq++);
+  log_put_u8(e.frame, LOG_CODEC_VERSION);
+  log_put_u8(e.frame, schema.nfields);
+  log_put_string(e.frame, schema.name);
+  for (int i = 0; i < schema.nfields; i++) {
+    log_put_varint(e.frame, schema.scales[i]);
+    log_put_string(e.frame, schema.fields[i]);
+  }
+  log_frame_end(e.frame);
+  emit(e.frame);
+}
+
+/**
+ * @brief 追加一个样本(nfields 个值), 帧满时自动发出
+ */
+void log_encoder_add(LogEncoder &e, const float *row)
+{
+  const LogSchema &s = *e.schema;
+  // 剩余空间不够放一个最坏情况的样本(每字段 5 字节)就先发出
+  if (e.count > 0 && (e.count >= LOG_FRAME_SAMPLES || e.frame.len + 5 * s.nfields + 2 > LOG_FRAME_BYTES))
+    log_encoder_flush(e);
+  if (e.count == 0) {
+    log_frame_begin(e.frame, 'D', e.seq++);
+    log_put_varint(e.frame, e.index);
+    e.count_at = e.frame.len;
+    log_put_u8(e.frame, 0);   // 样本数, 发出时回填
+  }
+  for (int i = 0; i < s.nfields; i++) {
+    int q = log_quantize(row[i], s.scales[i]);
+    log_put_svarint(e.frame, e.count == 0 ? q : q - e.prev[i]);
+    e.prev[i] = q;
+  }
+  e.count++;
+  e.index++;
+}
+
+void log_encoder_finish(LogEncoder &e)
+{
+  log_encoder_flush(e);
+}
@@ -0,0 +1,209 @@
+/**
+ * @file log_link.h
+ * @brief 日志帧的可靠串口传输: 序号 + CRC 帧(log_codec.h), 上位机确认/重发请求, 按接收窗口限流
+ *
+ * 下行(主控 -> 上位机): 每帧一行 '~' + base64, 帧头带 16 位序号, 帧尾 CRC-16。
+ * 上行(上位机 serial_rx.py -> 主控), 每条一行:
+ *   !A <seq> <win>   累计确认: 序号 < seq 的帧都已收到; win 为上位机还能缓存的帧数
+ *   !N <seq>         请求重发该帧(上位机发现缺帧或 CRC 错)
+ * 主控最多有 min(LINK_WINDOW, win) 帧未确认, 窗口满就等确认, 不再按固定间隔睡眠;
+ * 收到 !N 只重发那一帧, LINK_TIMEOUT_MS 内确认没有前进则重发全部未确认帧。
+ *
+ * 没有接收程序(普通终端复制粘贴)时, 第一帧重发 LINK_HELLO_TRIES 次仍得不到确认,
+ * 或连续重发 LINK_RETRIES 次都没有进展, 退回按 LINK_PACE_MS 限速逐帧输出。
+ *
+ * 不在传输时由 LinkIdleTask 读上行命令:
+ *   !P               输出任务剖析报表(taskprof.h)
+ *   !R               任务剖析清零
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 参数
+///////////////////////////////////////////////////////////////////////////////
+const int LINK_WINDOW = 8;          // 最多未确认帧数(约 2.5KB, 小于 USB 串口缓冲)
+const int LINK_TIMEOUT_MS = 200;    // 确认不前进多久重发
+const int LINK_HELLO_TRIES = 3;     // 第一帧的重发次数, 仍无确认视为没有接收程序
+const int LINK_RETRIES = 10;        // 连续重发次数上限, 超过退回限速输出
+const int LINK_PACE_MS = 25;        // 限速输出时每帧之后的排空时间(一行约 300 字符)
+const int LINK_RX_LINE = 32;        // 上行命令最大长度
+const int LINK_IDLE_MS = 50;        // 不在传输时读上行命令的间隔
+
+struct LogLink {
+    volatile bool active;       // 正在传输(link_begin 到 link_end), 上行数据归 link_service 读
+    bool reliable;              // false: 限速输出, 不等确认
+    bool connected;             // 收到过上位机的确认
+    unsigned int base;          // 最早未确认帧(发送计数)
+    unsigned int next;          // 下一帧(发送计数), 帧序号 = 计数 & 0xFFFF
+    int window;                 // 当前允许的未确认帧数
+    unsigned int progress_ms;   // 确认最近一次前进(或重发)的时刻
+    int retries;                // 连续超时重发次数
+    unsigned int resent;        // 累计重发帧数
+    unsigned int naks;          // 累计收到的重发请求
+    char rx[LINK_RX_LINE];      // 上行命令行缓冲
+    int rx_len;
+    LogFrame sent[LINK_WINDOW]; // 未确认帧的副本, 按发送计数取模存放
+};
+
+LogLink log_link;
+
+///////////////////////////////////////////////////////////////////////////////
+// 内部
+///////////////////////////////////////////////////////////////////////////////
+
+// 16 位序号换算为发送计数, 不在 [base, next) 内返回 false
+bool link_index(unsigned int seq, unsigned int &index)
+{
+  LogLink &l = log_link;
+  index = l.base + ((seq - l.base) & 0xFFFF);
+  return index < l.next;
+}
+
+void link_fallback(const char *why)
+{
+  LogLink &l = log_link;
+  if (!l.reliable) return;
+  l.reliable = false;
+  printf("link: no receiver (%s), paced output\n", why);
+}
+
+void link_resend(unsigned int index)
+{
+  log_print_frame(log_link.sent[index % LINK_WINDOW]);
+  log_link.resent++;
+}
+
+void link_command(const char *cmd)
+{
+  LogLink &l = log_link;
+  unsigned int seq = 0, index = 0;
+  int win = 0;
+  if (sscanf(cmd, "!A %u %d", &seq, &win) == 2) {
+    // 累计确认: seq 是上位机期望的下一帧, 可以等于 next
+    unsigned int acked = (seq - l.base) & 0xFFFF;
+    if (acked > l.next - l.base) return;   // 上一次传输的残留确认
+    l.connected = true;
+    l.window = win < 1 ? 1 : win > LINK_WINDOW ? LINK_WINDOW : win;
+    if (acked > 0) {
+      l.base += acked;
+      l.progress_ms = timer::system();
+      l.retries = 0;
+    }
+  } else if (sscanf(cmd, "!N %u", &seq) == 1) {
+    l.connected = true;
+    l.naks++;
+    if (link_index(seq, index)) link_resend(index);
+  } else if (!l.active && !strcmp(cmd, "!P")) {
+    task_prof_report();
+  } else if (!l.active && !strcmp(cmd, "!R")) {
+    task_prof_reset();
+  }
+}
+
+// 读完串口里已到的上行数据, 按行交给 link_command
+void link_poll()
+{
+  LogLink &l = log_link;
+  bool active = l.active;
+  int c;
+  while (l.active == active && (c = vexSerialReadChar(1)) >= 0) {
+    if (c == '\n' || c == '\r') {
+      l.rx[l.rx_len] = 0;
+      if (l.rx_len > 0 && l.rx[0] == '!') link_command(l.rx);
+      l.rx_len = 0;
+    } else if (l.rx_len < LINK_RX_LINE - 1) {
+      l.rx[l.rx_len++] = c;
+    }
+  }
+}
+
+/**
+ * @brief 处理上位机发来的命令, 检查超时重发(不阻塞)
+ */
+void link_service()
+{
+  LogLink &l = log_link;
+  link_poll();
+  if (!l.reliable || l.base == l.next) return;
+
+  unsigned int now = timer::system();
+  if (now - l.progress_ms < (unsigned int)LINK_TIMEOUT_MS) return;
+  if (++l.retries > (l.connected ? LINK_RETRIES : LINK_HELLO_TRIES)) {
+    link_fallback(l.connected ? "retries" : "no ack");
+    return;
+  }
+  for (unsigned int i = l.base; i != l.next; i++) link_resend(i);
+  l.progress_ms = now;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 接口
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief 开始一次传输: 清掉上次残留的上行数据, 先按可靠模式尝试
+ */
+void link_begin()
+{
+  LogLink &l = log_link;
+  l.active = true;
+  while (vexSerialReadChar(1) >= 0) {}
+  l.reliable = true;
+  l.connected = false;
+  l.base = l.next = 0;
+  l.window = 1;               // 确认之前只发第一帧探测
+  l.progress_ms = timer::system();
+  l.retries = 0;
+  l.resent = l.naks = 0;
+  l.rx_len = 0;
+}
+
+/**
+ * @brief 发送一帧; 可靠模式下窗口满则等确认
+ */
+void link_send(const LogFrame &f)
+{
+  LogLink &l = log_link;
+  while (l.reliable && l.next - l.base >= (unsigned int)l.window) {
+    vex::task::sleep(1);
+    link_service();
+  }
+  if (!l.reliable) {
+    log_print_frame(f);
+    vex::task::sleep(LINK_PACE_MS);
+    return;
+  }
+  l.sent[l.next % LINK_WINDOW] = f;
+  l.next++;
+  log_print_frame(f);
+  link_service();
+}
+
+/**
+ * @brief 结束传输: 等所有帧确认(或退回限速模式)
+ * @return 是否全部帧都得到了确认
+ */
+bool link_end()
+{
+  LogLink &l = log_link;
+  while (l.reliable && l.base != l.next) {
+    vex::task::sleep(1);
+    link_service();
+  }
+  l.rx_len = 0;
+  l.active = false;
+  return l.reliable;
+}
+
+/**
+ * @brief 不在传输时处理上行命令(!P / !R)
+ */
+int link_idle_fn()
+{
+  while (true) {
+    if (!log_link.active) link_poll();
+    task_wait("link_idle", LINK_IDLE_MS);
+  }
+  return 0;
+}
+
+task LinkIdleTask = task(link_idle_fn);
@@ -36,6 +36,9 @@ void Auto_8()
 /////////////////////////////////////////////
 void AutoPro ()
 {
+trace_start("auto");   // 时间线追踪(trace.h), 跑完用 trace_dump() 输出
+trace_begin("AutoPro", Auto);
+motion_log_reset();    // 运动表(motion_result.h), 跑完输出每段的退出原因和稳定用时
 button=1; 
 Color.setLightPower(100, percent); 
 Color_2.setLightPower(100, percent);
@@ -62,6 +65,9 @@ Side=1;
  if (Auto==8)
  {Auto_8();}
  Auto_time=Brain.timer(timeUnits::sec);
+ trace_end("AutoPro");
+ trace_stop();
+ motion_log_report();
  Brain.Screen.clearScreen();
  Brain.Screen.print(Brain.timer(timeUnits::sec));
  Controller1.Screen.clearLine(3);
@@ -0,0 +1,330 @@
+/**
+ * @file motion.h
+ * @brief 底盘运动状态与异步运动接口
+ *
+ * 所有底盘运动函数每次执行都会在 drive_motion 中登记编号、进度和取消标志
+ * (不支持链式的 Turn_Gyro / Run_wall 等用 motion_begin(false))。
+ * run_gyro_JAR / Turn_Gyro_new / turn_side_JAR 另有 *_async 版本, 把运动放到后台任务执行并立即返回
+ * MotionHandle, 自动程序可以在底盘行驶途中切换吸球、气动等机构:
+ *
+ *   MotionHandle h = run_gyro_JAR_async(900, -140);
+ *   h.waitUntilProgress(0.5);   // 走到一半
+ *   Load.set(true);
+ *   h.wait();                   // 等待到位
+ *
+ * 同一时间只允许一个底盘运动: 新的异步运动会先等上一个结束,
+ * 同步调用也会等正在执行的异步运动结束后再开始。
+ * 自动阶段结束时还没走完的后台运动由 usercontrol() 里的 motion_reset() 取消并复位。
+ *
+ * 链式运动: chain_next() 让紧接着的一段运动以宽松误差退出、不刹车,
+ * 下一段从当前速度直接起步, 省掉段与段之间的加速-刹车-稳定:
+ *
+ *   chain_next(); run_gyro_JAR(330);
+ *   chain_next(); turn_side_JAR(-20, right);
+ *   run_gyro_JAR(-570, 0);      // 最后一段正常稳定并刹车
+ *
+ * 承接规则(所有支持链式的运动函数):
+ *   - 起步输出: run_gyro_JAR 从 chain_carry_output 斜坡起步; run_gyro_profile 从当前速度接入曲线;
+ *     follow_path 的速度指令从当前速度开始; Run_gyro / move_to_pose 本身没有起步斜坡, 直接接上
+ *   - 剩余距离: 直线类运动在链式误差处退出时剩下的距离(chain_carry_distance)加到下一段直线的
+ *     目标上, 不会被下一段以新起点丢掉; 下一段是转向时, 方向已变, 剩余距离作废
+ *   - 原地转向退出时没有直线速度, 交给下一段的输出为 0
+ *   - 不支持链式的运动(motion_begin(false))不承接: 开始时清掉输出和剩余距离,
+ *     上一段没有刹车时先刹车, 不会把上一段的输出和距离留给再下一段
+ *
+ * 同步调用返回 MotionResult(退出原因、用时、稳定用时、最终误差、过冲, 见 motion_result.h),
+ * 异步运动结束后可读 motion_last_result。
+ *
+ * 看门狗(watchdog.h)结束运动时置 abort, 运动循环经 motion_cancelled() 与取消一样刹车退出。
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 运动状态
+///////////////////////////////////////////////////////////////////////////////
+enum MotionKind {
+    MOTION_DRIVE = 1,  // run_gyro_JAR
+    MOTION_TURN  = 2,  // Turn_Gyro_new
+    MOTION_SWING = 3   // turn_side_JAR
+};
+
+struct MotionStatus {
+    volatile unsigned int id;    // 当前(或最近一次)运动编号
+    volatile bool running;       // 运动循环是否在执行
+    volatile bool cancel;        // 取消请求, 运动循环检测到后刹车退出
+    volatile bool abort;         // 看门狗结束了当前运动(watchdog.h), 与取消同样处理
+    volatile float progress;     // 完成进度 0~1
+    volatile bool async_busy;    // 后台运动任务占用底盘
+    volatile int async_thread_id; // 后台运动任务的线程号
+    bool chained;                // 当前运动是否为链式(不刹车退出)
+    float chain_exit;            // 当前链式运动的退出误差, 0 表示用默认值
+};
+MotionStatus drive_motion = {0, false, false, false, 0, false, -1, false, 0};
+
+///////////////////////////////////////////////////////////////////////////////
+// 链式运动参数
+///////////////////////////////////////////////////////////////////////////////
+const float CHAIN_DRIVE_EXIT = 30;  // 直线段默认退出误差(编码器度数)
+const float CHAIN_TURN_EXIT  = 5;   // 转向段默认退出误差(度)
+
+bool  chain_pending = false;     // 下一段运动以链式执行
+float chain_pending_exit = 0;    // 下一段运动的链式退出误差
+float chain_carry_output = 0;    // 上一段链式运动退出时的直线输出, 下一段从这里起步
+float chain_carry_distance = 0;  // 上一段链式直线退出时剩下的距离(编码器度数, 带方向), 下一段直线加到目标上
+
+/**
+ * @brief 把下一段底盘运动设为链式: 误差小于 exit_error 即退出, 不刹车
+ * @param exit_error 退出误差, 0 表示使用该运动的默认值(CHAIN_DRIVE_EXIT / CHAIN_TURN_EXIT)
+ */
+void chain_next(float exit_error = 0)
+{
+  chain_pending = true;
+  chain_pending_exit = exit_error;
+}
+
+/**
+ * @brief 当前链式运动的退出误差
+ * @param default_error 该运动的默认链式退出误差
+ */
+float chain_exit_error(float default_error)
+{
+  return drive_motion.chain_exit > 0 ? drive_motion.chain_exit : default_error;
+}
+
+// 后台任务的运动参数(同一时间只有一个)
+struct MotionRequest {
+    int kind;
+    double target;
+    float heading;
+    float max_voltage;
+    turnType side;
+    int force_dir;
+};
+MotionRequest motion_request;
+
+// 运动结果(motion_result.h): 运动函数的返回值
+enum MotionExit {
+    MOTION_SETTLED = 0,    // 误差稳定退出
+    MOTION_TIMEOUT = 1,    // 超时(运动自己的超时或看门狗截止)
+    MOTION_STALLED = 2,    // 看门狗判定无进展
+    MOTION_CANCELLED = 3,  // 被取消
+    MOTION_CHAINED = 4     // 链式运动在宽松误差处退出
+};
+
+struct MotionResult {
+    int exit;              // MotionExit
+    float elapsed;         // 用时(秒)
+    float settle_time;     // 第一次进入稳定误差到退出的时间(秒)
+    float final_error;     // 退出时的误差
+    float overshoot;       // 最大过冲(误差越过 0 后反方向的最大值)
+};
+
+MotionResult run_gyro_JAR(double target_enc, float target_heading, float max_voltage);
+MotionResult Turn_Gyro_new(float target);
+MotionResult turn_side_JAR(float target_heading, turnType move_side, float max_voltage, int force_dir);
+void RunStop(brakeType brake_name);
+void watchdog_reset();
+
+/**
+ * @brief 运动函数开始时调用: 登记新的运动编号并清零进度
+ * 同步调用时若后台运动正在执行, 先等它结束; 同时清掉上一段留下的取消标志
+ * @param chainable 运动是否支持链式; 不支持时 chain_next() 的请求在这一段作废, 本段总是刹车结束,
+ *                  也不承接上一段链式运动的输出和剩余距离
+ * @return 本段是否为链式运动(由 chain_next() 设置, 只作用于一段)
+ */
+bool motion_begin(bool chainable = true)
+{
+  bool from_async = drive_motion.async_busy && this_thread::get_id() == drive_motion.async_thread_id;
+  if (!from_async) {
+    while (drive_motion.async_busy) {
+      this_thread::sleep_for(5);
+    }
+    drive_motion.id++;       // 异步运动的编号在启动时已分配
+    drive_motion.cancel = false;
+  }
+  drive_motion.progress = 0;
+  drive_motion.running = true;
+  drive_motion.chained = chainable && chain_pending;
+  drive_motion.chain_exit = chain_pending_exit;
+  chain_pending = false;
+  chain_pending_exit = 0;
+  if (!chainable) {
+    if (chain_carry_output != 0) RunStop(brake); // 上一段链式运动没刹车
+    chain_carry_output = 0;
+    chain_carry_distance = 0;
+  }
+  return drive_motion.chained;
+}
+
+/**
+ * @brief 更新运动进度
+ * @param done 已完成量(编码器度数或角度)
+ * @param total 总量
+ */
+void motion_progress(float done, float total)
+{
+  float p = total == 0 ? 1 : done / total;
+  if (p < 0) p = 0;
+  if (p > 1) p = 1;
+  drive_motion.progress = p;
+}
+
+/**
+ * @brief 运动循环中检测是否被取消(含看门狗结束)
+ */
+bool motion_cancelled()
+{
+  return drive_motion.cancel || drive_motion.abort;
+}
+
+/**
+ * @brief 链式运动结束时是否需要刹车(非链式或被取消)
+ */
+bool motion_should_stop()
+{
+  return !drive_motion.chained || motion_cancelled();
+}
+
+/**
+ * @brief 运动函数结束时调用
+ * @param carry 退出时的直线输出, 链式运动时交给下一段起步
+ * @param residual 退出时剩下的直线距离(编码器度数, 带方向), 链式运动时加到下一段直线的目标上
+ */
+void motion_end(float carry = 0, float residual = 0)
+{
+  bool stop = motion_should_stop();
+  chain_carry_output = stop ? 0 : carry;
+  chain_carry_distance = stop ? 0 : residual;
+  if (!motion_cancelled()) drive_motion.progress = 1;
+  drive_motion.running = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 异步运动句柄
+///////////////////////////////////////////////////////////////////////////////
+struct MotionHandle {
+    unsigned int id;
+
+    // 运动是否已结束(到位、超时或被取消)
+    bool done() {
+        return drive_motion.id != id || !drive_motion.async_busy;
+    }
+
+    // 当前进度 0~1, 已结束的运动返回 1
+    float progress() {
+        return done() ? 1 : drive_motion.progress;
+    }
+
+    // 阻塞直到运动结束
+    void wait() {
+        unsigned int tick = control_tick;
+        while (!done()) control_wait(tick);
+    }
+
+    // 阻塞直到进度达到 fraction(0~1) 或运动结束
+    void waitUntilProgress(float fraction) {
+        unsigned int tick = control_tick;
+        while (!done() && drive_motion.progress < fraction) control_wait(tick);
+    }
+
+    // 取消运动: 底盘刹车, 运动函数立即返回
+    void cancel() {
+        if (!done()) drive_motion.cancel = true;
+    }
+};
+
+/**
+ * @brief 后台运动任务: 按 motion_request 调用对应的同步运动函数
+ * @return 0
+ */
+int motion_async_fn()
+{
+  drive_motion.async_thread_id = this_thread::get_id();
+  MotionRequest r = motion_request;
+  if (r.kind == MOTION_DRIVE) {
+    run_gyro_JAR(r.target, r.heading, r.max_voltage);
+  } else if (r.kind == MOTION_TURN) {
+    Turn_Gyro_new(r.target);
+  } else if (r.kind == MOTION_SWING) {
+    turn_side_JAR(r.target, r.side, r.max_voltage, r.force_dir);
+  }
+  drive_motion.async_thread_id = -1;
+  drive_motion.async_busy = false;
+  return 0;
+}
+
+task MotionTask;
+
+/**
+ * @brief 启动后台运动(等待上一个异步运动结束后再启动)
+ */
+MotionHandle motion_start(MotionRequest r)
+{
+  while (drive_motion.async_busy || drive_motion.running) {
+    this_thread::sleep_for(5);
+  }
+  motion_request = r;
+  drive_motion.id++;
+  drive_motion.cancel = false;
+  drive_motion.progress = 0;
+  drive_motion.async_busy = true;
+  MotionTask = task(motion_async_fn);
+
+  MotionHandle h;
+  h.id = drive_motion.id;
+  return h;
+}
+
+/**
+ * @brief 阶段切换(自动 -> 手动)时调用: 结束后台运动并复位运动状态
+ * 先请求取消, 后台运动一般一两个节拍内刹车返回; 等不到就直接停掉 MotionTask。
+ * 被停掉的任务(或被系统结束的自动线程)来不及 motion_end(), 这里把占用标志、
+ * 链式承接和看门狗一并复位, 之后的运动不会卡在 motion_begin() 里
+ */
+void motion_reset()
+{
+  drive_motion.cancel = true;
+  for (int i = 0; i < 20 && drive_motion.async_busy; i++) {
+    this_thread::sleep_for(5);
+  }
+  if (drive_motion.async_busy) {
+    task::stop(MotionTask);
+    RunStop(brake);
+  }
+  drive_motion.async_busy = false;
+  drive_motion.async_thread_id = -1;
+  drive_motion.running = false;
+  drive_motion.cancel = false;
+  chain_pending = false;
+  chain_carry_output = 0;
+  chain_carry_distance = 0;
+  watchdog_reset();
+}
+
+/**
+ * @brief run_gyro_JAR 的异步版本, 参数含义相同
+ */
+MotionHandle run_gyro_JAR_async(double target_enc, float target_heading = now, float max_voltage = 127)
+{
+  MotionRequest r = {MOTION_DRIVE, target_enc, target_heading, max_voltage, left, 0};
+  return motion_start(r);
+}
+
+/**
+ * @brief Turn_Gyro_new 的异步版本, 参数含义相同
+ */
+MotionHandle Turn_Gyro_new_async(float target)
+{
+  MotionRequest r = {MOTION_TURN, target, 0, 0, left, 0};
+  now = target; // 与同步版本一致, 之后默认航向取本次目标
+  return motion_start(r);
+}
+
+/**
+ * @brief turn_side_JAR 的异步版本, 参数含义相同
+ */
+MotionHandle turn_side_JAR_async(float target_heading, turnType move_side, float max_voltage = 127, int force_dir = 0)
+{
+  MotionRequest r = {MOTION_SWING, target_heading, 0, max_voltage, move_side, force_dir};
+  now = target_heading;
+  return motion_start(r);
+}
@@ -0,0 +1,159 @@
+/**
+ * @file motion_result.h
+ * @brief 运动结果统计: 每段运动的退出原因、用时、稳定用时、最终误差、最大过冲, 自动结束后输出汇总表
+ *
+ * 1. 所有底盘运动函数开始时建一个 MotionMeter, 循环里每节拍 update(误差),
+ *    退出时 finish() 得到 MotionResult 并作为函数返回值, 同时记进本次自动的运动表(motion_log):
+ *    - 编码器直线/转向: Run_gyro / Run_gyro_new / run_gyro_JAR / run_gyro_profile / Runencode / Turnencode,
+ *      Turn_Gyro / Turn_Gyro_new / Turn_Side / turn_side_JAR
+ *    - 场地坐标: move_to_pose / follow_path(误差单位 mm)
+ *    - 测距仪直线: FAuto_Run_gyro / Dis_Run_gyro(误差为距目标距离, mm)
+ *    - 撞墙: Wall_Stop(误差为较慢一侧转速, 检测到堵转记为 settled),
+ *      Run_wall(误差为航向偏离, 顶满时间记为 settled, 偏离过大记为 timeout)
+ * 2. 退出原因(MotionExit, motion.h):
+ *    - settled: 误差稳定退出; chained: 链式运动在宽松误差处退出
+ *    - timeout: 运动自己的超时或看门狗截止; stalled: 看门狗无进展
+ *    - cancelled: MotionHandle::cancel()
+ * 3. 稳定用时: 误差第一次进入稳定误差到退出的时间, 即花在稳定窗口里的时间(超调后又出去也计入)
+ *    最大过冲: 误差越过 0 之后反方向的最大值(与初始误差同单位: 编码器度数或角度)
+ * 4. AutoPro() 开始时 motion_log_reset(), 结束时 motion_log_report() 输出逐段表和按函数的汇总
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 运动表
+///////////////////////////////////////////////////////////////////////////////
+const int MOTION_LOG_MAX = 64;       // 一次自动最多记录的运动段数
+
+struct MotionLogEntry {
+    const char *name;     // 运动函数名
+    float target;         // 目标(编码器度数或角度, 调用时的参数)
+    MotionResult r;
+};
+
+MotionLogEntry motion_log[MOTION_LOG_MAX];
+int motion_log_n = 0;
+unsigned int motion_log_dropped = 0;  // 表满后没记下的段数
+MotionResult motion_last_result = {MOTION_SETTLED, 0, 0, 0, 0}; // 最近一段运动的结果(异步运动也在这里)
+
+const char *motion_exit_name(int exit)
+{
+  switch (exit) {
+    case MOTION_SETTLED: return "settled";
+    case MOTION_TIMEOUT: return "timeout";
+    case MOTION_STALLED: return "stalled";
+    case MOTION_CANCELLED: return "cancelled";
+    case MOTION_CHAINED: return "chained";
+    default: return "?";
+  }
+}
+
+/**
+ * @brief 清空运动表
+ */
+void motion_log_reset()
+{
+  motion_log_n = 0;
+  motion_log_dropped = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 单段运动计量
+///////////////////////////////////////////////////////////////////////////////
+struct MotionMeter {
+    const char *name;
+    float target;
+    float settle_error;   // 稳定误差(进入即开始计稳定用时)
+    float sign;           // 初始误差的方向
+    uint64_t start_us;
+    uint64_t settle_us;   // 第一次进入稳定误差的时刻, 0 表示还没有
+    float error;          // 最近一次误差
+    float overshoot;
+
+    MotionMeter(const char *name, float target, float initial_error, float settle_error) :
+        name(name), target(target), settle_error(settle_error), sign(initial_error < 0 ? -1 : 1),
+        start_us(clock_us()), settle_us(0), error(initial_error), overshoot(0) {}
+
+    // 每节拍调用一次
+    void update(float current_error) {
+        error = current_error;
+        if (!settle_us && fabs(error) <= settle_error) settle_us = clock_us();
+        float over = -sign * error;
+        if (over > overshoot) overshoot = over;
+    }
+
+    // 运动结束时调用(看门狗撤销之前)
+    // settled: 运动自己判定为稳定退出(不是超时); chain_hit: 在链式退出误差处退出
+    MotionResult finish(bool settled, bool chain_hit = false) {
+        uint64_t now = clock_us();
+        MotionResult r;
+        if (watchdog.armed && watchdog.reason == WATCHDOG_NO_PROGRESS) r.exit = MOTION_STALLED;
+        else if (watchdog.armed && watchdog.reason == WATCHDOG_DEADLINE) r.exit = MOTION_TIMEOUT;
+        else if (drive_motion.cancel) r.exit = MOTION_CANCELLED;
+        else if (chain_hit) r.exit = MOTION_CHAINED;
+        else r.exit = settled ? MOTION_SETTLED : MOTION_TIMEOUT;
+        r.elapsed = (now - start_us) / 1e6;
+        r.settle_time = settle_us ? (now - settle_us) / 1e6 : 0;
+        r.final_error = error;
+        r.overshoot = overshoot;
+        motion_last_result = r;
+        if (motion_log_n < MOTION_LOG_MAX) {
+          MotionLogEntry &e = motion_log[motion_log_n++];
+          e.name = name;
+          e.target = target;
+          e.r = r;
+        } else {
+          motion_log_dropped++;
+        }
+        return r;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// 报表
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief 串口输出本次自动的运动表: 逐段一行, 再按运动函数汇总
+ * motion: #  name target exit elapsed settle final_err overshoot
+ * motion: sum name count settled timeout stalled time settle settle% max_overshoot
+ */
+void motion_log_report()
+{
+  printf("motion: segments=%d dropped=%u\n", motion_log_n, motion_log_dropped);
+  printf("motion: %3s %-16s %8s %-9s %7s %7s %9s %9s\n",
+         "#", "name", "target", "exit", "elapsed", "settle", "final_err", "overshoot");
+  for (int i = 0; i < motion_log_n; i++) {
+    const MotionLogEntry &e = motion_log[i];
+    printf("motion: %3d %-16s %8.1f %-9s %7.3f %7.3f %9.2f %9.2f\n", i, e.name, e.target,
+           motion_exit_name(e.r.exit), e.r.elapsed, e.r.settle_time, e.r.final_error, e.r.overshoot);
+  }
+
+  printf("motion: sum %-16s %5s %7s %7s %7s %7s %7s %7s %9s\n",
+         "name", "count", "settled", "timeout", "stalled", "time", "settle", "settle%", "max_over");
+  float all_time = 0, all_settle = 0;
+  for (int i = 0; i < motion_log_n; i++) {
+    const char *name = motion_log[i].name;
+    bool seen = false;
+    for (int j = 0; j < i && !seen; j++) seen = !strcmp(motion_log[j].name, name);
+    if (seen) continue;
+    int count = 0, settled = 0, timeout = 0, stalled = 0;
+    float time = 0, settle = 0, max_over = 0;
+    for (int j = i; j < motion_log_n; j++) {
+      const MotionLogEntry &e = motion_log[j];
+      if (strcmp(e.name, name)) continue;
+      count++;
+      if (e.r.exit == MOTION_SETTLED || e.r.exit == MOTION_CHAINED) settled++;
+      else if (e.r.exit == MOTION_TIMEOUT) timeout++;
+      else if (e.r.exit == MOTION_STALLED) stalled++;
+      time += e.r.elapsed;
+      settle += e.r.settle_time;
+      if (e.r.overshoot > max_over) max_over = e.r.overshoot;
+    }
+    all_time += time;
+    all_settle += settle;
+    printf("motion: sum %-16s %5d %7d %7d %7d %7.2f %7.2f %7.1f %9.2f\n", name, count, settled, timeout, stalled,
+           time, settle, time > 0 ? 100 * settle / time : 0, max_over);
+  }
+  printf("motion: total time=%.2fs settle=%.2fs (%.1f%%)\n", all_time, all_settle,
+         all_time > 0 ? 100 * all_settle / all_time : 0);
+}
@@ -0,0 +1,87 @@
+/**
+ * @file motor_group.h
+ * @brief 编译期定长电机组: 只保存电机引用, 一次调用下发/读取整组
+ *
+ * 1. MotorGroup<N> 内部是 N 个 motor 指针, 聚合初始化, 不拷贝 vex::motor 对象
+ * 2. 电压/速度/刹车指令一次调用发给整组, 取代各处手写的六行电机代码
+ * 3. 位置/速度/温度读取直接返回整组均值, 上层不再逐个电机相加
+ *
+ * 底盘左右两侧各一个三电机组(drive_left / drive_right), 所有底盘代码都通过它们访问电机。
+ * 功率单位与 m() 相同: -100~100, 按 0.12 倍换算为电压(100 对应 12V)。
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 电机组
+///////////////////////////////////////////////////////////////////////////////
+template <int N>
+struct MotorGroup {
+    motor *motors[N];
+
+    motor &operator[](int i) { return *motors[i]; }
+
+    // 电压模式: 整组同一功率
+    void power(float pwr) {
+        double volt = 0.12 * pwr;
+        for (int i = 0; i < N; i++) motors[i]->spin(fwd, volt, voltageUnits::volt);
+    }
+
+    // 速度模式: 扭矩上限与速度百分比
+    void velocity_pct(int torque, int speed) {
+        for (int i = 0; i < N; i++) {
+            motors[i]->setMaxTorque(torque, percentUnits::pct);
+            motors[i]->spin(directionType::fwd, speed, velocityUnits::pct);
+        }
+    }
+
+    void stop(brakeType mode) {
+        for (int i = 0; i < N; i++) motors[i]->stop(mode);
+    }
+
+    // 平均编码器值(度)
+    float position() {
+        float sum = 0;
+        for (int i = 0; i < N; i++) sum += motors[i]->position(deg);
+        return sum / N;
+    }
+
+    // 平均转速(rpm, 带符号)
+    float velocity() {
+        float sum = 0;
+        for (int i = 0; i < N; i++) sum += motors[i]->velocity(velocityUnits::rpm);
+        return sum / N;
+    }
+
+    // 平均转速绝对值(rpm), 用于日志和自适应参数
+    float speed() {
+        float sum = 0;
+        for (int i = 0; i < N; i++) sum += fabs(motors[i]->velocity(velocityUnits::rpm));
+        return sum / N;
+    }
+
+    // 一次遍历读出平均位置(度)、平均转速(rpm)与平均转速绝对值, 每个电机只读一次
+    void sample(float &pos, float &vel, float &spd) {
+        float p = 0, v = 0, a = 0;
+        for (int i = 0; i < N; i++) {
+            float rpm = motors[i]->velocity(velocityUnits::rpm);
+            p += motors[i]->position(deg);
+            v += rpm;
+            a += fabs(rpm);
+        }
+        pos = p / N;
+        vel = v / N;
+        spd = a / N;
+    }
+
+    // 平均温度(摄氏度)
+    float temperature() {
+        float sum = 0;
+        for (int i = 0; i < N; i++) sum += motors[i]->temperature(temperatureUnits::celsius);
+        return sum / N;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// 底盘电机组
+///////////////////////////////////////////////////////////////////////////////
+MotorGroup<3> drive_left = {{&LeftRun_1, &LeftRun_2, &LeftRun_3}};
+MotorGroup<3> drive_right = {{&RightRun_1, &RightRun_2, &RightRun_3}};
@@ -0,0 +1,148 @@
+/**
+ * @file odom.h
+ * @brief 底盘里程计: 六个驱动电机编码器 + 陀螺仪 -> 场地坐标 (x, y, θ)
+ *
+ * 1. 注册为执行器后台控制器, 每个节拍(10ms)更新一次
+ * 2. 左右两侧各取三个电机的平均编码器值, 航向取 Gyro.rotation, 均来自 sensors.h 的本节拍快照
+ * 3. 按圆弧模型积分: 弦长 = 2*sin(Δθ/2)*Δs/Δθ, 方向取本周期的平均航向
+ * 4. 位姿通过序号锁(seqlock)发布, 读取方无需加锁, 读到半新半旧的数据会自动重读
+ * 5. 只有执行器任务写积分状态; odom_set_pose() 登记请求, 由 odom_job 在节拍内应用
+ *
+ * 坐标约定与陀螺仪一致: 航向 0 朝 +y, 顺时针为正, 单位 mm / 度。
+ * 编码器不再在每次运动开始时清零, 运动函数用 drive_position() 记录起点做差。
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 里程计参数
+///////////////////////////////////////////////////////////////////////////////
+const float ODOM_WHEEL_MM = 82.55;                          // 驱动轮直径(3.25寸)
+const float ODOM_MM_PER_DEG = 3.14159265 * ODOM_WHEEL_MM / 360.0; // 电机每转1度车轮走过的距离(直连)
+
+struct Pose {
+    float x;             // mm
+    float y;             // mm
+    float theta;         // 度, 与陀螺仪同向
+    uint64_t time_us;    // 更新时刻(微秒, 本节拍快照的采样时刻)
+};
+
+volatile unsigned int odom_seq = 0;  // 序号锁: 奇数表示正在写
+Pose odom_state = {0, 0, 0, 0};
+float odom_heading_offset = 0;       // 场地航向 = Gyro.rotation + offset
+float odom_last_left = 0;            // 上一节拍左侧编码器(度)
+float odom_last_right = 0;           // 上一节拍右侧编码器(度)
+float odom_last_theta = 0;           // 上一节拍航向(度)
+Pose odom_request = {0, 0, 0, 0};    // odom_set_pose() 请求的位姿
+volatile bool odom_request_pending = false; // 有待 odom_job 应用的请求
+
+/**
+ * @brief 左侧三个驱动电机的平均编码器值(度)
+ */
+float drive_left_position()
+{
+  return sensors().left_pos;
+}
+
+/**
+ * @brief 右侧三个驱动电机的平均编码器值(度)
+ */
+float drive_right_position()
+{
+  return sensors().right_pos;
+}
+
+/**
+ * @brief 六个驱动电机的平均编码器值(度), 运动函数以此记录起点
+ */
+float drive_position()
+{
+  SensorSnapshot s = sensors();
+  return (s.left_pos + s.right_pos) / 2;
+}
+
+/**
+ * @brief 读取当前位姿(无锁快照)
+ */
+Pose odom_pose()
+{
+  Pose p;
+  unsigned int seq;
+  do {
+    seq = odom_seq;
+    __sync_synchronize();
+    p = odom_state;
+    __sync_synchronize();
+  } while ((seq & 1) || seq != odom_seq);
+  return p;
+}
+
+// 写入位姿(仅执行器任务调用)
+void odom_publish(float x, float y, float theta, uint64_t time_us)
+{
+  odom_seq++;
+  __sync_synchronize();
+  odom_state.x = x;
+  odom_state.y = y;
+  odom_state.theta = theta;
+  odom_state.time_us = time_us;
+  __sync_synchronize();
+  odom_seq++;
+}
+
+/**
+ * @brief 设定当前位姿(自动开始时按出发点标定)
+ * @param x 场地坐标(mm)
+ * @param y 场地坐标(mm)
+ * @param theta 场地航向(度)
+ *
+ * 只登记请求, 由 odom_job 在下一个节拍用同一份快照应用; 调用方等到应用完成才返回,
+ * 之后 odom_pose() 读到的就是新位姿。积分状态(odom_last_*)只有执行器任务会写。
+ */
+void odom_set_pose(float x, float y, float theta)
+{
+  odom_request.x = x;
+  odom_request.y = y;
+  odom_request.theta = theta;
+  __sync_synchronize();   // 请求写完再置位
+  odom_request_pending = true;
+  unsigned int tick = control_tick;
+  while (odom_request_pending) control_wait(tick);
+}
+
+/**
+ * @brief 里程计更新(执行器每个节拍调用)
+ */
+void odom_job(float dt)
+{
+  SensorSnapshot s = sensors();
+  float left = s.left_pos;
+  float right = s.right_pos;
+
+  // 重新标定: 以本节拍快照为新的积分起点
+  if (odom_request_pending) {
+    __sync_synchronize();
+    odom_heading_offset = odom_request.theta - s.heading;
+    odom_last_left = left;
+    odom_last_right = right;
+    odom_last_theta = odom_request.theta;
+    odom_publish(odom_request.x, odom_request.y, odom_request.theta, s.time_us);
+    odom_request_pending = false;
+    return;
+  }
+
+  float theta = s.heading + odom_heading_offset;
+
+  float ds = ((left - odom_last_left) + (right - odom_last_right)) / 2 * ODOM_MM_PER_DEG;
+  float dtheta = (theta - odom_last_theta) * 3.14159265 / 180.0;
+  float mid = (odom_last_theta * 3.14159265 / 180.0) + dtheta / 2;
+
+  // 圆弧模型: 转角很小时退化为直线
+  float chord = ds;
+  if (fabs(dtheta) > 1e-4) chord = 2 * sin(dtheta / 2) * ds / dtheta;
+
+  odom_last_left = left;
+  odom_last_right = right;
+  odom_last_theta = theta;
+  odom_publish(odom_state.x + chord * sin(mid), odom_state.y + chord * cos(mid), theta, s.time_us);
+}
+
+bool odom_started = control_register(odom_job); // 随执行器启动
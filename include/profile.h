@@ -0,0 +1,142 @@
+/**
+ * @file profile.h
+ * @brief 直线运动规划: 限加加速度(S 曲线)速度曲线
+ *
+ * 给定距离和最大速度/加速度/加加速度, 生成对称的 7 段 S 曲线:
+ *   加加速 -> 匀加速 -> 减加速 -> 匀速 -> 加减速 -> 匀减速 -> 减减速
+ * 距离不够时自动降低峰值速度(必要时峰值加速度也随之降低)。
+ * max_jerk <= 0 时退化为梯形曲线。
+ *
+ * 只依赖 math.h, 不访问任何设备, 可以直接在主机上单独验证。
+ * 单位与调用方一致(本工程直线用编码器度数、度/秒、度/秒^2、度/秒^3)。
+ */
+#include <math.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// S 曲线
+///////////////////////////////////////////////////////////////////////////////
+struct MotionProfile {
+    float distance;    // 总距离(带符号)
+    float v_peak;      // 实际峰值速度(正值)
+    float a_peak;      // 实际峰值加速度(正值)
+    float jerk;        // 加加速度(正值, 0 表示梯形)
+    float t_jerk;      // 单段加加速时间
+    float t_accel;     // 匀加速时间
+    float t_cruise;    // 匀速时间
+    float total_time;  // 总时间(秒)
+
+    // 规划 [0, distance] 的运动
+    void plan(float dist, float max_vel, float max_accel, float max_jerk) {
+        distance = dist;
+        jerk = max_jerk > 0 ? max_jerk : 0;
+        float d = fabs(dist);
+
+        // 峰值速度能否达到 max_vel: 加速段+减速段距离不超过总距离
+        float v = max_vel;
+        if (2 * accel_distance(v, max_accel) > d) {
+            float lo = 0, hi = max_vel;
+            for (int i = 0; i < 40; i++) {
+                float mid = (lo + hi) / 2;
+                if (2 * accel_distance(mid, max_accel) > d) hi = mid;
+                else lo = mid;
+            }
+            v = lo;
+        }
+        set_accel(v, max_accel);
+        float t_ramp = 2 * t_jerk + t_accel;
+        t_cruise = v > 0 ? (d - v * t_ramp) / v : 0;
+        if (t_cruise < 0) t_cruise = 0;
+        total_time = 2 * t_ramp + t_cruise;
+    }
+
+    // 取 t 时刻的参考位置/速度/加速度(带符号)
+    void sample(float t, float &pos, float &vel, float &acc) {
+        float s = distance < 0 ? -1 : 1;
+        float t_ramp = 2 * t_jerk + t_accel;
+        if (t <= 0) {
+            pos = 0; vel = 0; acc = 0;
+        } else if (t >= total_time) {
+            pos = fabs(distance); vel = 0; acc = 0;
+        } else if (t < t_ramp) {
+            ramp(t, pos, vel, acc);
+        } else if (t < t_ramp + t_cruise) {
+            float p0, v0, a0;
+            ramp(t_ramp, p0, v0, a0);
+            pos = p0 + v_peak * (t - t_ramp);
+            vel = v_peak;
+            acc = 0;
+        } else {
+            // 减速段与加速段关于终点对称
+            float p, v, a;
+            ramp(total_time - t, p, v, a);
+            pos = fabs(distance) - p;
+            vel = v;
+            acc = -a;
+        }
+        pos *= s; vel *= s; acc *= s;
+    }
+
+    // 加速段中速度第一次达到 v(正值)的时刻, 超过峰值时取加速段终点; 链式衔接时从这里接入曲线
+    float join_time(float v) {
+        float t_ramp = 2 * t_jerk + t_accel;
+        if (v >= v_peak) return t_ramp;
+        float lo = 0, hi = t_ramp;
+        for (int i = 0; i < 30; i++) {
+            float mid = (lo + hi) / 2, p, vel, a;
+            ramp(mid, p, vel, a);
+            if (vel < v) lo = mid;
+            else hi = mid;
+        }
+        return hi;
+    }
+
+    // 以峰值速度 v 加速所需距离(S 曲线关于中点对称, 平均速度为 v/2)
+    float accel_distance(float v, float max_accel) {
+        set_accel(v, max_accel);
+        return v * (2 * t_jerk + t_accel) / 2;
+    }
+
+    // 根据峰值速度确定加速段各时间
+    void set_accel(float v, float max_accel) {
+        v_peak = v;
+        if (jerk <= 0) {
+            a_peak = max_accel;
+            t_jerk = 0;
+            t_accel = v / max_accel;
+        } else if (v * jerk >= max_accel * max_accel) {
+            a_peak = max_accel;
+            t_jerk = max_accel / jerk;
+            t_accel = v / max_accel - t_jerk;
+        } else {
+            // 来不及达到最大加速度, 三角形加速度曲线
+            a_peak = sqrt(v * jerk);
+            t_jerk = a_peak / jerk;
+            t_accel = 0;
+        }
+    }
+
+    // 加速段(0 ~ 2*t_jerk+t_accel)内 tau 时刻的状态(正值)
+    void ramp(float tau, float &pos, float &vel, float &acc) {
+        float j = t_jerk > 0 ? a_peak / t_jerk : 0;
+        float v1 = j * t_jerk * t_jerk / 2;
+        float p1 = j * t_jerk * t_jerk * t_jerk / 6;
+        if (tau < t_jerk) {
+            acc = j * tau;
+            vel = j * tau * tau / 2;
+            pos = j * tau * tau * tau / 6;
+        } else if (tau < t_jerk + t_accel) {
+            float t2 = tau - t_jerk;
+            acc = a_peak;
+            vel = v1 + a_peak * t2;
+            pos = p1 + v1 * t2 + a_peak * t2 * t2 / 2;
+        } else {
+            float t3 = tau - t_jerk - t_accel;
+            if (t3 > t_jerk) t3 = t_jerk;
+            float v2 = v1 + a_peak * t_accel;
+            float p2 = p1 + v1 * t_accel + a_peak * t_accel * t_accel / 2;
+            acc = a_peak - j * t3;
+            vel = v2 + a_peak * t3 - j * t3 * t3 / 2;
+            pos = p2 + v2 * t3 + a_peak * t3 * t3 / 2 - j * t3 * t3 * t3 / 6;
+        }
+    }
+};
@@ -0,0 +1,358 @@
+/**
+ * @file pursuit.h
+ * @brief 纯追踪(Pure Pursuit)路径跟随: 按场地坐标的一串路点连续行驶
+ *
+ * 1. 路径: 当前位姿 + 路点连成折线, 每 PURSUIT_SPACING 插一个点后平滑, 折角变成圆弧
+ * 2. 限速: 每个点按曲率限制速度(侧向加速度上限), 再从终点反推减速, 保证能停住
+ * 3. 追踪: 每个节拍找最近点, 在其后的路径上取与前视圆的交点,
+ *    前视距离随速度自适应(慢时看近、快时看远), 由交点算出车体曲率
+ * 4. 输出: 曲率换算成左右轮速度, 用 feedforward.h 两侧各自的前馈模型换算成功率
+ *
+ * 路点使用 odom.h 的场地坐标(mm), 起点前先用 odom_set_pose() 标定。
+ * 与其他运动函数一样参与 drive_motion 的进度/取消/链式运动。
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 路径参数
+///////////////////////////////////////////////////////////////////////////////
+const int   PURSUIT_MAX_POINTS = 400;   // 插值后路径最多点数(间距 25mm 约 10 米)
+const float PURSUIT_SPACING = 25;       // 插值间距(mm)
+const float PURSUIT_SMOOTH = 0.75;      // 平滑权重, 越大圆弧越圆
+const float PURSUIT_TRACK_MM = 290;     // 有效轮距(mm), 含原地转向打滑
+const float PURSUIT_MAX_SPEED = 700;    // 最大速度(mm/s)
+const float PURSUIT_MIN_SPEED = 120;    // 末端最低速度(mm/s), 避免停在终点前
+const float PURSUIT_ACCEL = 1500;       // 加减速度(mm/s^2)
+const float PURSUIT_LAT_ACCEL = 1200;   // 侧向加速度上限(mm/s^2), 决定弯道限速
+const float PURSUIT_LOOKAHEAD_MIN = 150; // 最小前视距离(mm)
+const float PURSUIT_LOOKAHEAD_MAX = 400; // 最大前视距离(mm)
+const float PURSUIT_LOOKAHEAD_GAIN = 0.35; // 前视距离随速度增加的系数(s)
+const float PURSUIT_END_ERROR = 25;     // 到达终点的距离容差(mm)
+
+struct Waypoint {
+    float x;  // mm
+    float y;  // mm
+};
+
+struct PathPoint {
+    float x, y;
+    float s;          // 从起点起的路程(mm)
+    float curvature;  // 曲率(1/mm)
+    float v;          // 限速(mm/s)
+};
+
+PathPoint pursuit_path[PURSUIT_MAX_POINTS];
+Waypoint pursuit_raw[PURSUIT_MAX_POINTS]; // 平滑前的插值点
+int pursuit_count = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+// 路径生成
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief 由起点和路点生成插值、平滑、限速后的路径(写入 pursuit_path)
+ * @param start_x 起点(通常为当前位姿)
+ * @param start_y 起点
+ * @param pts 路点
+ * @param n 路点个数
+ * @param max_speed 最高速度(mm/s)
+ */
+void pursuit_build(float start_x, float start_y, const Waypoint *pts, int n, float max_speed)
+{
+  // 1. 按固定间距插值
+  pursuit_count = 0;
+  float px = start_x, py = start_y;
+  for (int i = 0; i < n; i++) {
+    float dx = pts[i].x - px, dy = pts[i].y - py;
+    float len = sqrt(dx * dx + dy * dy);
+    int steps = (int)(len / PURSUIT_SPACING);
+    for (int k = 0; k < steps && pursuit_count < PURSUIT_MAX_POINTS - 1; k++) {
+      pursuit_path[pursuit_count].x = px + dx * k * PURSUIT_SPACING / len;
+      pursuit_path[pursuit_count].y = py + dy * k * PURSUIT_SPACING / len;
+      pursuit_count++;
+    }
+    px = pts[i].x;
+    py = pts[i].y;
+  }
+  pursuit_path[pursuit_count].x = px;
+  pursuit_path[pursuit_count].y = py;
+  pursuit_count++;
+
+  // 2. 平滑(首尾固定): 每个点在贴近原折线(a)与贴近相邻点(b)之间折中, 迭代到收敛
+  for (int i = 0; i < pursuit_count; i++) {
+    pursuit_raw[i].x = pursuit_path[i].x;
+    pursuit_raw[i].y = pursuit_path[i].y;
+  }
+  float a = 1 - PURSUIT_SMOOTH, b = PURSUIT_SMOOTH;
+  for (int iter = 0; iter < 200; iter++) {
+    float change = 0;
+    for (int i = 1; i < pursuit_count - 1; i++) {
+      PathPoint &p = pursuit_path[i];
+      float ox = p.x, oy = p.y;
+      p.x += a * (pursuit_raw[i].x - p.x) + b * (pursuit_path[i - 1].x + pursuit_path[i + 1].x - 2 * p.x);
+      p.y += a * (pursuit_raw[i].y - p.y) + b * (pursuit_path[i - 1].y + pursuit_path[i + 1].y - 2 * p.y);
+      change += fabs(p.x - ox) + fabs(p.y - oy);
+    }
+    if (change < 0.01) break;
+  }
+
+  // 3. 路程与曲率(三点外接圆)
+  pursuit_path[0].s = 0;
+  for (int i = 1; i < pursuit_count; i++) {
+    float dx = pursuit_path[i].x - pursuit_path[i - 1].x;
+    float dy = pursuit_path[i].y - pursuit_path[i - 1].y;
+    pursuit_path[i].s = pursuit_path[i - 1].s + sqrt(dx * dx + dy * dy);
+  }
+  for (int i = 0; i < pursuit_count; i++) {
+    pursuit_path[i].curvature = 0;
+    if (i == 0 || i == pursuit_count - 1) continue;
+    PathPoint &p0 = pursuit_path[i - 1], &p1 = pursuit_path[i], &p2 = pursuit_path[i + 1];
+    float d01 = sqrt((p1.x - p0.x) * (p1.x - p0.x) + (p1.y - p0.y) * (p1.y - p0.y));
+    float d12 = sqrt((p2.x - p1.x) * (p2.x - p1.x) + (p2.y - p1.y) * (p2.y - p1.y));
+    float d02 = sqrt((p2.x - p0.x) * (p2.x - p0.x) + (p2.y - p0.y) * (p2.y - p0.y));
+    float cross = fabs((p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x));
+    if (d01 * d12 * d02 > 1e-3) pursuit_path[i].curvature = 2 * cross / (d01 * d12 * d02);
+  }
+
+  // 4. 限速: 曲率限速, 再从终点反推减速
+  for (int i = 0; i < pursuit_count; i++) {
+    float v = max_speed;
+    float k = pursuit_path[i].curvature;
+    if (k > 1e-6) {
+      float v_curve = sqrt(PURSUIT_LAT_ACCEL / k);
+      if (v_curve < v) v = v_curve;
+    }
+    pursuit_path[i].v = v;
+  }
+  pursuit_path[pursuit_count - 1].v = PURSUIT_MIN_SPEED;
+  for (int i = pursuit_count - 2; i >= 0; i--) {
+    float ds = pursuit_path[i + 1].s - pursuit_path[i].s;
+    float v_stop = sqrt(pursuit_path[i + 1].v * pursuit_path[i + 1].v + 2 * PURSUIT_ACCEL * ds);
+    if (v_stop < pursuit_path[i].v) pursuit_path[i].v = v_stop;
+    if (pursuit_path[i].v < PURSUIT_MIN_SPEED) pursuit_path[i].v = PURSUIT_MIN_SPEED;
+  }
+}
+
+/**
+ * @brief 在路径上找前视点: 从 start 段开始与圆(圆心 x,y 半径 r)求交, 取最靠后的交点
+ * @param frac 输入上次前视点的小数下标, 输出本次结果(前视点只前进不后退)
+ * @return 是否找到交点
+ */
+bool pursuit_lookahead(float x, float y, float r, int start, float &frac, float &lx, float &ly)
+{
+  bool found = false;
+  for (int i = start; i < pursuit_count - 1; i++) {
+    PathPoint &a = pursuit_path[i], &b = pursuit_path[i + 1];
+    float dx = b.x - a.x, dy = b.y - a.y;
+    float fx = a.x - x, fy = a.y - y;
+    float qa = dx * dx + dy * dy;
+    float qb = 2 * (fx * dx + fy * dy);
+    float qc = fx * fx + fy * fy - r * r;
+    float disc = qb * qb - 4 * qa * qc;
+    if (qa < 1e-6 || disc < 0) continue;
+    disc = sqrt(disc);
+    float t2 = (-qb + disc) / (2 * qa);
+    float t1 = (-qb - disc) / (2 * qa);
+    float t = (t2 >= 0 && t2 <= 1) ? t2 : ((t1 >= 0 && t1 <= 1) ? t1 : -1);
+    if (t < 0) continue;
+    if (i + t < frac) continue;
+    frac = i + t;
+    lx = a.x + t * dx;
+    ly = a.y + t * dy;
+    found = true;
+  }
+  return found;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 路径跟随
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief 纯追踪跟随一串场地路点
+ * @param pts 路点(场地坐标 mm), 不含起点
+ * @param n 路点个数
+ * @param max_speed 最高速度(mm/s)
+ * @param reverse 是否倒车跟随
+ * @param max_voltage 最大输出功率 (0-100)
+ * @return 运动结果(motion_result.h), 目标为路径长度(mm), 误差为到终点的距离(mm, 越过终点为负)
+ */
+MotionResult follow_path(const Waypoint *pts, int n, float max_speed = PURSUIT_MAX_SPEED, bool reverse = false, float max_voltage = 127)
+{
+  bool chained = motion_begin();
+  Pose pose = odom_pose();
+  pursuit_build(pose.x, pose.y, pts, n, max_speed);
+
+  PathPoint &end = pursuit_path[pursuit_count - 1];
+  float timeout = end.s / 200.0 * 1000 + 1500; // 按平均 200mm/s 估算再加 1.5 秒
+  MotionWatch watch("follow_path", timeout + WATCHDOG_MARGIN_MS);
+  float time_spent = 0;
+  int closest = 0;
+  float frac = 0;
+  float v_cmd = 0;
+  if (chain_carry_output != 0) {
+    // 链式衔接: 上一段没有刹车, 速度指令从当前行驶方向上的车速开始
+    SensorSnapshot snap = sensors();
+    float v_now = (snap.left_vel + snap.right_vel) / 2 * 6 * ODOM_MM_PER_DEG; // rpm -> mm/s
+    if (reverse) v_now = -v_now;
+    if (v_now > 0) v_cmd = v_now;
+  }
+  float last_left = drive_left_position(), last_right = drive_right_position();
+  unsigned int tick = control_tick;
+  float dt = CONTROL_DT;   // 两次快照的实际间隔
+  float left_out = 0, right_out = 0;
+  MotionMeter meter("follow_path", end.s, end.s, PURSUIT_END_ERROR);
+  bool arrived = false, chain_hit = false;
+
+  while (time_spent < timeout && !motion_cancelled()) {
+    pose = odom_pose();
+    float left = drive_left_position(), right = drive_right_position();
+    float v_left = (left - last_left) * ODOM_MM_PER_DEG / dt;
+    float v_right = (right - last_right) * ODOM_MM_PER_DEG / dt;
+    last_left = left;
+    last_right = right;
+    float v_meas = fabs(v_left + v_right) / 2;
+
+    // 最近点: 只向前搜索, 避免在交叉路径上跳回
+    float best = 1e9;
+    for (int i = closest; i < pursuit_count && i < closest + 40; i++) {
+      float dx = pursuit_path[i].x - pose.x, dy = pursuit_path[i].y - pose.y;
+      float d = dx * dx + dy * dy;
+      if (d < best) { best = d; closest = i; }
+    }
+    float cross_track = sqrt(best);
+    motion_progress(pursuit_path[closest].s, end.s);
+
+    // 终点判定: 足够近, 或已越过终点(终点在车体后方)
+    float heading = pose.theta + (reverse ? 180 : 0);
+    float hr = heading * 3.14159265 / 180.0;
+    float ex = end.x - pose.x, ey = end.y - pose.y;
+    float end_dist = sqrt(ex * ex + ey * ey);
+    float end_forward = ex * sin(hr) + ey * cos(hr);
+    meter.update(end_forward < 0 ? -end_dist : end_dist);
+    if (closest >= pursuit_count - 3 && (end_dist < PURSUIT_END_ERROR || end_forward < 0)) {
+      arrived = true;
+      break;
+    }
+    if (chained && end.s - pursuit_path[closest].s < CHAIN_DRIVE_EXIT * ODOM_MM_PER_DEG) {
+      chain_hit = true;
+      break;
+    }
+
+    // 自适应前视距离
+    float lookahead = PURSUIT_LOOKAHEAD_MIN + PURSUIT_LOOKAHEAD_GAIN * v_meas;
+    if (lookahead > PURSUIT_LOOKAHEAD_MAX) lookahead = PURSUIT_LOOKAHEAD_MAX;
+    float lx = end.x, ly = end.y;
+    if (!pursuit_lookahead(pose.x, pose.y, lookahead, closest, frac, lx, ly) && end_dist > lookahead) {
+      // 偏离路径超过前视距离: 直接追最近点后一段
+      int i = closest + (int)(lookahead / PURSUIT_SPACING);
+      if (i > pursuit_count - 1) i = pursuit_count - 1;
+      lx = pursuit_path[i].x;
+      ly = pursuit_path[i].y;
+    }
+
+    // 车体坐标系下前视点横向偏移 -> 曲率(正值向右/顺时针)
+    float dx = lx - pose.x, dy = ly - pose.y;
+    float local_x = dx * cos(hr) - dy * sin(hr);
+    float dist2 = dx * dx + dy * dy;
+    float curvature = dist2 > 1 ? 2 * local_x / dist2 : 0;
+
+    // 目标速度: 路径限速 + 加速度限制
+    float v_target = pursuit_path[closest].v;
+    if (v_target > v_cmd + PURSUIT_ACCEL * dt) v_target = v_cmd + PURSUIT_ACCEL * dt;
+    v_cmd = v_target;
+
+    // 左右轮速度(mm/s) -> 编码器度/秒 -> 前馈功率
+    float wl = v_cmd * (1 + curvature * PURSUIT_TRACK_MM / 2) / ODOM_MM_PER_DEG;
+    float wr = v_cmd * (1 - curvature * PURSUIT_TRACK_MM / 2) / ODOM_MM_PER_DEG;
+    if (reverse) {
+      float t = wl;
+      wl = -wr;
+      wr = -t;
+    }
+    left_out = ff_left(wl);
+    right_out = ff_right(wr);
+
+    // 限幅时两侧按比例缩小, 保持曲率
+    float biggest = fabs(left_out) > fabs(right_out) ? fabs(left_out) : fabs(right_out);
+    if (biggest > max_voltage) {
+      left_out = left_out * max_voltage / biggest;
+      right_out = right_out * max_voltage / biggest;
+    }
+
+    current_telemetry.action = 6; // 标记为 6 (路径跟随)
+    current_telemetry.target = v_cmd;
+    current_telemetry.current = v_meas;
+    current_telemetry.error = cross_track;
+    current_telemetry.error_deriv = 0;
+    current_telemetry.dt = dt;
+    current_telemetry.p_out = 0;
+    current_telemetry.i_out = 0;
+    current_telemetry.d_out = 0;
+    current_telemetry.total_out = (left_out + right_out) / 2;
+    current_telemetry.aux_error = curvature * 1000; // 1/m
+    current_telemetry.aux_deriv = lookahead;
+    current_telemetry.aux_out = (left_out - right_out) / 2;
+    current_telemetry.gyro_pitch = sensors().pitch;
+    telemetry_publish(current_telemetry);
+
+    Run_Ctrl(left_out, right_out);
+    dt = control_wait(tick);
+    time_spent += dt * 1000;
+  }
+  if (motion_should_stop()) RunStop(brake);
+  // 链式退出时终点在车头方向上还差的距离(倒车为负), 交给下一段直线
+  Pose fin = odom_pose();
+  float fr = fin.theta * 3.14159265 / 180.0;
+  motion_end((left_out + right_out) / 2, ((end.x - fin.x) * sin(fr) + (end.y - fin.y) * cos(fr)) / ODOM_MM_PER_DEG);
+  return meter.finish(arrived, chain_hit);
+}
+
+/**
+ * @brief 路径跟随测试函数(含遥测日志)
+ * @param zigzag false: follow_path 连续跟随; true: 同样的路点改用原地转向+直线逐段走(对照)
+ *
+ * 以当前位置为原点走一段 S 形路线, 输出一行汇总:
+ * pursuit: mode=.. time=用时 end_err=终点误差(mm) max_track=最大偏离路径(mm)
+ */
+void test_pursuit(bool zigzag = false)
+{
+  Side = 1;
+  Start = sensors().heading;
+  now = 0;
+  odom_set_pose(0, 0, 0);
+  Waypoint route[] = {{0, 400}, {400, 800}, {400, 1300}};
+  int n = sizeof(route) / sizeof(route[0]);
+
+  current_telemetry = {0};
+  printf("test_pursuit_%s\n", zigzag ? "zigzag" : "follow");
+  test_log_start();
+
+  unsigned int t0 = timer::system();
+  if (zigzag) {
+    float x = 0, y = 0;
+    for (int i = 0; i < n; i++) {
+      float dx = route[i].x - x, dy = route[i].y - y;
+      float heading = atan2(dx, dy) * 180 / 3.14159265;
+      if (fabs(reduce_negative_180_to_180(heading - now)) > 1) Turn_Gyro_new(heading);
+      run_gyro_JAR(sqrt(dx * dx + dy * dy) / ODOM_MM_PER_DEG, heading);
+      x = route[i].x;
+      y = route[i].y;
+    }
+  } else {
+    follow_path(route, n);
+  }
+  unsigned int t1 = timer::system();
+
+  test_log_active = false;
+  vex::task::sleep(300);
+  Pose p = odom_pose();
+  float ex = route[n - 1].x - p.x, ey = route[n - 1].y - p.y;
+  float max_track = 0;
+  for (int i = 0; i < test_log_count; i++) {
+    if (test_log_buf[i].t.action == 6 && test_log_buf[i].t.error > max_track) max_track = test_log_buf[i].t.error;
+  }
+
+  test_log_dump();
+  printf("pursuit: mode=%s time=%.3fs end_err=%.1f max_track=%.1f\n",
+         zigzag ? "zigzag" : "follow", (t1 - t0) / 1000.0, sqrt(ex * ex + ey * ey), max_track);
+}
@@ -0,0 +1,228 @@
+/**
+ * @file recorder.h
+ * @brief 比赛记录仪: 自动与手动阶段全程把遥测写入 SD 卡, 赛后用 rec_read.py 读取
+ *
+ * 1. 挂在 100Hz 执行器上, 每节拍取本节拍快照(sensors.h)、里程计位姿和机构指令, 用 log_codec.h
+ *    编成二进制帧(增量 + 变长整数, 每帧带 CRC)。运动函数的遥测在节拍末尾才由 telemetry_publish()
+ *    发布, 所以每行晚一拍写出: 下一节拍取到同一节拍的遥测(telemetry_latest)填进去, 没有运动时遥测列为 0
+ * 2. 双缓冲: 执行器只把帧拷进当前缓冲, 缓冲满了交给写卡任务并换另一块;
+ *    SD 卡读写全部在写卡任务里, 不占控制节拍。写卡任务没跟上时整帧丢弃并计数
+ * 3. 每个阶段(自动/手动)是一段独立的流, 以模式头帧开始; 阶段结束(失能或切换)时
+ *    把不满的缓冲也交给写卡任务
+ * 4. 每次开机第一次记录时选一个未用的文件名 rec_000.bin ~ rec_999.bin, 之后都追加到这个文件
+ *
+ * 文件格式: 每帧一条记录 [0xA5][帧长 2B 小端][帧], 帧格式见 log_codec.h。
+ * 记录头用于损坏后重新同步, 坏帧由 CRC 丢弃, 不影响前后的帧。
+ *
+ * 仿真中 Brain.SDcard 写到 --sd 指定的主机目录。
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 参数
+///////////////////////////////////////////////////////////////////////////////
+const int REC_BUFFER_BYTES = 4096;  // 单块缓冲大小, 100Hz 下约 1 秒写一次卡
+const int REC_WRITER_MS = 20;       // 写卡任务轮询间隔
+const unsigned char REC_SYNC = 0xA5;
+
+enum RecMode { REC_OFF = 0, REC_AUTO = 1, REC_DRIVER = 2 };
+
+// 记录字段: 底盘状态 + 当前运动函数遥测 + 机构指令
+const int REC_FIELDS_N = 19;
+const char *const REC_FIELDS[REC_FIELDS_N] = {
+  "time_s", "mode", "x", "y", "theta", "heading", "pitch", "left_vel", "right_vel",
+  "action", "target", "error", "total_out",
+  "intake_cmd", "ball_cmd", "shoot_cmd", "intake_vel", "ball_vel", "max_late_ms"};
+const int REC_SCALES[REC_FIELDS_N] = {
+  100000, 1, 1, 1, 100, 100, 100, 10, 10,
+  1, 100, 100, 100,
+  1, 1, 1, 10, 10, 1};
+const LogSchema rec_schema = {"match_v1", REC_FIELDS_N, REC_FIELDS, REC_SCALES};
+
+///////////////////////////////////////////////////////////////////////////////
+// 状态
+///////////////////////////////////////////////////////////////////////////////
+struct Recorder {
+    unsigned char buf[2][REC_BUFFER_BYTES];
+    int len[2];
+    int active;                 // 执行器正在填的缓冲
+    volatile int pending;       // 交给写卡任务的缓冲号 + 1, 0 表示没有
+    volatile bool writing;      // 写卡任务正在写 pending 那块
+    bool flush_wanted;          // 阶段已结束, 等写卡任务空出来再交出不满的缓冲
+    int mode;                   // 当前阶段(RecMode)
+    bool closed;                // recorder_close() 之后不再记录
+    LogEncoder enc;
+    float row[REC_FIELDS_N];    // 等本节拍遥测的一行
+    unsigned int row_tick;      // 这一行的节拍号
+    bool row_ready;             // row 里有一行还没写出
+    char file[16];              // 本次开机使用的文件名, 空表示还没选
+    unsigned int samples;
+    unsigned int frames;
+    unsigned int dropped;       // 两块缓冲都满而丢弃的帧
+    unsigned int bytes;         // 已写入 SD 卡的字节数
+    unsigned int errors;        // 写卡失败次数
+};
+
+Recorder rec = {};
+
+///////////////////////////////////////////////////////////////////////////////
+// 执行器侧
+///////////////////////////////////////////////////////////////////////////////
+
+// 把当前缓冲交给写卡任务; 写卡任务还在写上一块时返回 false
+bool rec_swap()
+{
+  if (rec.pending) return false;
+  if (rec.len[rec.active] == 0) return true;
+  __sync_synchronize();                // 缓冲内容先于 pending 可见
+  rec.pending = rec.active + 1;
+  rec.active ^= 1;
+  rec.len[rec.active] = 0;
+  return true;
+}
+
+// LogEncoder 的输出: 加记录头拷进当前缓冲
+void rec_emit(const LogFrame &f)
+{
+  int need = f.len + 3;
+  if (rec.len[rec.active] + need > REC_BUFFER_BYTES && !rec_swap()) {
+    rec.dropped++;
+    return;
+  }
+  unsigned char *p = rec.buf[rec.active] + rec.len[rec.active];
+  p[0] = REC_SYNC;
+  p[1] = f.len & 0xFF;
+  p[2] = f.len >> 8;
+  memcpy(p + 3, f.buf, f.len);
+  rec.len[rec.active] += need;
+  rec.frames++;
+}
+
+// 写出等待中的一行: 遥测列取同一节拍发布的样本
+void rec_flush_row()
+{
+  if (!rec.row_ready) return;
+  rec.row_ready = false;
+  TelemetrySample latest = telemetry_read_latest();
+  bool same = latest.time_us && latest.tick == rec.row_tick;
+  rec.row[9] = same ? (float)latest.t.action : 0;
+  rec.row[10] = same ? latest.t.target : 0;
+  rec.row[11] = same ? latest.t.error : 0;
+  rec.row[12] = same ? latest.t.total_out : 0;
+  log_encoder_add(rec.enc, rec.row);
+  rec.samples++;
+}
+
+int rec_mode_now()
+{
+  if (!Competition.isEnabled()) return REC_OFF;
+  return Competition.isAutonomous() ? REC_AUTO : REC_DRIVER;
+}
+
+/**
+ * @brief 执行器任务: 阶段切换时开始/结束一段流, 阶段内每节拍记录一个样本
+ */
+void recorder_job(float dt)
+{
+  if (rec.closed) return;
+  if (rec.flush_wanted && rec_swap()) rec.flush_wanted = false;
+
+  int mode = rec_mode_now();
+  rec_flush_row();
+  if (mode != rec.mode) {
+    if (rec.mode != REC_OFF) {
+      log_encoder_finish(rec.enc);
+      rec.flush_wanted = !rec_swap();
+    }
+    rec.mode = mode;
+    if (mode != REC_OFF) log_encoder_begin(rec.enc, rec_schema, rec_emit);
+  }
+  if (mode == REC_OFF) return;
+
+  SensorSnapshot s = sensors();
+  Pose p = odom_pose();
+  float row[REC_FIELDS_N] = {
+    s.time_us / 1e6f, (float)mode, p.x, p.y, p.theta, s.heading, s.pitch, s.left_vel, s.right_vel,
+    0, 0, 0, 0,   // 遥测, 下一节拍 rec_flush_row() 填
+    (float)mech_cmd[MECH_INTAKE], (float)mech_cmd[MECH_BALL], (float)mech_cmd[MECH_SHOOT],
+    s.intake.velocity, s.ball.velocity, (float)executor_stats.max_late_ms};
+  memcpy(rec.row, row, sizeof(row));
+  rec.row_tick = s.tick;
+  rec.row_ready = true;
+}
+bool recorder_started = control_register(recorder_job);
+
+///////////////////////////////////////////////////////////////////////////////
+// 写卡任务
+///////////////////////////////////////////////////////////////////////////////
+
+// 第一次写卡时选文件名(SD 卡调用都在写卡任务里)
+bool rec_open()
+{
+  if (rec.file[0]) return true;
+  if (!Brain.SDcard.isInserted()) return false;
+  for (int i = 0; i < 1000; i++) {
+    snprintf(rec.file, sizeof(rec.file), "rec_%03d.bin", i);
+    if (!Brain.SDcard.exists(rec.file)) return true;
+  }
+  rec.file[0] = 0;
+  return false;
+}
+
+void rec_write(int b)
+{
+  if (!rec_open()) {
+    rec.errors++;
+    return;
+  }
+  int n = Brain.SDcard.appendfile(rec.file, rec.buf[b], rec.len[b]);
+  if (n == rec.len[b]) rec.bytes += n;
+  else rec.errors++;
+}
+
+int recorder_task_fn()
+{
+  while (true) {
+    int b = rec.pending - 1;
+    if (b >= 0 && !rec.closed) {
+      rec.writing = true;
+      __sync_synchronize();
+      rec_write(b);
+      rec.len[b] = 0;
+      __sync_synchronize();
+      rec.pending = 0;
+      rec.writing = false;
+    }
+    task_wait("recorder", REC_WRITER_MS);
+  }
+  return 0;
+}
+
+task RecorderTask = task(recorder_task_fn);
+
+/**
+ * @brief 结束记录并把缓冲里剩下的数据直接写卡(程序退出前调用)
+ */
+void recorder_close()
+{
+  if (rec.closed) return;
+  rec.closed = true;
+  while (rec.writing) task::sleep(1);
+  if (rec.mode != REC_OFF) {
+    rec_flush_row();
+    log_encoder_finish(rec.enc);
+  }
+  if (rec.pending) rec_write(rec.pending - 1);
+  rec.pending = 0;
+  if (rec.len[rec.active] > 0) rec_write(rec.active);
+  rec.len[0] = rec.len[1] = 0;
+}
+
+/**
+ * @brief 串口输出记录仪统计
+ * recorder: file= samples= frames= bytes= dropped= errors=
+ */
+void recorder_report()
+{
+  printf("recorder: file=%s samples=%u frames=%u bytes=%u dropped=%u errors=%u\n",
+         rec.file[0] ? rec.file : "-", rec.samples, rec.frames, rec.bytes, rec.dropped, rec.errors);
+}
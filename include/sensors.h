@@ -0,0 +1,146 @@
+/**
+ * @file sensors.h
+ * @brief 传感器快照: 每个节拍把所有智能端口设备读一遍, 控制环只读快照
+ *
+ * 1. 注册为执行器的第一个后台控制器, 每个节拍(10ms)开头采样一次, 之后的里程计与
+ *    所有运动循环(control_wait 醒来后)读到的都是本节拍的同一份数据
+ * 2. 每个设备每节拍只访问一次: 底盘六电机(位置/转速)、陀螺仪(航向/俯仰)、
+ *    三个颜色传感器(接近/色相/饱和度/亮度)、两个测距仪、吸球/分球/射球电机(转速/电流)
+ * 3. 快照通过序号锁(seqlock)发布, 与 odom.h 相同, 读取方无需加锁
+ *
+ * 快照时间戳取采样时刻的 clock_us()(微秒, 另存毫秒值), 节拍号取 control_tick。
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 快照结构
+///////////////////////////////////////////////////////////////////////////////
+struct OpticalReading {
+    bool near;          // 是否有物体靠近
+    float hue;          // 色相(0-360)
+    float saturation;   // 饱和度(0-1), 由 getRgb(false) 计算
+    float brightness;   // 亮度(%)
+};
+
+struct MechReading {
+    float velocity;     // 转速(rpm)
+    float current;      // 电流(A)
+    float torque;       // 扭矩(Nm)
+};
+
+struct SensorSnapshot {
+    uint64_t time_us;     // 采样时刻(微秒, clock.h)
+    unsigned int time;    // 采样时刻(ms)
+    unsigned int tick;    // 采样所在节拍
+    float left_pos;       // 左侧三电机平均编码器(度)
+    float right_pos;      // 右侧三电机平均编码器(度)
+    float left_vel;       // 左侧平均转速(rpm, 带符号)
+    float right_vel;      // 右侧平均转速(rpm, 带符号)
+    float left_speed;     // 左侧平均转速绝对值(rpm)
+    float right_speed;    // 右侧平均转速绝对值(rpm)
+    float heading;        // Gyro.rotation(度)
+    float pitch;          // Gyro.pitch(度)
+    OpticalReading color_up;    // Color, 进球口上方
+    OpticalReading color_low;   // Color_2, 进球口下方
+    OpticalReading color_out;   // Color_3, 吐球口
+    float dist1;          // Distance1(mm, 9999 为无目标)
+    float dist2;          // Distance2(mm)
+    MechReading intake;   // Intake_1
+    MechReading ball;     // Ball_1
+    MechReading shoot;    // Shoot_1
+};
+
+volatile unsigned int sensor_seq = 0;  // 序号锁: 奇数表示正在写
+SensorSnapshot sensor_state;
+bool sensor_valid = false;             // 执行器是否已完成第一次采样
+
+///////////////////////////////////////////////////////////////////////////////
+// 采样与读取
+///////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief 由 RGB 计算饱和度(0-1), 与光强无关
+ */
+float rgb_saturation(float r, float g, float b)
+{
+  float mx = r > g ? (r > b ? r : b) : (g > b ? g : b);
+  float mn = r < g ? (r < b ? r : b) : (g < b ? g : b);
+  return mx > 0 ? (mx - mn) / mx : 0;
+}
+
+// 颜色传感器三次读取: 接近、色相、RGB(含亮度)
+OpticalReading optical_read(optical &sensor)
+{
+  OpticalReading r;
+  r.near = sensor.isNearObject();
+  r.hue = sensor.hue();
+  optical::rgbc rgb = sensor.getRgb(false);  // 非原始值: 亮度为百分比, 与 min_bright 同单位
+  r.saturation = rgb_saturation(rgb.red, rgb.green, rgb.blue);
+  r.brightness = rgb.brightness;
+  return r;
+}
+
+MechReading mech_read(motor &mtr)
+{
+  MechReading r;
+  r.velocity = mtr.velocity(velocityUnits::rpm);
+  r.current = mtr.current(currentUnits::amp);
+  r.torque = mtr.torque(torqueUnits::Nm);
+  return r;
+}
+
+// 读所有设备到 out (不发布)
+void sensors_sample(SensorSnapshot &out)
+{
+  out.time_us = clock_us();
+  out.time = out.time_us / 1000;
+  out.tick = control_tick;
+  drive_left.sample(out.left_pos, out.left_vel, out.left_speed);
+  drive_right.sample(out.right_pos, out.right_vel, out.right_speed);
+  out.heading = Gyro.rotation(degrees);
+  out.pitch = Gyro.pitch(degrees);
+  out.color_up = optical_read(Color);
+  out.color_low = optical_read(Color_2);
+  out.color_out = optical_read(Color_3);
+  out.dist1 = Distance1.objectDistance(distanceUnits::mm);
+  out.dist2 = Distance2.objectDistance(distanceUnits::mm);
+  out.intake = mech_read(Intake_1);
+  out.ball = mech_read(Ball_1);
+  out.shoot = mech_read(Shoot_1);
+}
+
+/**
+ * @brief 读取本节拍快照(无锁)
+ * 执行器尚未采样过时(启动瞬间)直接读设备, 保证调用方拿到有效数据
+ */
+SensorSnapshot sensors()
+{
+  SensorSnapshot s;
+  if (!sensor_valid) {
+    sensors_sample(s);
+    return s;
+  }
+  unsigned int seq;
+  do {
+    seq = sensor_seq;
+    __sync_synchronize();
+    s = sensor_state;
+    __sync_synchronize();
+  } while ((seq & 1) || seq != sensor_seq);
+  return s;
+}
+
+/**
+ * @brief 传感器采样(执行器每个节拍最先调用)
+ */
+void sensor_job(float dt)
+{
+  SensorSnapshot s;
+  sensors_sample(s);
+  sensor_seq++;
+  __sync_synchronize();
+  sensor_state = s;
+  __sync_synchronize();
+  sensor_seq++;
+  sensor_valid = true;
+}
+
+bool sensors_started = control_register(sensor_job); // 先于里程计注册, 每节拍第一个执行
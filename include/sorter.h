@@ -0,0 +1,401 @@
+/**
+ * @file sorter.h
+ * @brief 事件驱动分球: 颜色传感器接近回调 + 高频色相判色 + 按实测球速定时反转
+ *
+ * 1. Color_2(下)/Color(上) 的 objectDetected/objectLost 回调只往事件环里写时间戳,
+ *    分球线程每 5ms 取出事件, 不再每 10ms 轮询 color()/isNearObject()
+ * 2. 只有传感器前有物体时才读色(ball_color.h 分类), 连续 SORT_HUE_VOTES 次同色即定色;
+ *    球挨着球时接近检测不断开, 按推算位置和颜色变化拆分成多个球(后一个球按紧贴前一个球,
+ *    即相隔一个球径 2*SORT_DETECT_MM 推算; 实际间距更大时推算偏后, 靠上传感器事件校正)
+ * 3. 通道内最多同时跟踪 SORT_MAX_BALLS 个球, 每个球按 Intake_1/Ball_1 转速积分推算位置,
+ *    上一个球在反转时下一个球照样判色、排队, 不会再有 80ms 的"看不见"窗口
+ * 4. 对方球越过分球口 SORT_GRIP_MM 后才反转 Ball_1, 推算退回分球口后立即恢复正转;
+ *    反转时长由实测球速决定, 球速(毫米/转速)由球经过上下两个传感器的时间在线校正
+ * 5. 吐球口 Color_3 按快照读数给送出的球判色计数(己方/对方), 对方球漏过分球口时在这里能看到
+ *
+ * 通道坐标: 以 Color_2 为 0, 沿进球方向为正(mm)。几何尺寸按实物测量修改。
+ * Alliance: 0-手动(不分球), 1-红方(排蓝球), -1-蓝方(排红球)。
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 参数
+///////////////////////////////////////////////////////////////////////////////
+const int SORT_PERIOD_MS = 5;           // 分球线程周期
+const int SORT_MAX_BALLS = 6;           // 同时跟踪的球数上限
+const float SORT_UP_MM = 80;            // Color_2 -> Color 距离
+const float SORT_GATE_MM = 50;          // Color_2 -> 分球口距离
+const float SORT_DETECT_MM = 25;        // 接近检测触发时球心离传感器的距离
+const float SORT_GRIP_MM = 5;          // 对方球越过分球口多少后开始反转(确保被 Ball_1 夹住)
+const float SORT_MARGIN_MM = 5;         // 推算退过分球口多少后停止反转
+const float SORT_END_MM = 140;          // 己方球超过此位置即离开分球区, 不再跟踪
+const float SORT_MATCH_MM = 40;         // 上传感器事件与跟踪球的匹配容差
+const int SORT_REVERSE_MAX_MS = 250;    // 单次反转上限(推算失效时的保护)
+const float SORT_MM_PER_RPM = 0.5;      // 球速(mm/s)/滚轮转速(rpm)初值, 运行中在线校正
+const int SORT_HUE_VOTES = 3;           // 连续同色读数次数
+
+///////////////////////////////////////////////////////////////////////////////
+// 回调事件环(回调线程写, 分球线程读)
+///////////////////////////////////////////////////////////////////////////////
+struct SortEvent {
+    unsigned char sensor;   // 0: Color_2(下), 1: Color(上)
+    bool detected;          // true: 接近, false: 离开
+    uint64_t time_us;       // 事件时刻(微秒, clock.h)
+};
+
+const int SORT_EVENT_SIZE = 16;
+SortEvent sort_events[SORT_EVENT_SIZE];
+volatile unsigned int sort_event_head = 0;   // 回调写入位置
+unsigned int sort_event_tail = 0;            // 分球线程读取位置
+
+void sort_push_event(unsigned char sensor, bool detected)
+{
+  unsigned int head = sort_event_head;
+  if (head - sort_event_tail >= SORT_EVENT_SIZE) return; // 满了丢弃(正常不会发生)
+  SortEvent &e = sort_events[head % SORT_EVENT_SIZE];
+  e.sensor = sensor;
+  e.detected = detected;
+  e.time_us = clock_us();
+  __sync_synchronize();
+  sort_event_head = head + 1;
+}
+
+void sort_low_detected() { sort_push_event(0, true); }
+void sort_low_lost()     { sort_push_event(0, false); }
+void sort_up_detected()  { sort_push_event(1, true); }
+void sort_up_lost()      { sort_push_event(1, false); }
+
+///////////////////////////////////////////////////////////////////////////////
+// 跟踪状态
+///////////////////////////////////////////////////////////////////////////////
+struct SortBall {
+    bool used;
+    float pos;            // 推算位置(mm)
+    int color;            // 1 红, -1 蓝, 0 未定
+    int red_votes;
+    int blue_votes;
+    bool eject;           // 需要排出
+    bool seen_up;         // 已经过上传感器
+    bool gripped;         // 已越过分球口被 Ball_1 夹住
+    uint64_t t_low_us;    // 下传感器检测时刻(微秒), 0 表示未经过
+    float rev_sum;        // 检测后滚轮转过的圈数积分(rpm*s), 用于校正球速
+};
+
+SortBall sort_balls[SORT_MAX_BALLS];
+bool sort_near_low = false, sort_near_up = false;
+int sort_low_ball = -1, sort_up_ball = -1;   // 正在传感器前的球
+int sort_low_change = 0;                     // 下传感器前已定色的球后连续读到异色的次数
+float sort_mm_per_rpm = SORT_MM_PER_RPM;
+bool sort_reversing = false;
+uint64_t sort_reverse_start_us = 0;
+
+// 统计(test_sorter 输出)
+int sort_seen = 0, sort_ejects = 0, sort_reverses = 0;
+int sort_out_own = 0, sort_out_opp = 0;   // 吐球口判色计数
+float sort_last_speed = 0;        // 最近一次上下传感器实测球速(mm/s)
+float sort_reverse_ms_sum = 0;
+
+int sort_new_ball(float pos)
+{
+  for (int i = 0; i < SORT_MAX_BALLS; i++) {
+    if (sort_balls[i].used) continue;
+    SortBall &b = sort_balls[i];
+    b.used = true;
+    b.pos = pos;
+    b.color = 0;
+    b.red_votes = b.blue_votes = 0;
+    b.eject = false;
+    b.seen_up = false;
+    b.gripped = false;
+    b.t_low_us = 0;
+    b.rev_sum = 0;
+    sort_seen++;
+    return i;
+  }
+  return -1;
+}
+
+// 定色后决定去留
+void sort_decide(SortBall &b)
+{
+  b.eject = Alliance != 0 && b.color != Alliance;
+}
+
+// 找推算位置最接近 expect 的跟踪球(容差 SORT_MATCH_MM), 没有返回 -1
+int sort_match(float expect)
+{
+  int best = -1;
+  for (int i = 0; i < SORT_MAX_BALLS; i++) {
+    SortBall &b = sort_balls[i];
+    if (!b.used || fabs(b.pos - expect) > SORT_MATCH_MM) continue;
+    if (best < 0 || fabs(b.pos - expect) < fabs(sort_balls[best].pos - expect)) best = i;
+  }
+  return best;
+}
+
+// 一次分类结果计入该球的投票, 连续 SORT_HUE_VOTES 次同色即定色
+void sort_vote(SortBall &b, int c)
+{
+  if (b.color != 0) return;
+  if (c > 0) { b.red_votes++; b.blue_votes = 0; }
+  else if (c < 0) { b.blue_votes++; b.red_votes = 0; }
+  if (b.red_votes >= SORT_HUE_VOTES) b.color = 1;
+  if (b.blue_votes >= SORT_HUE_VOTES) b.color = -1;
+  if (b.color != 0) sort_decide(b);
+}
+
+/**
+ * @brief 下传感器前有物体时每周期读一次色相
+ * 球挨着球进来时接近检测不会断开(没有新的 objectDetected), 所以当前球推算已移出
+ * 检测窗, 或连续读到与当前球不同的颜色, 都视为下一个球到达
+ */
+void sort_watch_low()
+{
+  if (!sort_near_low) return;
+  int c = ball_classify(BALL_LOW, optical_read(Color_2));
+  SortBall *b = sort_low_ball >= 0 ? &sort_balls[sort_low_ball] : 0;
+  bool next = !b || b->pos > SORT_DETECT_MM;
+  if (b && b->color != 0) {
+    if (c != 0 && c != b->color) sort_low_change++;
+    else if (c == b->color) sort_low_change = 0;
+    if (sort_low_change >= SORT_HUE_VOTES) next = true;
+  }
+  if (next) {
+    float pos = b ? b->pos - 2 * SORT_DETECT_MM : -SORT_DETECT_MM;
+    sort_low_ball = sort_new_ball(pos > -SORT_DETECT_MM ? pos : -SORT_DETECT_MM);
+    sort_low_change = 0;
+    if (sort_low_ball < 0) return;
+    b = &sort_balls[sort_low_ball];
+  }
+  sort_vote(*b, c);
+}
+
+/**
+ * @brief 上传感器前有物体时, 按推算位置找到窗口内的球, 下传感器没定色的由这里补判
+ */
+void sort_watch_up()
+{
+  if (!sort_near_up) return;
+  SortBall *b = sort_up_ball >= 0 ? &sort_balls[sort_up_ball] : 0;
+  if (!b || fabs(b->pos - SORT_UP_MM) > SORT_DETECT_MM) {
+    sort_up_ball = sort_match(SORT_UP_MM);
+    if (sort_up_ball < 0) return;
+    b = &sort_balls[sort_up_ball];
+  }
+  if (b->color == 0) sort_vote(*b, ball_classify(BALL_UP, optical_read(Color)));
+}
+
+// 吐球口计数状态
+bool sort_near_out = false;
+int sort_out_votes = 0;       // 当前球的判色累计(红 +1, 蓝 -1)
+float sort_out_travel = 0;    // 接近期间 Ball_1 带球向前走过的距离(mm)
+
+// 结算吐球口前的一个球
+void sort_out_count()
+{
+  int c = sort_out_votes > 0 ? 1 : sort_out_votes < 0 ? -1 : 0;
+  if (c != 0) {
+    if (Alliance == 0 || c == Alliance) sort_out_own++;
+    else sort_out_opp++;
+  }
+  sort_out_votes = 0;
+}
+
+/**
+ * @brief 吐球口读数(快照)判色计数
+ * 球挨着球时接近检测不断开, 每向前走过一个球径(2*SORT_DETECT_MM)结算一个球;
+ * 接近断开时正在向前、走过超过半个球径的也算一个。分球反转会把球带回来, 走过的距离按方向加减
+ */
+void sort_watch_out(const OpticalReading &r, float v_up, float dt)
+{
+  if (r.near) {
+    sort_out_votes += ball_classify(BALL_OUT, r);
+    sort_out_travel += v_up * dt;
+    if (sort_out_travel >= 2 * SORT_DETECT_MM) {
+      sort_out_travel -= 2 * SORT_DETECT_MM;
+      sort_out_count();
+    }
+  } else if (sort_near_out) {
+    if (v_up > 0 && sort_out_travel >= SORT_DETECT_MM) sort_out_count();
+    sort_out_travel = 0;
+    sort_out_votes = 0;
+  }
+  sort_near_out = r.near;
+}
+
+// 处理一个接近事件; 球可能正被反转带着倒退, 所以触发位置按当前滚轮方向取传感器前或后
+void sort_handle_event(const SortEvent &e, uint64_t now_us, float v_low, float v_up)
+{
+  float age = now_us > e.time_us ? (now_us - e.time_us) / 1e6f : 0;
+  if (e.sensor == 0) {
+    sort_near_low = e.detected;
+    sort_low_ball = -1;
+    sort_low_change = 0;
+    if (!e.detected) return;
+    trace_instant("ball_low");
+    float expect = v_low >= 0 ? -SORT_DETECT_MM : SORT_DETECT_MM;
+    int i = sort_match(expect);
+    if (i < 0) {
+      i = sort_new_ball(expect);
+      if (i < 0) return;
+      sort_balls[i].t_low_us = e.time_us;
+    }
+    sort_balls[i].pos = expect + v_low * age;
+    sort_low_ball = i;
+    return;
+  }
+  sort_near_up = e.detected;
+  sort_up_ball = -1;
+  if (!e.detected) return;
+  trace_instant("ball_up");
+
+  // 与最接近的跟踪球匹配, 没有则视为下传感器漏检的新球
+  float expect = v_up >= 0 ? SORT_UP_MM - SORT_DETECT_MM : SORT_UP_MM + SORT_DETECT_MM;
+  int i = sort_match(expect);
+  if (i < 0) i = sort_new_ball(expect);
+  if (i < 0) return;
+  SortBall &b = sort_balls[i];
+  b.pos = expect + v_up * age;
+  if (b.seen_up) return;
+  b.seen_up = true;
+  // 上下传感器之间的实测球速校正毫米/转速系数
+  if (b.t_low_us && e.time_us > b.t_low_us && b.rev_sum > 1) {
+    sort_last_speed = SORT_UP_MM / ((e.time_us - b.t_low_us) / 1e6f);
+    float k = SORT_UP_MM / b.rev_sum;
+    if (k > SORT_MM_PER_RPM * 0.5 && k < SORT_MM_PER_RPM * 2)
+      sort_mm_per_rpm += 0.3 * (k - sort_mm_per_rpm);
+  }
+  // 下传感器没来得及定色的球由上传感器补判
+  sort_up_ball = i;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 分球线程
+///////////////////////////////////////////////////////////////////////////////
+
+/**颜色识别自动控制线程函数
+ * 根据联盟颜色和传感器事件自动控制吸球和分球
+ */
+void Color_Control(){
+  Color_2.integrationTime(SORT_PERIOD_MS);  // 缩短积分时间, 色相读数跟得上分球周期
+  Color.integrationTime(SORT_PERIOD_MS);
+  Color_2.objectDetected(sort_low_detected);
+  Color_2.objectLost(sort_low_lost);
+  Color.objectDetected(sort_up_detected);
+  Color.objectLost(sort_up_lost);
+  trace_thread("colour");
+
+  uint64_t last_us = clock_us();
+  while(true){
+    float dt = clock_dt(last_us);   // 微秒时钟, 5ms 周期下不再有 1ms 的量化误差
+    uint64_t now_us = last_us;
+
+    // 1. 按滚轮转速推进每个球的位置(分球口前由吸球电机带动, 之后由 Ball_1 带动)
+    SensorSnapshot snap = sensors();
+    float v_low = snap.intake.velocity * sort_mm_per_rpm;
+    float v_up = snap.ball.velocity * sort_mm_per_rpm;
+    for (int i = 0; i < SORT_MAX_BALLS; i++) {
+      SortBall &b = sort_balls[i];
+      if (!b.used) continue;
+      // 正在排出的球由 Ball_1 一直推出分球口
+      bool roller = b.pos >= SORT_GATE_MM || (b.eject && b.gripped);
+      float rpm = roller ? snap.ball.velocity : snap.intake.velocity;
+      b.pos += rpm * sort_mm_per_rpm * dt;
+      if (!b.seen_up) b.rev_sum += rpm * dt;
+    }
+
+    // 2. 取出回调事件
+    while (sort_event_tail != sort_event_head) {
+      __sync_synchronize();
+      SortEvent e = sort_events[sort_event_tail % SORT_EVENT_SIZE];
+      sort_event_tail++;
+      sort_handle_event(e, now_us, v_low, v_up);
+    }
+
+    // 3. 传感器前有物体才读色相; 吐球口计数
+    sort_watch_low();
+    sort_watch_up();
+    sort_watch_out(snap.color_out, v_up, dt);
+
+    // 4. 反转判断: 有对方球越过分球口 SORT_GRIP_MM 即开始, 全部退过分球口后结束
+    bool want_reverse = false;
+    for (int i = 0; i < SORT_MAX_BALLS; i++) {
+      SortBall &b = sort_balls[i];
+      if (!b.used) continue;
+      if (b.pos > SORT_GATE_MM + SORT_GRIP_MM) b.gripped = true;
+      if (b.eject && b.gripped && sort_reversing && b.pos < SORT_GATE_MM - SORT_MARGIN_MM) {
+        b.used = false;          // 已退出分球口
+        sort_ejects++;
+        if (sort_low_ball == i) sort_low_ball = -1;
+        if (sort_up_ball == i) sort_up_ball = -1;
+        continue;
+      }
+      if (b.eject && b.gripped) want_reverse = true;
+      // 离开分球区(送出或被吐出进球口)的球不再跟踪
+      if (b.pos > SORT_END_MM || b.pos < -2 * SORT_DETECT_MM - SORT_MARGIN_MM) {
+        b.used = false;
+        if (sort_low_ball == i) sort_low_ball = -1;
+        if (sort_up_ball == i) sort_up_ball = -1;
+      }
+    }
+    if (!(auto_color_ctrl == 1 && Alliance != 0)) want_reverse = false;
+    if (want_reverse && sort_reversing && now_us - sort_reverse_start_us > (uint64_t)SORT_REVERSE_MAX_MS * 1000) {
+      // 推算失效保护: 放弃仍在反转的球
+      for (int i = 0; i < SORT_MAX_BALLS; i++) if (sort_balls[i].eject) sort_balls[i].used = false;
+      sort_low_ball = sort_up_ball = -1;
+      want_reverse = false;
+    }
+    if (want_reverse && !sort_reversing) {
+      sort_reverse_start_us = now_us;
+      trace_begin("sort_reverse");
+    }
+    if (!want_reverse && sort_reversing) {
+      sort_reverse_ms_sum += (now_us - sort_reverse_start_us) / 1000.0f;
+      sort_reverses++;
+      trace_end("sort_reverse");
+    }
+    sort_reversing = want_reverse;
+
+    // 5. 输出
+    if(auto_color_ctrl==1){ //自动颜色控制开启
+      if (Alliance==0){ //手动模式:不判断颜色,直接吸球
+        auto_color_divide=0;
+        Intake(100);
+        Ball(100);
+      }
+      else if(sort_reversing){ //对方球在分球口: 反转排出
+        auto_color_divide=1;
+        Ball(-80);
+        Intake(20);  //降低吸球速度
+      }
+      else{
+        auto_color_divide=0;
+        Ball(100);
+        // 沿用原逻辑: 红方在传感器前无球时吸球降到 80
+        Intake(Alliance==1 && !sort_near_low && !sort_near_up ? 80 : 100);
+      }
+    } else {
+      auto_color_divide=0;
+    }
+
+    task_wait("colour", SORT_PERIOD_MS);
+  }
+}
+thread ColorThread=thread(Color_Control); //创建颜色控制线程
+
+/**
+ * @brief 分球测试: 原地吸球 10 秒, 输出分球线程自身的统计
+ * sorter_robot: seen=跟踪球数 ejects=排出球数 speed=实测球速(mm/s)
+ *               mm_per_rpm=校正后的系数 reverse_ms=平均单次反转时长
+ *               out_own/out_opp=吐球口判色计数(本次测试)
+ */
+void test_sorter()
+{
+  sort_out_own = sort_out_opp = 0;
+  Get_Ball(2);
+  wait(10000, msec);
+  Get_Ball(0);
+  wait(1000, msec);
+  printf("sorter_robot: seen=%d ejects=%d speed=%.0f mm_per_rpm=%.3f reverse_ms=%.0f out_own=%d out_opp=%d\n",
+         sort_seen, sort_ejects, sort_last_speed, sort_mm_per_rpm,
+         sort_reverses ? sort_reverse_ms_sum / sort_reverses : 0.0, sort_out_own, sort_out_opp);
+}
@@ -0,0 +1,199 @@
+/**
+ * @file taskprof.h
+ * @brief 任务/线程剖析: 每个任务的运行时间、唤醒延迟和循环周期分布, 串口随时查询
+ *
+ * 1. 周期循环把末尾的 wait(N, msec) 换成 task_wait("名字", N):
+ *    - 运行时间: 上次醒来到这次睡下的时间(任务之间协作调度, 即本任务占用的时间;
+ *      循环里调用了会睡眠的函数时这段也计入)
+ *    - 唤醒延迟: 实际睡了多久减去要求的时长, 有任务不让出 CPU 时这里先变大
+ *    - 循环周期: 相邻两次醒来的间隔, 按 <1/<2/<5/<10/<20/<50/<100/>=100 毫秒分桶
+ * 2. 不睡眠的忙等循环在循环体里调用 task_spin("名字"): 两次调用之间的时间全部记为运行时间,
+ *    周期分布即每圈耗时。超过 TASKPROF_SPIN_GAP_US 没调用视为重新进入, 中间的时间不计
+ * 3. 按 名字 + 线程号 分槽, 同名的两个线程(如重复创建的线程)分开统计
+ * 4. 执行器等自己管理睡眠的任务用 task_prof_sleep()/task_prof_wake() 包住那次睡眠
+ * 5. 查询: 串口输入一行 !P 输出报表, !R 清零(log_link.h 在没有传输时处理), 也可直接调用
+ *    task_prof_report() / task_prof_reset()
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 参数
+///////////////////////////////////////////////////////////////////////////////
+const int TASKPROF_MAX = 32;                    // 最多统计的任务槽
+const int TASKPROF_BINS = 8;                    // 周期分布桶数
+const unsigned int TASKPROF_EDGES_US[TASKPROF_BINS - 1] = {1000, 2000, 5000, 10000, 20000, 50000, 100000};
+const unsigned int TASKPROF_SPIN_GAP_US = 50000; // 忙等循环两次调用间隔超过此值视为重新进入
+
+struct TaskProf {
+    const char *name;
+    int task;                       // this_thread::get_id()
+    bool spin;                      // 忙等循环(task_spin)
+    bool asleep;                    // 在 task_prof_sleep 与 task_prof_wake 之间
+    unsigned int loops;             // 醒来(或忙等转圈)次数
+    uint64_t first_us;              // 第一次统计的时刻
+    uint64_t wake_us;               // 上次醒来(忙等: 上次调用)的时刻, 0 表示还没有
+    uint64_t sleep_us;              // 本次睡下的时刻
+    unsigned int planned_us;        // 本次要求睡的时长
+    uint64_t run_us;                // 运行时间合计
+    unsigned int max_run_us;        // 单圈最长运行时间
+    uint64_t late_sum_us;           // 唤醒延迟合计
+    unsigned int late_max_us;
+    unsigned int wakes;             // 计入唤醒延迟的次数
+    unsigned int hist[TASKPROF_BINS];
+};
+
+TaskProf task_profs[TASKPROF_MAX];
+int task_profs_n = 0;
+unsigned int task_prof_full = 0;    // 槽位用完而没能统计的调用次数
+uint64_t task_prof_since = 0;       // 上次清零的时刻
+
+///////////////////////////////////////////////////////////////////////////////
+// 记录
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief 取当前线程名为 name 的槽位, 没有则新建; 槽位用完返回 0
+ */
+TaskProf *task_prof(const char *name, bool spin = false)
+{
+  int task = this_thread::get_id();
+  for (int i = 0; i < task_profs_n; i++) {
+    TaskProf &p = task_profs[i];
+    if (p.task == task && (p.name == name || !strcmp(p.name, name))) return &p;
+  }
+  if (task_profs_n >= TASKPROF_MAX) {
+    task_prof_full++;
+    return 0;
+  }
+  TaskProf &p = task_profs[task_profs_n++];
+  memset(&p, 0, sizeof(p));
+  p.name = name;
+  p.task = task;
+  p.spin = spin;
+  return &p;
+}
+
+void task_prof_period(TaskProf &p, unsigned int period_us)
+{
+  int b = 0;
+  while (b < TASKPROF_BINS - 1 && period_us >= TASKPROF_EDGES_US[b]) b++;
+  p.hist[b]++;
+}
+
+void task_prof_run(TaskProf &p, unsigned int run_us)
+{
+  p.run_us += run_us;
+  if (run_us > p.max_run_us) p.max_run_us = run_us;
+}
+
+/**
+ * @brief 任务即将睡眠 planned_ms 毫秒
+ */
+void task_prof_sleep(TaskProf *p, unsigned int planned_ms)
+{
+  if (!p) return;
+  uint64_t now = clock_us();
+  if (!p->first_us) p->first_us = now;
+  if (p->wake_us) task_prof_run(*p, now - p->wake_us);
+  p->sleep_us = now;
+  p->planned_us = planned_ms * 1000;
+  p->asleep = true;
+}
+
+/**
+ * @brief 任务醒来
+ */
+void task_prof_wake(TaskProf *p)
+{
+  if (!p) return;
+  uint64_t now = clock_us();
+  if (p->asleep) {
+    unsigned int slept = now - p->sleep_us;
+    unsigned int late = slept > p->planned_us ? slept - p->planned_us : 0;
+    p->late_sum_us += late;
+    if (late > p->late_max_us) p->late_max_us = late;
+    p->wakes++;
+    p->asleep = false;
+  }
+  if (p->wake_us) task_prof_period(*p, now - p->wake_us);
+  p->wake_us = now;
+  p->loops++;
+}
+
+/**
+ * @brief 周期循环末尾的等待, 代替 wait(ms, msec)
+ */
+void task_wait(const char *name, int ms)
+{
+  TaskProf *p = task_prof(name);
+  task_prof_sleep(p, ms);
+  task::sleep(ms);
+  task_prof_wake(p);
+}
+
+/**
+ * @brief 忙等循环每圈调用一次(不睡眠)
+ */
+void task_spin(const char *name)
+{
+  TaskProf *p = task_prof(name, true);
+  if (!p) return;
+  uint64_t now = clock_us();
+  if (!p->first_us) p->first_us = now;
+  if (p->wake_us && now - p->wake_us < TASKPROF_SPIN_GAP_US) {
+    task_prof_run(*p, now - p->wake_us);
+    task_prof_period(*p, now - p->wake_us);
+  }
+  p->wake_us = now;
+  p->loops++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 报表
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief 清零全部统计(槽位保留)
+ */
+void task_prof_reset()
+{
+  for (int i = 0; i < task_profs_n; i++) {
+    TaskProf &p = task_profs[i];
+    p.loops = p.wakes = p.max_run_us = p.late_max_us = 0;
+    p.run_us = p.late_sum_us = 0;
+    p.first_us = 0;
+    p.wake_us = 0;
+    p.asleep = false;
+    memset(p.hist, 0, sizeof(p.hist));
+  }
+  task_prof_full = 0;
+  task_prof_since = clock_us();
+}
+
+/**
+ * @brief 串口输出报表, 每个任务一行(忙等循环名字后加 *)
+ * taskprof: window=秒 tasks= full=
+ * taskprof: 名字 id loops run_ms run% max_run_ms late_avg_ms late_max_ms | <1 <2 <5 <10 <20 <50 <100 >=100
+ * run% 按该任务第一次统计到现在的时间计算
+ */
+void task_prof_report()
+{
+  uint64_t now = clock_us();
+  printf("taskprof: window=%.2fs tasks=%d full=%u\n", (now - task_prof_since) / 1e6, task_profs_n, task_prof_full);
+  printf("taskprof: %-16s %3s %7s %8s %5s %7s %8s %8s | %5s %5s %5s %5s %5s %5s %5s %5s\n",
+         "task", "id", "loops", "run_ms", "run%", "max_run", "late_avg", "late_max",
+         "<1", "<2", "<5", "<10", "<20", "<50", "<100", ">=100");
+  for (int i = 0; i < task_profs_n; i++) {
+    const TaskProf &p = task_profs[i];
+    if (!p.loops) continue;
+    char name[20];
+    snprintf(name, sizeof(name), "%s%s", p.name, p.spin ? "*" : "");
+    uint64_t window = now - p.first_us;
+    float share = window ? 100.0 * p.run_us / window : 0;
+    printf("taskprof: %-16s %3d %7u %8.1f %5.1f %7.2f ", name, p.task, p.loops,
+           p.run_us / 1000.0, share, p.max_run_us / 1000.0);
+    if (p.wakes) printf("%8.2f %8.2f |", p.late_sum_us / 1000.0 / p.wakes, p.late_max_us / 1000.0);
+    else printf("%8s %8s |", "-", "-");
+    for (int b = 0; b < TASKPROF_BINS; b++) printf(" %5u", p.hist[b]);
+    printf("\n");
+  }
+}
@@ -0,0 +1,210 @@
+/**
+ * @file trace.h
+ * @brief 跨任务时间线追踪: 开始/结束区间与瞬时事件写进固定内存缓冲, 上位机导出为 Chrome trace
+ *
+ * 1. 每个事件记录微秒时间戳(clock.h)、所在线程号、类型、名字和一个整数参数,
+ *    一条 16 字节, 缓冲满了不再记录(计入 trace_dropped), 不影响运动
+ * 2. 区间: 在函数开头放一个 TraceSpan 对象, 函数返回时自动记结束;
+ *    也可以 trace_begin()/trace_end() 成对调用(如分球反转这类跨循环的区间)
+ * 3. 名字必须是字符串常量(只存指针), 输出时按指针去重成名字表
+ * 4. 线程名用 trace_thread() 登记(任何时候都可以, 不占事件缓冲), 时间线上按名字显示
+ * 5. AutoPro() 开头 trace_start(), 结束 trace_stop(); trace_dump() 经 log_link.h 输出:
+ *    trace_v1 行, 'N' 名字帧 + 'T' 线程帧 + 'E' 事件帧(帧格式同 log_codec.h), 结束行。
+ *    上位机 trace_export.py 转成 trace_event JSON, 用 chrome://tracing 或 Perfetto 打开
+ *
+ * 事件帧载荷: [首事件序号 varint][事件数 1B] 每个事件:
+ *   [与上一事件的时间差 us varint(帧内第一个为绝对值)][线程号 varint][类型 1B][名字号 varint][参数 zigzag]
+ * 名字帧载荷: [名字数 1B] 每个 [名字号 varint][名字: 长度 1B + 字符]
+ * 线程帧载荷: [线程数 1B] 每个 [线程号 varint][名字号 varint]
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 参数
+///////////////////////////////////////////////////////////////////////////////
+const int TRACE_MAX = 4096;          // 事件缓冲容量(64KB)
+const int TRACE_NAMES_MAX = 128;     // 输出时名字表容量
+const int TRACE_THREADS_MAX = 16;    // 可命名的线程数
+const int TRACE_FRAME_EVENTS = 32;   // 每个事件帧最多事件数
+
+enum TracePhase { TRACE_BEGIN = 'B', TRACE_END = 'E', TRACE_INSTANT = 'i' };
+
+struct TraceEvent {
+    unsigned int ts_us;     // 相对 trace_start() 的微秒数
+    const char *name;
+    short task;             // this_thread::get_id()
+    char phase;             // TracePhase
+    int arg;
+};
+
+TraceEvent trace_buf[TRACE_MAX];
+int trace_count = 0;
+unsigned int trace_dropped = 0;
+bool trace_on = false;
+uint64_t trace_t0 = 0;
+
+struct TraceThread {
+    int task;
+    const char *name;
+};
+TraceThread trace_threads[TRACE_THREADS_MAX];
+int trace_threads_n = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+// 记录
+///////////////////////////////////////////////////////////////////////////////
+
+// 任务之间协作调度, 先取时间再占位, 占位到写完之间不会切换任务, 不需要加锁
+void trace_event(char phase, const char *name, int arg = 0)
+{
+  if (!trace_on) return;
+  unsigned int ts = (unsigned int)(clock_us() - trace_t0);
+  if (trace_count >= TRACE_MAX) {
+    trace_dropped++;
+    return;
+  }
+  TraceEvent &e = trace_buf[trace_count++];
+  e.ts_us = ts;
+  e.name = name;
+  e.task = this_thread::get_id();
+  e.phase = phase;
+  e.arg = arg;
+}
+
+void trace_begin(const char *name, int arg = 0) { trace_event(TRACE_BEGIN, name, arg); }
+void trace_end(const char *name) { trace_event(TRACE_END, name); }
+void trace_instant(const char *name, int arg = 0) { trace_event(TRACE_INSTANT, name, arg); }
+
+// 给当前线程起名(显示在时间线左侧), 同一线程再次登记则改名
+void trace_thread(const char *name)
+{
+  int task = this_thread::get_id();
+  for (int i = 0; i < trace_threads_n; i++)
+    if (trace_threads[i].task == task) {
+      trace_threads[i].name = name;
+      return;
+    }
+  if (trace_threads_n >= TRACE_THREADS_MAX) return;
+  trace_threads[trace_threads_n].task = task;
+  trace_threads[trace_threads_n].name = name;
+  trace_threads_n++;
+}
+
+/**
+ * @brief 作用域区间: 构造时记开始, 析构时记结束
+ *   void Run_gyro(...) { TraceSpan span("Run_gyro", enc); ... }
+ */
+struct TraceSpan {
+    const char *name;
+    TraceSpan(const char *name, int arg = 0) : name(name) { trace_begin(name, arg); }
+    ~TraceSpan() { trace_end(name); }
+};
+
+/**
+ * @brief 清空缓冲并开始记录, 当前线程记为 name
+ */
+void trace_start(const char *name = "auto")
+{
+  trace_count = 0;
+  trace_dropped = 0;
+  trace_t0 = clock_us();
+  trace_on = true;
+  trace_thread(name);
+}
+
+void trace_stop()
+{
+  trace_on = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 输出
+///////////////////////////////////////////////////////////////////////////////
+const char *trace_names[TRACE_NAMES_MAX];
+int trace_names_n = 0;
+
+int trace_name_id(const char *name)
+{
+  for (int i = 0; i < trace_names_n; i++)
+    if (trace_names[i] == name || !strcmp(trace_names[i], name)) return i;
+  if (trace_names_n >= TRACE_NAMES_MAX) return TRACE_NAMES_MAX - 1;
+  trace_names[trace_names_n] = name;
+  return trace_names_n++;
+}
+
+/**
+ * @brief 输出全部事件(跑完后调用)
+ * trace_v1 / 名字帧 / 事件帧 / --- trace end (events N, dropped D, frames F, link acked|paced) ---
+ */
+void trace_dump()
+{
+  bool was_on = trace_on;
+  trace_on = false;
+  vex::task::sleep(100);
+  printf("trace_v1\n");
+  unsigned int seq = 0, frames = 0;
+  LogFrame f;
+  link_begin();
+
+  // 名字表: 先按出现顺序编号, 再分帧输出
+  trace_names_n = 0;
+  for (int i = 0; i < trace_threads_n; i++) trace_name_id(trace_threads[i].name);
+  for (int i = 0; i < trace_count; i++) trace_name_id(trace_buf[i].name);
+  for (int i = 0; i < trace_names_n;) {
+    log_frame_begin(f, 'N', seq++);
+    int count_at = f.len;
+    log_put_u8(f, 0);
+    int n = 0;
+    while (i < trace_names_n && n < 255 && f.len + 2 + 5 + 255 + 2 <= LOG_FRAME_BYTES) {
+      log_put_varint(f, i);
+      log_put_string(f, trace_names[i]);
+      i++;
+      n++;
+    }
+    f.buf[count_at] = n;
+    log_frame_end(f);
+    link_send(f);
+    frames++;
+  }
+
+  log_frame_begin(f, 'T', seq++);
+  log_put_u8(f, trace_threads_n);
+  for (int i = 0; i < trace_threads_n; i++) {
+    log_put_varint(f, trace_threads[i].task < 0 ? 0 : trace_threads[i].task);
+    log_put_varint(f, trace_name_id(trace_threads[i].name));
+  }
+  log_frame_end(f);
+  link_send(f);
+  frames++;
+
+  // 事件: 帧内第一个事件存绝对时间, 之后存时间差
+  for (int i = 0; i < trace_count;) {
+    log_frame_begin(f, 'E', seq++);
+    log_put_varint(f, i);
+    int count_at = f.len;
+    log_put_u8(f, 0);
+    int n = 0;
+    unsigned int prev = 0;
+    while (i < trace_count && n < TRACE_FRAME_EVENTS && f.len + 20 + 2 <= LOG_FRAME_BYTES) {
+      const TraceEvent &e = trace_buf[i];
+      log_put_varint(f, n == 0 ? e.ts_us : e.ts_us - prev);
+      log_put_varint(f, e.task < 0 ? 0 : e.task);
+      log_put_u8(f, e.phase);
+      log_put_varint(f, trace_name_id(e.name));
+      log_put_svarint(f, e.arg);
+      prev = e.ts_us;
+      i++;
+      n++;
+    }
+    f.buf[count_at] = n;
+    log_frame_end(f);
+    link_send(f);
+    frames++;
+  }
+  bool acked = link_end();
+
+  vex::task::sleep(100);
+  printf("--- trace end (events %d, dropped %u, frames %u, link %s) ---\n",
+         trace_count, trace_dropped, frames, acked ? "acked" : "paced");
+  vex::task::sleep(200);
+  trace_on = was_on;
+}
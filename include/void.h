@@ -18,13 +18,39 @@
  */
 
 #include <thread>
+#include "clock.h"
+#include "taskprof.h"
+#include "executor.h"
+#include "motion.h"
+#include "profile.h"
+#include "motor_group.h"
+#include "sensors.h"
+#include "odom.h"
+#include "feedforward.h"
+#include "log_codec.h"
+#include "log_link.h"
+#include "trace.h"
 
 float reduce_negative_180_to_180(float angle);
 
+// 异常窗口抓取(capture.h): 运动函数遇到超时/撞墙堵转时调用, 冻结触发前后的样本
+enum CaptureReason {
+    CAPTURE_MANUAL = 0,       // 程序里手动触发
+    CAPTURE_JAR_TIMEOUT = 1,  // JAR_PID 因超时退出(value = 剩余误差)
+    CAPTURE_WALL_STALL = 2,   // Wall_Stop 检测到堵转(value = 转速 rpm)
+    CAPTURE_HEADING = 3,      // run_gyro_JAR 航向误差超限(value = 航向误差, 度)
+    CAPTURE_WATCHDOG = 4      // 看门狗结束了运动(value = 已执行秒数)
+};
+void capture_trigger(int reason, float value);
+
+void calibrate_ball_colors();   // 球颜色现场标定(ball_color.h), 选自动界面按手柄 X 进入
+
+#include "watchdog.h"
+#include "motion_result.h"
+
 ///////////////////////////////////////////////////////////////////////////////
 // 全局变量定义
 ///////////////////////////////////////////////////////////////////////////////
-float motor_min_speed = 24; //电机最小驱动功率(自动阶段统一使用)
 
 //int auto_color_ctrl=0;//自动颜色控制
 extern int auto_color_ctrl=0; //自动颜色控制开关: 0-关闭, 1-开启
@@ -46,10 +72,10 @@ int sgn(double d)
 }
 /**
  * @brief 电机控制函数(电压控制模式)
- * @param motor_name 电机对象
+ * @param motor_name 电机对象(引用, 不拷贝)
  * @param power 功率值(-100到100), 将转换为电压(0.12倍)
  */
-void m(motor motor_name,int power)
+void m(motor &motor_name,int power)
 {
   motor_name.spin(fwd, 0.12*power, voltageUnits::volt);
   // motor_name.setMaxTorque(power,percentUnits::pct);
@@ -58,11 +84,11 @@ void m(motor motor_name,int power)
 
 /**
  * @brief 电机控制函数(速度控制模式)
- * @param motor_name 电机对象
+ * @param motor_name 电机对象(引用, 不拷贝)
  * @param power 扭矩百分比(0-100)
  * @param speed 速度百分比(-100到100)
  */
-void motorctrl(motor motor_name,int power,int speed)
+void motorctrl(motor &motor_name,int power,int speed)
 {
   motor_name.setMaxTorque(power,percentUnits::pct);
   motor_name.spin(directionType::fwd,speed, velocityUnits::pct);
@@ -73,7 +99,7 @@ void motorctrl(motor motor_name,int power,int speed)
  * @param timers 延时时间(毫秒)
  */
 void wait(int timers)
-{task::sleep(timers);}
+{TraceSpan span("wait", timers); task::sleep(timers);}
 
 ///////////////////////////////////////////////////////////////////////////////
 // 底盘控制函数
@@ -86,12 +112,8 @@ void wait(int timers)
  */
 void Run_Ctrl(int left,int right)
 {
-	m(LeftRun_1,left);
-	m(LeftRun_2,left);
-  m(LeftRun_3,left);
-  m(RightRun_1,right);
-	m(RightRun_2,right);
-  m(RightRun_3,right);
+  drive_left.power(left);
+  drive_right.power(right);
 }
 
 /**
@@ -101,12 +123,8 @@ void Run_Ctrl(int left,int right)
  */
 void Run_V5(int left,int right)
 {
-	motorctrl(LeftRun_1,100,left);
-	motorctrl(LeftRun_2,100,left);
-  motorctrl(LeftRun_3,100,left);
-  motorctrl(RightRun_1,100,right);
-	motorctrl(RightRun_2,100,right);
-  motorctrl(RightRun_3,100,right);
+  drive_left.velocity_pct(100,left);
+  drive_right.velocity_pct(100,right);
 }
 /**
  * @brief 左转控制(仅控制右侧电机)
@@ -114,12 +132,8 @@ void Run_V5(int left,int right)
  */
 void Left_Ctrl(int spd)
 {
-  // LeftRun_1.stop(coast);
-  // LeftRun_2.stop(coast);
-  // LeftRun_3.stop(coast);
-  m(RightRun_1,spd);
-	m(RightRun_2,spd);
-  m(RightRun_3,spd);
+  // drive_left.stop(coast);
+  drive_right.power(spd);
 }
 
 /**
@@ -128,12 +142,8 @@ void Left_Ctrl(int spd)
  */
 void Right_Ctrl(int spd)
 {
-  m(LeftRun_1,spd);
-	m(LeftRun_2,spd);
-  m(LeftRun_3,spd);
-  // RightRun_1.stop(coast);
-  // RightRun_2.stop(coast);
-  // RightRun_3.stop(coast);
+  drive_left.power(spd);
+  // drive_right.stop(coast);
 }
 
 /**
@@ -142,12 +152,8 @@ void Right_Ctrl(int spd)
  */
 void RunStop(brakeType brake_name)
 {
-  LeftRun_1.stop(brake_name);
-  LeftRun_2.stop(brake_name);
-  LeftRun_3.stop(brake_name);
-  RightRun_1.stop(brake_name);
-  RightRun_2.stop(brake_name);
-  RightRun_3.stop(brake_name);
+  drive_left.stop(brake_name);
+  drive_right.stop(brake_name);
 }
 
 /**
@@ -156,12 +162,11 @@ void RunStop(brakeType brake_name)
  */
 void JoyStop()
 {
-  LeftRun_1.stop(coast);
-  LeftRun_2.stop(brake);
-  LeftRun_3.stop(coast);
-  RightRun_1.stop(coast);
-  RightRun_2.stop(brake);
-  RightRun_3.stop(coast);
+  for (int i = 0; i < 3; i++) {
+    brakeType mode = (i == 1) ? brake : coast;
+    drive_left[i].stop(mode);
+    drive_right[i].stop(mode);
+  }
 }
 
 void hold_stop(int time){
@@ -219,6 +224,11 @@ void Run_time(int spd,int time)
 // 机械结构控制函数
 ///////////////////////////////////////////////////////////////////////////////
 
+// 机构电机最近一次指令; 卡球保护(jam.h)接管期间只记录指令, 由它反转后再恢复
+enum MechMotor { MECH_INTAKE = 0, MECH_BALL = 1, MECH_SHOOT = 2, MECH_MOTORS = 3 };
+int mech_cmd[MECH_MOTORS] = {0, 0, 0};
+bool mech_hold[MECH_MOTORS] = {false, false, false};
+
 ////吸取/////
 /**
  * @brief 吸球电机控制
@@ -226,6 +236,8 @@ void Run_time(int spd,int time)
  */
 void Intake(int spd)
 {
+  mech_cmd[MECH_INTAKE] = spd;
+  if (mech_hold[MECH_INTAKE]) return;
   //m(Intake_1,spd);
   motorctrl(Intake_1,100,spd);
 }
@@ -236,6 +248,8 @@ void Intake(int spd)
  */
 void IntakeStop(brakeType brake_name)
 {
+  mech_cmd[MECH_INTAKE] = 0;
+  if (mech_hold[MECH_INTAKE]) return;
   Intake_1.stop(brake_name);
 }
 
@@ -258,6 +272,8 @@ void Intake_time(int spd,int time)
  */
 void Shoot(int spd)
 {
+  mech_cmd[MECH_SHOOT] = spd;
+  if (mech_hold[MECH_SHOOT]) return;
   //motorctrl(Shoot_1,100,spd);
   m(Shoot_1,spd);
 }
@@ -281,6 +297,8 @@ void Shoot_time(int spd,int time)
  */
 void Ball(int spd)
 {
+  mech_cmd[MECH_BALL] = spd;
+  if (mech_hold[MECH_BALL]) return;
   //m(UpDown_1,spd);
   m(Ball_1,spd);
 }
@@ -318,85 +336,7 @@ void Wing(int LR)
 // 颜色识别与自动分球系统
 ///////////////////////////////////////////////////////////////////////////////
 
-/**颜色识别自动控制线程函数
- * 根据联盟颜色和传感器检测结果自动控制吸球和分球
- * Alliance: 0-手动, 1-红方, -1-蓝方
- */
-void Color_Control(){
-  while(true){
-    if(auto_color_ctrl==1){ //自动颜色控制开启
-      if (Alliance==0){ //手动模式:不判断颜色,直接吸球
-        Intake(100);
-        Ball(100);
-      }
-      else if(Alliance==1){ //红方:保留红球,排出蓝球
-        if(Color_2.color()==blue){   //靠下传感器检测到蓝球
-          auto_color_divide=1;
-          Ball(-80);  //反转排出
-          Intake(20);  //降低吸球速度
-          wait(80, msec); // 防抖延时
-        }
-        else if(Color_2.color()==red){ //检测到红球
-          auto_color_divide=0;
-          Ball(100);   //正常吸入
-          Intake(100);
-        }
-        else if(Color.color()==blue&&Color.isNearObject()){ //靠上传感器检测到蓝球
-          auto_color_divide=1;
-          Ball(-80);  //反转排出
-          Intake(20);
-          wait(80, msec); // 防抖延时
-        }
-        else if(Color.color()==red&&Color.isNearObject()){ //检测到红球
-          auto_color_divide=0;
-          Ball(100);
-          Intake(100);
-        }
-        else{ //未检测到球
-          auto_color_divide=0;
-          Ball(100);
-          Intake(80);
-        }
-      }
-      else if(Alliance==-1){ //蓝方:保留蓝球,排出红球
-        if(Color_2.color()==blue){ //下传感器检测到蓝球
-          auto_color_divide=0;
-          Ball(100);   //正常吸入
-          Intake(100);
-        }
-        else if(Color_2.color()==red){ //检测到红球
-          auto_color_divide=1;
-          Ball(-80);  //反转排出
-          Intake(20);  //降低吸球速度
-          wait(80, msec); // 防抖延时
-        }
-        else if(Color.color()==blue&&Color.isNearObject()){ //上传感器检测到蓝球
-          auto_color_divide=0;
-          Ball(100);
-          Intake(100);
-        }
-        else if(Color.color()==red&&Color.isNearObject()){ //检测到红球
-          auto_color_divide=1;
-          Ball(-80);  //反转排出
-          Intake(20);
-          wait(80, msec); // 防抖延时
-        }
-        else{ //未检测到球
-          auto_color_divide=0;
-          Ball(100);
-          Intake(100);
-        }
-      }
-    } else {
-      auto_color_divide=0;
-    }
-    
-    // 移除 driver_control==1 时的 break，让线程常驻用于手动阶段
-    
-  wait(10, msec);
-  }
-}
-thread ColorThread=thread(Color_Control); //创建颜色控制线程
+// 颜色识别自动控制线程 Color_Control 见 sorter.h(事件驱动分球)
 
 /**
  * 以下是备用的颜色分球函数(已弃用)
@@ -469,6 +409,7 @@ thread OutThread=thread(Out_Count);*/
  */
 void Get_Ball(float spd)//0：停；1：中高桥；-1：低桥；2：吸球.     //在开启分球的情况下吐球时会导致Ball左右脑互搏（已修复）
 {
+  trace_instant("Get_Ball", (int)spd);
   if (spd==0) //停止模式
   {
     auto_color_ctrl=0; //关闭颜色控制
@@ -563,21 +504,38 @@ void mAuto(motor motor_name,int spd,int times)
  * @param spd 行驶速度
  * @param timeout 超时时间(毫秒)
  * 当电机转速低于10rpm时判定为撞墙,提前停止
+ * @return 运动结果(motion_result.h), 误差为较慢一侧的转速(rpm); 检测到堵转记为 settled
  */
-void Wall_Stop(int spd,float timeout)
+MotionResult Wall_Stop(int spd,float timeout)
 {
-  float Time=Brain.timer(timeUnits::sec);
+  TraceSpan span("Wall_Stop", spd);
+  motion_begin(false);
+  MotionWatch watch("Wall_Stop", timeout + WATCHDOG_MARGIN_MS, true);
+  uint64_t Time=clock_us();
+  MotionMeter meter("Wall_Stop", spd, spd, 10);
+  bool stalled = false;
   Run(spd);
   wait(100);
-  while ((Brain.timer(timeUnits::sec)-Time)<=timeout/1000)
+  unsigned int tick = control_tick; //执行器节拍
+  while (clock_since(Time)<=timeout/1000 && !motion_cancelled())
    
   {
-    if(fabs(RightRun_1.velocity(velocityUnits::rpm))<10||fabs(LeftRun_1.velocity(velocityUnits::rpm)<10))
-    {break;}  //检测到堵转,退出循环
+    SensorSnapshot snap = sensors(); //本节拍快照
+    float slow_rpm = snap.right_speed < snap.left_speed ? snap.right_vel : snap.left_vel;
+    meter.update(slow_rpm);
+    if(snap.right_speed<10||snap.left_speed<10)
+    {
+      capture_trigger(CAPTURE_WALL_STALL, slow_rpm);
+      stalled = true;
+      break;
+    }  //检测到堵转,退出循环
+    control_wait(tick); //等待下一个10ms节拍
   }
   Run(0);
+  motion_end();
+  return meter.finish(stalled);
 }
-// Run_gyro内部状态,供测试日志任务读取
+// 运动函数每个节拍的内部状态(遥测样本内容)
 struct TelemetryData {
     int action;          // 1=Turn, 2=Run直线, 3=测速测试
     float target;
@@ -594,7 +552,95 @@ struct TelemetryData {
     float aux_out;
     float gyro_pitch;
 };
-TelemetryData current_telemetry = {0};
+TelemetryData current_telemetry = {0}; // 运动函数所在任务的暂存, 填完整后 telemetry_publish()
+
+///////////////////////////////////////////////////////////////////////////////
+// 遥测环形缓冲(单生产者单消费者, 无锁无等待)
+//
+// 生产者: 当前运行的运动函数(同一时刻只有一个), 每节拍发布一条完整样本,
+//         带快照时间戳/节拍号和左右侧均速, 不再由日志任务拼接两个节拍的数据
+// 消费者: 日志任务按批取出; 满了丢弃新样本并计入 telemetry_dropped, 不阻塞控制环
+// head 只由生产者写, tail 只由消费者写, 序号自然溢出, 容量须为 2 的幂
+// 另外每条样本同时写进 telemetry_latest(序号锁), 执行器上的异常抓取按节拍取最新一条,
+// 不占用环的消费者位置
+///////////////////////////////////////////////////////////////////////////////
+struct TelemetrySample {
+    uint64_t time_us;       // 所用快照的采样时刻(微秒)
+    unsigned int tick;      // 所在节拍
+    float left_avg;         // 左侧均速(rpm, 绝对值)
+    float right_avg;        // 右侧均速(rpm, 绝对值)
+    TelemetryData t;
+};
+
+const unsigned int TELEMETRY_RING_SIZE = 256;   // 100Hz 下约 2.5 秒
+TelemetrySample telemetry_ring[TELEMETRY_RING_SIZE];
+volatile unsigned int telemetry_head = 0;       // 生产者写入位置
+volatile unsigned int telemetry_tail = 0;       // 消费者读取位置
+unsigned int telemetry_dropped = 0;             // 缓冲满时丢弃的样本数
+
+volatile unsigned int telemetry_latest_seq = 0; // 序号锁: 奇数表示正在写
+TelemetrySample telemetry_latest = {0};         // 最近发布的一条样本, time_us 为 0 表示还没有
+
+/**
+ * @brief 发布一条完整遥测样本(运动函数每节拍调用一次)
+ */
+void telemetry_publish(const TelemetryData &t)
+{
+  SensorSnapshot snap = sensors();
+  TelemetrySample s;
+  s.time_us = snap.time_us;
+  s.tick = snap.tick;
+  s.left_avg = snap.left_speed;
+  s.right_avg = snap.right_speed;
+  s.t = t;
+
+  telemetry_latest_seq++;
+  __sync_synchronize();
+  telemetry_latest = s;
+  __sync_synchronize();
+  telemetry_latest_seq++;
+
+  unsigned int head = telemetry_head;
+  if (head - telemetry_tail >= TELEMETRY_RING_SIZE) {
+    telemetry_dropped++;
+    return;
+  }
+  telemetry_ring[head % TELEMETRY_RING_SIZE] = s;
+  __sync_synchronize();   // 样本写完再移动 head
+  telemetry_head = head + 1;
+}
+
+/**
+ * @brief 读取最近发布的一条样本(无锁快照, 任意任务调用)
+ */
+TelemetrySample telemetry_read_latest()
+{
+  TelemetrySample s;
+  unsigned int seq;
+  do {
+    seq = telemetry_latest_seq;
+    __sync_synchronize();
+    s = telemetry_latest;
+    __sync_synchronize();
+  } while ((seq & 1) || seq != telemetry_latest_seq);
+  return s;
+}
+
+/**
+ * @brief 批量取出样本(消费者调用)
+ * @return 取出的条数(<= max)
+ */
+int telemetry_drain(TelemetrySample *out, int max)
+{
+  unsigned int tail = telemetry_tail;
+  unsigned int head = telemetry_head;
+  __sync_synchronize();   // 先看到 head 再读样本
+  int n = 0;
+  while (tail != head && n < max) out[n++] = telemetry_ring[tail++ % TELEMETRY_RING_SIZE];
+  __sync_synchronize();   // 样本读完再释放槽位
+  telemetry_tail = tail;
+  return n;
+}
 ///////////////////////////////////////////////////////////////////////////////
 
 /**
@@ -603,14 +649,21 @@ TelemetryData current_telemetry = {0};
  * @param power 基础功率(0-100)
  * @param g 目标角度
  * @param ramp 是否启用比例减速(默认为true)
+ * @return 运动结果(motion_result.h)
  * 使用陀螺仪实时纠偏,保证直线行驶精度
  */
-void Run_gyro(double enc , double power, float g = now, bool ramp=true)
+MotionResult Run_gyro(double enc , double power, float g = now, bool ramp=true)
 {
+  TraceSpan span("Run_gyro", (int)enc);
   //enc=enc*3;
+  bool chained = motion_begin();
+  MotionWatch watch("Run_gyro");
+  enc += chain_carry_distance; //上一段链式直线没走完的距离
+  float chain_exit = chain_exit_error(CHAIN_DRIVE_EXIT);
   g=Side*g+Start; //根据场地方向调整目标角度
-  LeftRun_1.resetPosition();
-  RightRun_1.resetPosition();
+  SensorSnapshot snap = sensors();
+  float left0 = snap.left_pos;  //起点编码器值(不再清零, 保持里程计连续)
+  float right0 = snap.right_pos;
   
   //PID参数
   //float gyro_kp = 1;
@@ -627,23 +680,31 @@ void Run_gyro(double enc , double power, float g = now, bool ramp=true)
   float gyro_lasterror;//上一次角度误差
   float move_lasterror = 0;//上一次距离误差
   float move_err = fabs(enc) - fabs(menc);//编码器当前与目标差值
-  float gyro_err = g - Gyro.rotation(degrees) ;//陀螺仪当前与目标差值
+  float gyro_err = g - snap.heading ;//陀螺仪当前与目标差值
 
   double total_enc = fabs(enc); //总距离(度)
 
   gyro_lasterror = gyro_err;
   //int timeout =  enc < 300 ? 500 : enc * 1.5;
-  float Timer=Brain.timer(timeUnits::sec);
+  uint64_t Timer=clock_us();
   float timeout=fabs((0.1*enc)/power); //根据距离和速度计算超时时间
+  unsigned int tick = control_tick; //执行器节拍
+  float ticks = 1; //两次快照间隔折合的节拍数(微分按10ms节拍整定)
+  float carry = 0;//链式衔接时交给下一段的直线输出
+  MotionMeter meter("Run_gyro", enc, move_err, 2); //运动结果统计, 稳定误差与到达判断一致
+  bool arrived = false, chain_hit = false;
   
-	while((Brain.timer(timeUnits::sec)-Timer)<=timeout+0.5)
+	while(clock_since(Timer)<=timeout+0.5 && !motion_cancelled())
   {
-    //实时更新编码器和陀螺仪数据
-    menc = (fabs(LeftRun_1.position(rotationUnits::deg))+ fabs(RightRun_1.position(rotationUnits::deg)))/2;
+    //实时更新编码器和陀螺仪数据(本节拍快照, 一次循环内只取一次)
+    snap = sensors();
+    menc = (fabs(snap.left_pos - left0)+ fabs(snap.right_pos - right0))/2;
     move_err = fabs(enc) - fabs(menc);
-    gyro_err = g - Gyro.rotation(degrees) ;
-    vg = gyro_err - gyro_lasterror;  //计算角度变化率
-    vm = move_err-move_lasterror;    //计算距离变化率
+    meter.update(move_err);
+    motion_progress(menc, fabs(enc));
+    gyro_err = g - snap.heading ;
+    vg = (gyro_err - gyro_lasterror) / ticks;  //计算角度变化率
+    vm = (move_err-move_lasterror) / ticks;    //计算距离变化率
     gyro_lasterror = gyro_err;
     
     //PD控制计算转向补偿
@@ -658,7 +719,7 @@ void Run_gyro(double enc , double power, float g = now, bool ramp=true)
        // 线性减速: current_power * (剩余距离/减速阈值)
        current_power = current_power * (fabs(move_err) / decel_dist) * ramp_kp;
     }
-    if(current_power < motor_min_speed) current_power = motor_min_speed; // 最小速度限制
+    if(current_power < drive_creep_power(power)) current_power = drive_creep_power(power); // 最低爬行功率(前馈模型)
     
     // 恢复原有符号方向
     double final_power = sgn(power) * current_power;
@@ -669,7 +730,7 @@ void Run_gyro(double enc , double power, float g = now, bool ramp=true)
     current_telemetry.current = menc;
     current_telemetry.error = move_err;
     current_telemetry.error_deriv = vm;
-    current_telemetry.dt = 0;
+    current_telemetry.dt = ticks * CONTROL_DT;
     current_telemetry.p_out = 0;
     current_telemetry.i_out = 0;
     current_telemetry.d_out = 0;
@@ -677,20 +738,31 @@ void Run_gyro(double enc , double power, float g = now, bool ramp=true)
     current_telemetry.aux_error = gyro_err;
     current_telemetry.aux_deriv = vg;
     current_telemetry.aux_out = turnpower;
+    telemetry_publish(current_telemetry);
 
     move_lasterror = move_err;
     //到达目标判断
     if (fabs(enc)-fabs(menc)<2 && fabs(vm) < 1)//距离误差<2度 且 速度变化<1
     {
+      arrived = true;
+      break;
+    }
+    else if (chained && fabs(move_err) < chain_exit)//链式运动: 宽松误差即退出, 保持当前输出
+    {
+      chain_hit = true;
       break;
     }
     else
     {
     //应用补偿后的功率到左右电机
     Run_Ctrl((sgn(enc)*final_power)+ turnpower,(sgn(enc)*final_power) -turnpower);
+    carry = sgn(enc)*final_power;
     }
+    ticks = control_wait(tick) / CONTROL_DT; //等待下一个10ms节拍
   }
-  RunStop(brake);
+  if (motion_should_stop()) RunStop(brake);
+  motion_end(carry, sgn(enc) * move_err);
+  return meter.finish(arrived, chain_hit);
 }
 /**
  * @brief 陀螺仪辅助直线行驶(P控制)
@@ -698,17 +770,16 @@ void Run_gyro(double enc , double power, float g = now, bool ramp=true)
  * @param g 目标角度
  * 使用陀螺仪实时纠偏,保证直线行驶精度
  * 全程使用P控制自动计算行驶功率
+ * @return 运动结果(motion_result.h)
  */
-void Run_gyro_new(double enc, float g=now)
+MotionResult Run_gyro_new(double enc, float g=now)
 {
+  TraceSpan span("Run_gyro_new", (int)enc);
+  motion_begin(false);
+  MotionWatch watch("Run_gyro_new");
   //enc=enc*3;
   g=Side*g+Start; //根据场地方向调整目标角度
-  LeftRun_1.resetPosition();
-  LeftRun_2.resetPosition();
-  LeftRun_3.resetPosition();
-  RightRun_1.resetPosition();
-  RightRun_2.resetPosition();
-  RightRun_3.resetPosition();
+  float enc0 = drive_position(); //起点编码器值(不再清零, 保持里程计连续)
   
   //PD参数 — gyro自适应: kp = 基准值 × RPM × kp_scale, kd = 基准值 × RPM × kd_scale
   float gyro_kp_base = 7.0;     //基准kp (100 RPM下调优所得)
@@ -724,38 +795,34 @@ void Run_gyro_new(double enc, float g=now)
   float movepower;//移动补偿功率
   float move_err = fabs(enc) - fabs(menc);//编码器当前与目标差值
   float move_lasterror = move_err;//上一次距离误差(初始化为初始误差)
-  float gyro_err = g - Gyro.rotation(degrees) ;//陀螺仪当前与目标差值
+  float gyro_err = g - sensors().heading ;//陀螺仪当前与目标差值
   float gyro_lasterror = gyro_err;//上一次角度误差(初始化为当前误差,避免首周期vg尖峰)
 
   //int timeout =  enc < 300 ? 500 : enc * 1.5;
-  float Timer=Brain.timer(timeUnits::sec);
+  uint64_t Timer=clock_us();
   float timeout=fabs(enc) / 200.0 + 1.0; //超时保护
-  float last_time = Timer; //动态dt: 记录上一次循环时间
+  unsigned int tick = control_tick; //执行器节拍
+  MotionMeter meter("Run_gyro_new", enc, move_err, 2); //运动结果统计, 稳定误差与到达判断一致
+  bool arrived = false;
   
-	while((Brain.timer(timeUnits::sec)-Timer)<=timeout+0.5)
+	while(clock_since(Timer)<=timeout+0.5 && !motion_cancelled())
   {
-    //动态计算dt: 用实际经过时间而非固定值
-    float current_time = Brain.timer(timeUnits::sec);
-    float dt = current_time - last_time;
-    if (dt < 0.002) {          //不足2ms就跳过, 防止dt过小导致vm噪声爆炸
-      vex::task::sleep(1);     //让出CPU, 避免空转
-      continue;
-    }
-    last_time = current_time;
+    //固定dt: 由执行器节拍给出, 不再因循环抖动导致vm噪声
+    float dt = control_wait(tick);
 
     //实时更新编码器和陀螺仪数据 (6电机平均)
-    menc = (fabs(LeftRun_1.position(rotationUnits::deg)) + fabs(LeftRun_2.position(rotationUnits::deg)) + fabs(LeftRun_3.position(rotationUnits::deg))
-         + fabs(RightRun_1.position(rotationUnits::deg)) + fabs(RightRun_2.position(rotationUnits::deg)) + fabs(RightRun_3.position(rotationUnits::deg))) / 6.0;
+    SensorSnapshot snap = sensors(); //本节拍快照, 一次循环内只取一次
+    menc = fabs((snap.left_pos + snap.right_pos) / 2 - enc0);
     move_err = fabs(enc) - fabs(menc);
-    gyro_err = g - Gyro.rotation(degrees) ;
+    meter.update(move_err);
+    gyro_err = g - snap.heading ;
 
     //归一化为每秒变化率(÷dt), 让kd的单位(°/s)与kp(°)量级匹配
     vm = (move_err - move_lasterror) / dt;    //距离变化率(°/s), 接近目标时为负
     
     
     //PD控制计算转向补偿 — 动态自适应kp/kd
-    float avg_rpm = (fabs(LeftRun_1.velocity(rpm)) + fabs(LeftRun_2.velocity(rpm)) + fabs(LeftRun_3.velocity(rpm))
-                   + fabs(RightRun_1.velocity(rpm)) + fabs(RightRun_2.velocity(rpm)) + fabs(RightRun_3.velocity(rpm))) / 6.0;
+    float avg_rpm = (snap.left_speed + snap.right_speed) / 2;
     float gyro_kp = gyro_kp_base * avg_rpm/100;
     float gyro_kd = gyro_kd_base * avg_rpm/100;
     float vg = (gyro_err - gyro_lasterror) / dt;  //角速度(°/s)
@@ -765,7 +832,7 @@ void Run_gyro_new(double enc, float g=now)
     //PD控制计算行驶功率
     movepower = move_kp * move_err + move_kd * vm;
     if(movepower > 100) movepower = 100;              // 最大速度限制
-    if(movepower < motor_min_speed && fabs(enc) > fabs(menc)) movepower = motor_min_speed; // 最小速度限制
+    if(movepower < drive_creep_power(enc) && fabs(enc) > fabs(menc)) movepower = drive_creep_power(enc); // 最低爬行功率(前馈模型)
     double final_power = movepower;
 
     // 写入全局变量供测试日志读取
@@ -782,10 +849,12 @@ void Run_gyro_new(double enc, float g=now)
     current_telemetry.aux_error = gyro_err;
     current_telemetry.aux_deriv = vg;
     current_telemetry.aux_out = turnpower;
+    telemetry_publish(current_telemetry);
     move_lasterror = move_err;
     //到达目标判断: 距离误差<2度 且 速度<100°/s (归一化后的vm单位是°/s)
     if (fabs(enc)-fabs(menc)<2 && fabs(vm) < 100)
     {
+      arrived = true;
       break;
     }
     else
@@ -793,9 +862,10 @@ void Run_gyro_new(double enc, float g=now)
     //应用补偿后的功率到左右电机
     Run_Ctrl((sgn(enc)*final_power)+ turnpower,(sgn(enc)*final_power) -turnpower);
     }
-    vex::task::sleep(10); 
   }
   RunStop(brake);
+  motion_end();
+  return meter.finish(arrived);
 }
 
 /**
@@ -818,20 +888,24 @@ struct JAR_PID {
         error(error), kp(kp), ki(ki), kd(kd), starti(starti), 
         settle_error(settle_error), settle_time(settle_time), timeout(timeout) {}
 
-    float compute(float current_error) {
+    // dt: 与上次调用的实际间隔(秒, control_wait 的返回值)。增益按 10ms 节拍整定,
+    // 导数和积分都折算到一个名义节拍, 节拍抖动不改变等效增益
+    float compute(float current_error, float dt = CONTROL_DT) {
         error = current_error;
+        float ticks = dt / CONTROL_DT;
+        if (ticks <= 0) ticks = 1;
         
         // 第一次循环时，防止产生巨大的误差导数尖峰
         if (time_spent_running == 0) {
             previous_error = error;
             current_deriv = 0;
         } else {
-            current_deriv = error - previous_error; // 必须在 previous_error 更新前计算
+            current_deriv = (error - previous_error) / ticks; // 必须在 previous_error 更新前计算
         }
 
         // 积分起效窗口
         if (fabs(error) < starti) {
-            accumulated_error += error;
+            accumulated_error += error * ticks;
         }
         // 过零清空积分
         if ((error > 0 && previous_error < 0) || (error < 0 && previous_error > 0)) {
@@ -843,21 +917,26 @@ struct JAR_PID {
 
         // 稳定时间判定 (原生 JAR 逻辑)
         if (fabs(error) < settle_error) {
-            time_spent_settled += 10;
+            time_spent_settled += dt * 1000;
         } else {
             time_spent_settled = 0;
         }
 
-        time_spent_running += 10;
+        time_spent_running += dt * 1000;
         return output;
     }
 
+    // 是否因超时而结束(而不是误差稳定)
+    bool timed_out() {
+        return time_spent_running > timeout && timeout != 0;
+    }
+
     bool is_settled() {
-        if (time_spent_running > timeout && timeout != 0) return true;
+        if (timed_out()) return true;
         if (time_spent_settled > settle_time) return true;
         
         // 融合你的老代码逻辑：如果误差极小，并且速度接近于0，立刻退出！
-        // 因为 dt = 10ms，所以速度差值如果 < 0.3 (即30度/秒)，就说明车子已经物理停转了。
+        // current_deriv 按 10ms 节拍折算，所以速度差值如果 < 0.3 (即30度/秒)，就说明车子已经物理停转了。
         if (fabs(error) < settle_error * 1.5 && fabs(current_deriv) < 0.3) {
             return true;
         }
@@ -871,16 +950,18 @@ struct JAR_PID {
  * @param target_enc 目标距离 (编码器度数)，正数前进，负数后退
  * @param target_heading 目标航向
  * @param max_voltage 最大输出功率 (0-100)
+ * @return 运动结果(motion_result.h)
  */
-void run_gyro_JAR(double target_enc, float target_heading = now, float max_voltage = 127) {
+MotionResult run_gyro_JAR(double target_enc, float target_heading = now, float max_voltage = 127) {
+    TraceSpan span("run_gyro_JAR", (int)target_enc);
+    bool chained = motion_begin();
+    MotionWatch watch("run_gyro_JAR");
+    float chain_exit = chain_exit_error(CHAIN_DRIVE_EXIT);
+    target_enc += chain_carry_distance; // 上一段链式直线没走完的距离
     target_heading = Side * target_heading + Start; // 适应场地
 
-    LeftRun_1.resetPosition();
-    LeftRun_2.resetPosition();
-    LeftRun_3.resetPosition();
-    RightRun_1.resetPosition();
-    RightRun_2.resetPosition();
-    RightRun_3.resetPosition();
+    SensorSnapshot snap = sensors(); // 本节拍传感器快照, 每个循环只取一次
+    float enc0 = (snap.left_pos + snap.right_pos) / 2; // 起点编码器值(不再清零, 保持里程计连续)
 
     float drive_timeout = fabs(target_enc) / 200.0 * 500 + 1000; // 缩短超时时间，避免死等
     
@@ -909,21 +990,28 @@ void run_gyro_JAR(double target_enc, float target_heading = now, float max_volta
     JAR_PID drivePID(target_enc, drive_kp, drive_ki, drive_kd, drive_starti, drive_settle_error, drive_settle_time, drive_timeout); 
     
     // 航向PID微调: 降低 P 以减小前进弧线时的过冲，适当增加 D 加强阻尼
-    float heading_error = reduce_negative_180_to_180(target_heading - Gyro.rotation(degrees));
+    float heading_error = reduce_negative_180_to_180(target_heading - snap.heading);
     JAR_PID headingPID(heading_error, 2.5, 0.0, 18.0, 0, 1.0, 100, 0);
 
     float heading_max_voltage = 40;
-    float prev_drive_output = 0.0; // 用于限制起步加速度
-
-    while (!drivePID.is_settled()) {
-        float average_position = (LeftRun_1.position(deg) + LeftRun_2.position(deg) + LeftRun_3.position(deg) +
-                                  RightRun_1.position(deg) + RightRun_2.position(deg) + RightRun_3.position(deg)) / 6.0;
+    float prev_drive_output = chain_carry_output; // 用于限制起步加速度(链式衔接时从上一段的输出起步)
+    unsigned int tick = control_tick; // 执行器节拍
+    float dt = CONTROL_DT;            // 两次快照的实际间隔
+    MotionMeter meter("run_gyro_JAR", target_enc, target_enc, drive_settle_error);
+    bool chain_hit = false;
+    float drive_err = target_enc;
+
+    while (!drivePID.is_settled() && !motion_cancelled()) {
+        snap = sensors();
+        float average_position = (snap.left_pos + snap.right_pos) / 2 - enc0;
+        motion_progress(average_position, target_enc);
         
-        float drive_err = target_enc - average_position;
-        float head_err = reduce_negative_180_to_180(target_heading - Gyro.rotation(degrees));
+        drive_err = target_enc - average_position;
+        meter.update(drive_err);
+        float head_err = reduce_negative_180_to_180(target_heading - snap.heading);
 
-        float drive_output = drivePID.compute(drive_err);
-        float heading_output = headingPID.compute(head_err);
+        float drive_output = drivePID.compute(drive_err, dt);
+        float heading_output = headingPID.compute(head_err, dt);
 
         // --- 新增：起步加速度限制 (Slew Rate Control) ---
         // 极限测试出现翘头，回退 Slew Rate 至稍微激进但稳定的值 (20)，约 0.06 秒推到满速
@@ -937,18 +1025,19 @@ void run_gyro_JAR(double target_enc, float target_heading = now, float max_volta
         }
         prev_drive_output = drive_output;
 
-        // --- 新增：最小起步功率 (死区补偿) ---
-        // 彻底解决末段死区问题：当输出太小推不动底盘，且还没到达目标时，强制给一个最小功率，瞬间破除静摩擦。
-        // 上次测试中 8.2 的输出仍然无法克服静摩擦导致超时，因此将最小功率提升至 12.0 (约 1V)。
-        float min_power = 12.0; // 最小起步功率，确保能克服静摩擦
-        if (fabs(drive_err) > 2.0) { // 如果误差大于 2 度，说明还没到
-            if (drive_output > 0 && drive_output < min_power) {
-                drive_output = min_power;
-            } else if (drive_output < 0 && drive_output > -min_power) {
-                drive_output = -min_power;
+        // --- 静摩擦前馈 (取代原最小起步功率钳位) ---
+        // 未进入稳定误差前, 按误差方向给左右两侧各自叠加 kS(前馈模型拟合值)。
+        // PID 输出本身不再被抬高, D 项的反向刹车不会变成同向推力, 末段不再来回抽动。
+        // 模型未拟合时沿用原最小起步功率钳位(误差大于 2 度时抬到 12)。
+        float left_ff = 0, right_ff = 0;
+        if (!drive_ff_fitted) {
+            if (fabs(drive_err) > 2.0 && drive_output != 0 && fabs(drive_output) < FF_LEGACY_DRIVE_MIN) {
+                drive_output = sgn(drive_output) * FF_LEGACY_DRIVE_MIN;
             }
+        } else if (fabs(drive_err) > drive_settle_error) {
+            left_ff = ff_left_static(drive_err);
+            right_ff = ff_right_static(drive_err);
         }
-        // -------------------------------------
 
         // 提取已计算的导数用于日志
         float current_drive_deriv = drivePID.current_deriv;
@@ -965,8 +1054,8 @@ void run_gyro_JAR(double target_enc, float target_heading = now, float max_volta
 
         // 结合输出 (左轮 = 驱动 + 转向, 右轮 = 驱动 - 转向)
         // 恢复航向纠偏
-        float left_out = drive_output + heading_output;
-        float right_out = drive_output - heading_output;;
+        float left_out = drive_output + heading_output + left_ff;
+        float right_out = drive_output - heading_output + right_ff;
 
         // 记录遥测日志
         current_telemetry.action = 3; // 标记为 3 (JAR直线)
@@ -974,20 +1063,190 @@ void run_gyro_JAR(double target_enc, float target_heading = now, float max_volta
         current_telemetry.current = average_position;
         current_telemetry.error = drive_err;
         current_telemetry.error_deriv = current_drive_deriv; 
-        current_telemetry.dt = 0.01;
+        current_telemetry.dt = dt;
         current_telemetry.p_out = drivePID.kp * drive_err;
         current_telemetry.i_out = drivePID.ki * drivePID.accumulated_error;
         current_telemetry.d_out = drivePID.kd * current_drive_deriv;
-        current_telemetry.total_out = drive_output;
+        current_telemetry.total_out = drive_output + (left_ff + right_ff) / 2;
         current_telemetry.aux_error = head_err;
         current_telemetry.aux_deriv = current_head_deriv;
         current_telemetry.aux_out = heading_output;
-        current_telemetry.gyro_pitch = Gyro.pitch(degrees);
+        current_telemetry.gyro_pitch = snap.pitch;
+        telemetry_publish(current_telemetry);
 
         Run_Ctrl(left_out, right_out);
-        vex::task::sleep(10); 
+        // 链式运动: 进入宽松误差即退出, 保持当前输出交给下一段
+        if (chained && fabs(drive_err) < chain_exit) {
+            chain_hit = true;
+            break;
+        }
+        dt = control_wait(tick);
     }
-    RunStop(brake);
+    if (drivePID.timed_out()) capture_trigger(CAPTURE_JAR_TIMEOUT, drivePID.error);
+    if (motion_should_stop()) RunStop(brake);
+    motion_end(prev_drive_output, drive_err);
+    return meter.finish(!drivePID.timed_out(), chain_hit);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// S 曲线规划直线行驶(前馈 + 反馈跟踪)
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief 规划直线的限幅与跟踪参数
+ * 单位: 编码器度数 / 秒; 输出为功率(0-100, 对应 0-12V)
+ */
+struct DriveProfileConfig {
+    float max_vel;       // 最大速度(度/秒), 空载约 1200
+    float max_accel;     // 最大加速度(度/秒^2)
+    float max_jerk;      // 最大加加速度(度/秒^3), 0 为梯形曲线
+    float kP;            // 位置误差反馈
+    float kD;            // 速度误差反馈
+    float settle_error;  // 稳定误差(度), 与 run_gyro_JAR 一致
+    float settle_time;   // 稳定时间(ms)
+};
+DriveProfileConfig drive_profile = {1000, 3000, 20000, 1.0, 0.15, 3.5, 50}; // 前馈见 feedforward.h 的 drive_ff(默认值仅适用于仿真)
+
+/**
+ * @brief S 曲线规划直线行驶
+ * @param target_enc 目标距离 (编码器度数)，正数前进，负数后退
+ * @param target_heading 目标航向
+ * @param max_voltage 最大输出功率 (0-100)
+ *
+ * 按 drive_profile 的速度/加速度/加加速度生成 S 曲线, 每个节拍取参考位置、速度、
+ * 加速度: 输出 = ff_left/ff_right(v, a) (两侧各自的前馈) + kP*位置误差 + kD*速度误差 (反馈)。
+ * 曲线走完后只保留反馈, 误差进入 settle_error 并维持 settle_time 后退出。
+ * 遥测: target 为参考位置, p_out/d_out 为反馈, i_out 为两侧前馈均值。
+ * 输出以前馈为主, 前馈模型未拟合(drive_ff_fitted 为 false)时改走 run_gyro_JAR(沿用手调钳位)。
+ * @return 运动结果(motion_result.h)
+ */
+MotionResult run_gyro_profile(double target_enc, float target_heading = now, float max_voltage = 127) {
+    if (!drive_ff_fitted) {
+        printf("run_gyro_profile: feedforward not fitted, using run_gyro_JAR\n");
+        return run_gyro_JAR(target_enc, target_heading, max_voltage);
+    }
+    TraceSpan span("run_gyro_profile", (int)target_enc);
+    bool chained = motion_begin();
+    MotionWatch watch("run_gyro_profile");
+    float chain_exit = chain_exit_error(CHAIN_DRIVE_EXIT);
+    target_enc += chain_carry_distance; // 上一段链式直线没走完的距离
+    target_heading = Side * target_heading + Start; // 适应场地
+
+    float enc0 = drive_position(); // 起点编码器值(不再清零, 保持里程计连续)
+
+    DriveProfileConfig &cfg = drive_profile;
+    MotionProfile profile;
+    profile.plan(target_enc, cfg.max_vel, cfg.max_accel, cfg.max_jerk);
+
+    // 链式衔接: 上一段没有刹车, 按当前速度从曲线加速段中途接入(t0 时刻, 参考位置减去 p0),
+    // 曲线按 目标 + p0 重新规划, 否则参考从 0 速度开始会先把车刹住
+    float t0 = 0, p0 = 0;
+    SensorSnapshot snap = sensors();
+    float v_now = (snap.left_vel + snap.right_vel) / 2 * 6; // rpm -> 度/秒
+    if (chain_carry_output != 0 && v_now * target_enc > 0) {
+        for (int i = 0; i < 2; i++) {
+            profile.plan(target_enc + sgn(target_enc) * p0, cfg.max_vel, cfg.max_accel, cfg.max_jerk);
+            t0 = profile.join_time(fabs(v_now));
+            float v0, a0;
+            profile.sample(t0, p0, v0, a0);
+            p0 = fabs(p0);
+        }
+    }
+    p0 *= sgn(target_enc);
+    float timeout = (profile.total_time - t0) * 1000 + 1000; // 曲线时间 + 1 秒收敛
+
+    float heading_error = reduce_negative_180_to_180(target_heading - sensors().heading);
+    JAR_PID headingPID(heading_error, 2.5, 0.0, 18.0, 0, 1.0, 100, 0);
+    float heading_max_voltage = 40;
+
+    float t = t0;                // 曲线时间(秒)
+    float last_position = 0;
+    float time_spent_settled = 0;
+    float drive_output = 0;
+    unsigned int tick = control_tick; // 执行器节拍
+    float dt = CONTROL_DT;            // 两次快照的实际间隔
+    MotionMeter meter("run_gyro_profile", target_enc, target_enc, cfg.settle_error);
+    bool settled = false, chain_hit = false;
+
+    while ((t - t0) * 1000 < timeout && !motion_cancelled()) {
+        float average_position = drive_position() - enc0;
+        float velocity = (average_position - last_position) / dt;
+        last_position = average_position;
+        motion_progress(average_position, target_enc);
+        meter.update(target_enc - average_position);
+
+        // 反馈对齐当前时刻的参考; 前馈取下一节拍的参考(本次输出作用于接下来的一个周期)
+        float ref_pos, ref_vel, ref_acc, next_pos, next_vel, next_acc;
+        profile.sample(t, ref_pos, ref_vel, ref_acc);
+        profile.sample(t + CONTROL_DT, next_pos, next_vel, next_acc);
+        ref_pos -= p0;
+
+        // 前馈: 曲线内按参考速度/加速度给出; 曲线结束后只在误差较大时补静摩擦
+        float pos_err = ref_pos - average_position;
+        float final_err = target_enc - average_position;
+        float left_ff, right_ff;
+        if (next_vel != 0 || next_acc != 0) {
+            left_ff = ff_left(next_vel, next_acc);
+            right_ff = ff_right(next_vel, next_acc);
+        } else if (fabs(final_err) > cfg.settle_error) {
+            left_ff = ff_left_static(final_err);
+            right_ff = ff_right_static(final_err);
+        } else {
+            left_ff = right_ff = 0;
+        }
+        float ff = (left_ff + right_ff) / 2;
+
+        float p_out = cfg.kP * pos_err;
+        float d_out = cfg.kD * (ref_vel - velocity);
+        drive_output = ff + p_out + d_out;
+        if (fabs(drive_output) > max_voltage) {
+            drive_output = sgn(drive_output) * max_voltage;
+        }
+        float side_diff = (left_ff - right_ff) / 2; // 两侧模型差异, 不参与限幅
+
+        float head_err = reduce_negative_180_to_180(target_heading - sensors().heading);
+        float heading_output = headingPID.compute(head_err, dt);
+        if (fabs(heading_output) > heading_max_voltage) {
+            heading_output = sgn(heading_output) * heading_max_voltage;
+        }
+
+        current_telemetry.action = 5; // 标记为 5 (S曲线直线)
+        current_telemetry.target = ref_pos;
+        current_telemetry.current = average_position;
+        current_telemetry.error = final_err;
+        current_telemetry.error_deriv = velocity;
+        current_telemetry.dt = dt;
+        current_telemetry.p_out = p_out;
+        current_telemetry.i_out = ff;
+        current_telemetry.d_out = d_out;
+        current_telemetry.total_out = drive_output;
+        current_telemetry.aux_error = head_err;
+        current_telemetry.aux_deriv = headingPID.current_deriv;
+        current_telemetry.aux_out = heading_output;
+        current_telemetry.gyro_pitch = sensors().pitch;
+        telemetry_publish(current_telemetry);
+
+        Run_Ctrl(drive_output + heading_output + side_diff, drive_output - heading_output - side_diff);
+
+        // 退出判断: 链式运动进入宽松误差即退出; 否则曲线走完后稳定退出
+        if (chained && fabs(final_err) < chain_exit) {
+            chain_hit = true;
+            break;
+        }
+        if (t >= profile.total_time) {
+            if (fabs(final_err) < cfg.settle_error) time_spent_settled += dt * 1000;
+            else time_spent_settled = 0;
+            settled = time_spent_settled > cfg.settle_time
+                   || (fabs(final_err) < cfg.settle_error * 1.5 && fabs(velocity) < 30); // 已停稳
+            if (settled) break;
+        }
+
+        dt = control_wait(tick);
+        t += dt;
+    }
+    if (motion_should_stop()) RunStop(brake);
+    motion_end(drive_output, target_enc - (drive_position() - enc0));
+    return meter.finish(settled, chain_hit);
 }
 
 /**
@@ -997,28 +1256,29 @@ void run_gyro_JAR(double target_enc, float target_heading = now, float max_volta
  * @param move_side 动哪一侧 (left: 动左侧、右侧锁死; right: 动右侧、左侧锁死)
  * @param max_voltage 最大输出功率 (0-100)
  * @param force_dir 强制转向方向 (0: 自动最短路径, 1: 强制顺时针/从左往右转, -1: 强制逆时针/从右往左转)
+ * @return 运动结果(motion_result.h)
  */
-void turn_side_JAR(float target_heading, turnType move_side, float max_voltage = 127, int force_dir = 0) {
+MotionResult turn_side_JAR(float target_heading, turnType move_side, float max_voltage = 127, int force_dir = 0) {
+    TraceSpan span("turn_side_JAR", (int)target_heading);
+    bool chained = motion_begin();
+    MotionWatch watch("turn_side_JAR");
+    float chain_exit = chain_exit_error(CHAIN_TURN_EXIT);
     now = target_heading;
     bool move_left = (move_side == left);
     target_heading = Side * target_heading + Start; // 适应场地
     
     // PID 参数预设 (Swing turn 需要独立的一套参数，因为单侧锁死时摩擦力极大)
-    // 引入 Min Power 逻辑后，无需再依赖极高的 P 和 I 来破死区。
+    // 静摩擦由前馈模型补偿，无需再依赖极高的 P 和 I 来破死区。
     // 降低 P 可以避免极速过快导致的严重过冲，降低 I 防止积分爆炸。
     float swing_kp = 3.0;   // 保持适中
     float swing_ki = 0.01;  // 仅消除微小静差
-    float swing_kd = 35.0;  // 【大幅提高】为了在靠近目标时压制 P 项，使总输出反向以跳过 Min Power 钳位，实现提前刹车
+    float swing_kd = 35.0;  // 高 D: 靠近目标时压制 P 项，提前刹车
     float swing_starti = 15.0;
     float swing_settle_error = 1.0;
     float swing_settle_time = 50;
     float swing_timeout = 2000;
     
-    // 新增：最小起步电压 (Min Power)，破除静摩擦死区
-    // 数据显示 15V 时底盘仍可能卡死，故将钳位提升至 20V
-    float min_power = 20.0; 
-    
-    float current_heading = Gyro.rotation(degrees);
+    float current_heading = sensors().heading;
     float initial_error = reduce_negative_180_to_180(target_heading - current_heading);
     
     // 处理强制转向方向 (覆盖最短路径)
@@ -1031,25 +1291,36 @@ void turn_side_JAR(float target_heading, turnType move_side, float max_voltage =
     float absolute_target = current_heading + initial_error;
     
     JAR_PID swingPID(initial_error, swing_kp, swing_ki, swing_kd, swing_starti, swing_settle_error, swing_settle_time, swing_timeout);
+    unsigned int tick = control_tick; // 执行器节拍
+    float dt = CONTROL_DT;            // 两次快照的实际间隔
+    float center_output = 0; // 车体中心的直线输出(单侧输出的一半), 链式衔接用
+    MotionMeter meter("turn_side_JAR", now, initial_error, swing_settle_error);
+    bool chain_hit = false;
     
-    while (!swingPID.is_settled()) {
+    while (!swingPID.is_settled() && !motion_cancelled()) {
+        SensorSnapshot snap = sensors(); // 本节拍快照, 一次循环内只取一次
         float error;
         if (force_dir != 0) {
-            error = absolute_target - Gyro.rotation(degrees);
+            error = absolute_target - snap.heading;
         } else {
-            error = reduce_negative_180_to_180(target_heading - Gyro.rotation(degrees));
+            error = reduce_negative_180_to_180(target_heading - snap.heading);
         }
-        float output = swingPID.compute(error);
+        meter.update(error);
+        motion_progress(fabs(initial_error) - fabs(error), fabs(initial_error));
+        float output = swingPID.compute(error, dt);
         float current_deriv = swingPID.current_deriv;
         
-        // --- 新增：最小电压钳位 (Min Power 逻辑) ---
-        // 只有当误差大于阈值（1.0 度）时才强行给底盘推力
-        if (fabs(error) > 1.0) {
-            // 关键：只有当 PID 尝试往目标方向推（或输出为0）且推力不足时，才进行钳位。
-            // 这样可以保留 D 项在面临过冲时的正常反向刹车能力！
-            if (fabs(output) < min_power && (output == 0 || (output * error > 0))) {
-                output = sgn(error) * min_power;
-            }
+        // --- 静摩擦前馈 (取代原 20 功率的最小电压钳位) ---
+        // 误差大于稳定阈值时按误差方向叠加活动侧对应方向的 kS。
+        // PID 输出不再被钳位, D 项的反向刹车保持原样。
+        // 模型未拟合时沿用原钳位: PID 往目标方向推(或为 0)且推力不足时抬到 20。
+        if (fabs(error) > swing_settle_error) {
+            if (!drive_ff_fitted) {
+                if (fabs(output) < FF_LEGACY_SWING_MIN && (output == 0 || output * error > 0)) {
+                    output = sgn(error) * FF_LEGACY_SWING_MIN;
+                }
+            } else if (move_left) output += ff_left_static(error);
+            else output -= ff_right_static(-error);
         }
 
         // 限幅处理
@@ -1060,37 +1331,39 @@ void turn_side_JAR(float target_heading, turnType move_side, float max_voltage =
         // 记录遥测日志 (action = 4 代表 Swing Turn)
         current_telemetry.action = 4; 
         current_telemetry.target = target_heading;
-        current_telemetry.current = Gyro.rotation(degrees);
+        current_telemetry.current = snap.heading;
         current_telemetry.error = error;
         current_telemetry.error_deriv = current_deriv;
+        current_telemetry.dt = dt;
         current_telemetry.p_out = swingPID.kp * error;
         current_telemetry.i_out = swingPID.ki * swingPID.accumulated_error;
         current_telemetry.d_out = swingPID.kd * current_deriv;
         current_telemetry.total_out = output;
+        telemetry_publish(current_telemetry);
 
         // 根据选择的侧边输出电压，并锁死另一侧
         if (move_left) {
             // 左侧提供推力，右侧强行锁死作为旋转圆心
-            m(LeftRun_1, output);
-            m(LeftRun_2, output);
-            m(LeftRun_3, output);
-            RightRun_1.stop(hold);
-            RightRun_2.stop(hold);
-            RightRun_3.stop(hold);
+            drive_left.power((int)output);
+            drive_right.stop(hold);
         } else {
             // 右侧提供推力(反转以维持相同的转向方向定义)，左侧强行锁死
-            m(RightRun_1, -output);
-            m(RightRun_2, -output);
-            m(RightRun_3, -output);
-            LeftRun_1.stop(hold);
-            LeftRun_2.stop(hold);
-            LeftRun_3.stop(hold);
+            drive_right.power((int)-output);
+            drive_left.stop(hold);
         }
+        center_output = (move_left ? output : -output) / 2;
         
-        vex::task::sleep(10);
+        if (chained && fabs(error) < chain_exit) {
+            chain_hit = true;
+            break;
+        }
+        dt = control_wait(tick);
     }
-    // 结束后统一恢复刹车模式
-    RunStop(brake);
+    if (swingPID.timed_out()) capture_trigger(CAPTURE_JAR_TIMEOUT, swingPID.error);
+    // 结束后统一恢复刹车模式(链式运动不刹车)
+    if (motion_should_stop()) RunStop(brake);
+    motion_end(center_output);
+    return meter.finish(!swingPID.timed_out(), chain_hit);
 }
 
 
@@ -1112,8 +1385,11 @@ void turn_side_JAR(float target_heading, turnType move_side, float max_voltage =
  *    - 陀螺仪PD控制: 保持机器人朝向目标角度g
  *    - 测距仪差值纠偏: 当两个测距仪均有效且差值在200mm以内时,
  *      根据左右距离差(d1-d2)辅助修正航向,确保机器人平行于参照物(如墙壁)行驶
+ * @return 运动结果(motion_result.h), 误差为距目标距离的毫米数, 越过目标为负
  */
-void FAuto_Run_gyro(double dis , double power, float g, bool reverse=false){
+MotionResult FAuto_Run_gyro(double dis , double power, float g, bool reverse=false){
+  motion_begin(false);
+  MotionWatch watch("FAuto_Run_gyro");
   g=Side*g+Start; //根据场地方向调整目标角度
   
   //PID参数
@@ -1125,15 +1401,16 @@ void FAuto_Run_gyro(double dis , double power, float g, bool reverse=false){
   float vg = 0;//角速度差(微分项)
   float turnpower;//转向补偿功率
   float gyro_lasterror;//上一次角度误差
-  float gyro_err = g - Gyro.rotation(degrees) ;//陀螺仪当前与目标差值
+  float gyro_err = g - sensors().heading ;//陀螺仪当前与目标差值
 
   gyro_lasterror = gyro_err;
-  float Timer=Brain.timer(timeUnits::sec);
+  uint64_t Timer=clock_us();
+  unsigned int tick = control_tick;
   float timeout;
   
   // 计算初始距离用于超时判断
-  double start_d1 = Distance1.objectDistance(distanceUnits::mm);
-  double start_d2 = Distance2.objectDistance(distanceUnits::mm);
+  double start_d1 = sensors().dist1;
+  double start_d2 = sensors().dist2;
   double start_dist = 9999;
   
   if(start_d1!=9999 && start_d2!=9999) start_dist = (start_d1+start_d2)/2;
@@ -1154,10 +1431,13 @@ void FAuto_Run_gyro(double dis , double power, float g, bool reverse=false){
   else{
     timeout=fabs((0.1*(start_dist-dis))/power); //根据距离和速度计算超时时间
   }
+  MotionMeter meter("FAuto_Run_gyro", dis, start_dist == 9999 ? 0 : (reverse ? dis - start_dist : start_dist - dis), 10);
+  bool reached = false;
 
-  while((Brain.timer(timeUnits::sec)-Timer)<=timeout+0.5){
-    double d1 = Distance1.objectDistance(distanceUnits::mm);
-    double d2 = Distance2.objectDistance(distanceUnits::mm);
+  while(clock_since(Timer)<=timeout+0.5 && !motion_cancelled()){
+    SensorSnapshot snap = sensors(); //本节拍快照, 一次循环内只取一次
+    double d1 = snap.dist1;
+    double d2 = snap.dist2;
     double current_dist = 9999;
 
     // 计算当前综合距离
@@ -1167,19 +1447,22 @@ void FAuto_Run_gyro(double dis , double power, float g, bool reverse=false){
 
     //检查距离传感器,若距离小于目标距离则停止
     if(current_dist != 9999){
+        meter.update(reverse ? dis - current_dist : current_dist - dis);
         if(reverse){
           if(current_dist > dis){
+            reached = true;
             break;
           }
         }
         else{
           if(current_dist < dis){
+            reached = true;
             break;
           }
         }
     }
     //实时更新陀螺仪数据
-    gyro_err = g - Gyro.rotation(degrees) ;
+    gyro_err = g - snap.heading ;
     vg = gyro_err - gyro_lasterror;  //计算角度变化率
     gyro_lasterror = gyro_err;
     
@@ -1206,7 +1489,7 @@ void FAuto_Run_gyro(double dis , double power, float g, bool reverse=false){
            // 线性减速
            current_power = current_power * (dist_err / decel_dist);
        }
-       if(current_power < motor_min_speed) current_power = motor_min_speed; // 最小速度限制
+       if(current_power < drive_creep_power(power)) current_power = drive_creep_power(power); // 最低爬行功率(前馈模型)
     }
     
     // 恢复原有符号方向
@@ -1214,8 +1497,11 @@ void FAuto_Run_gyro(double dis , double power, float g, bool reverse=false){
 
     //应用补偿后的功率到左右电机
     Run_Ctrl(final_power+ turnpower,final_power -turnpower);
+    control_wait(tick); //等待下一个10ms节拍(快照每节拍更新一次, vg 为每节拍的角度变化)
   }
   RunStop(brake);
+  motion_end();
+  return meter.finish(reached);
 }
 /**
  * @brief 单距离传感器辅助直线行驶(陀螺仪PD控制,无测距仪纠偏)
@@ -1224,8 +1510,11 @@ void FAuto_Run_gyro(double dis , double power, float g, bool reverse=false){
  * @param g 目标角度(陀螺仪目标值)
  * @param sensor_id 指定使用的测距仪(1:Distance1, 2:Distance2)
  * @param reverse 是否反向行驶(true:后退/远离, false:前进/靠近)
+ * @return 运动结果(motion_result.h), 误差为距目标距离的毫米数, 越过目标为负
  */
-void Dis_Run_gyro(double dis, double power, float g, int sensor_id, bool reverse=false){
+MotionResult Dis_Run_gyro(double dis, double power, float g, int sensor_id, bool reverse=false){
+  motion_begin(false);
+  MotionWatch watch("Dis_Run_gyro");
   g=Side*g+Start; //根据场地方向调整目标角度
   
   //PID参数
@@ -1236,17 +1525,18 @@ void Dis_Run_gyro(double dis, double power, float g, int sensor_id, bool reverse
   float vg = 0;//角速度差
   float turnpower;//转向补偿功率
   float gyro_lasterror;//上一次角度误差
-  float gyro_err = g - Gyro.rotation(degrees) ;//陀螺仪当前与目标差值
+  float gyro_err = g - sensors().heading ;//陀螺仪当前与目标差值
 
   gyro_lasterror = gyro_err;
-  float Timer=Brain.timer(timeUnits::sec);
+  uint64_t Timer=clock_us();
+  unsigned int tick = control_tick;
   float timeout;
   
   // 计算初始距离用于超时判断
   double start_dist = 9999;
   
-  if(sensor_id == 1) start_dist = Distance1.objectDistance(distanceUnits::mm);
-  else if(sensor_id == 2) start_dist = Distance2.objectDistance(distanceUnits::mm);
+  if(sensor_id == 1) start_dist = sensors().dist1;
+  else if(sensor_id == 2) start_dist = sensors().dist2;
 
   double total_travel = 0; // 总行驶距离
   bool has_total_travel = false; // 是否已获取总距离
@@ -1262,28 +1552,34 @@ void Dis_Run_gyro(double dis, double power, float g, int sensor_id, bool reverse
   else{
     timeout=fabs((0.1*(start_dist-dis))/power);
   }
+  MotionMeter meter("Dis_Run_gyro", dis, start_dist == 9999 ? 0 : (reverse ? dis - start_dist : start_dist - dis), 10);
+  bool reached = false;
 
-  while((Brain.timer(timeUnits::sec)-Timer)<=timeout+0.5){
+  while(clock_since(Timer)<=timeout+0.5 && !motion_cancelled()){
+    SensorSnapshot snap = sensors(); //本节拍快照, 一次循环内只取一次
     double current_dist = 9999;
     
-    if(sensor_id == 1) current_dist = Distance1.objectDistance(distanceUnits::mm);
-    else if(sensor_id == 2) current_dist = Distance2.objectDistance(distanceUnits::mm);
+    if(sensor_id == 1) current_dist = snap.dist1;
+    else if(sensor_id == 2) current_dist = snap.dist2;
 
     //检查距离
     if(current_dist != 9999){
+        meter.update(reverse ? dis - current_dist : current_dist - dis);
         if(reverse){
           if(current_dist > dis){
+            reached = true;
             break;
           }
         }
         else{
           if(current_dist < dis){
+            reached = true;
             break;
           }
         }
     }
     //实时更新陀螺仪数据
-    gyro_err = g - Gyro.rotation(degrees) ;
+    gyro_err = g - snap.heading ;
     vg = gyro_err - gyro_lasterror;
     gyro_lasterror = gyro_err;
     
@@ -1309,7 +1605,7 @@ void Dis_Run_gyro(double dis, double power, float g, int sensor_id, bool reverse
                // 线性减速
                current_power = current_power * (dist_err / decel_dist);
            }
-           if(current_power < motor_min_speed) current_power = motor_min_speed; // 最小速度限制
+           if(current_power < drive_creep_power(power)) current_power = drive_creep_power(power); // 最低爬行功率(前馈模型)
        }
     }
     
@@ -1318,8 +1614,11 @@ void Dis_Run_gyro(double dis, double power, float g, int sensor_id, bool reverse
 
     //应用补偿后的功率到左右电机(无测距仪纠偏)
     Run_Ctrl(final_power+ turnpower,final_power -turnpower);
+    control_wait(tick); //等待下一个10ms节拍
   }
   RunStop(brake);
+  motion_end();
+  return meter.finish(reached);
 }
 ///////////////////////////////////////////////////////////////////////////////////
 
@@ -1340,12 +1639,16 @@ float reduce_negative_180_to_180(float angle) {
  * @param target 目标角度
  * 使用自适应PID算法,根据误差大小动态调整参数
  * 大角度转向使用较小kp,小角度精调使用较大kp
+ * @return 运动结果(motion_result.h)
  */
-void Turn_Gyro(float target)
+MotionResult Turn_Gyro(float target)
 {
+   TraceSpan span("Turn_Gyro", (int)target);
+   motion_begin(false);
+   MotionWatch watch("Turn_Gyro");
    now=target;
    target=Side*target+Start; //根据场地方向调整目标角度
-   float error = reduce_negative_180_to_180(target - Gyro.rotation(degrees)); //最短路径误差计算
+   float error = reduce_negative_180_to_180(target - sensors().heading); //最短路径误差计算
    
    //PD参数(kp/kd在循环内根据误差动态调整)
    float kp, kd;
@@ -1356,20 +1659,26 @@ void Turn_Gyro(float target)
    float lasterror;   //上一次角度误差
    float V= 0;        //角速度(微分项)
    
-   float Time=Brain.timer(timeUnits::sec);
+   uint64_t Time=clock_us();
    float timeout=fabs(error/50); //根据角度计算超时时间
    if (timeout>3 || timeout!=timeout) timeout=3; // 上限3秒,避免占满自动阶段; NaN时也用3
    float pow;         //实际输出功率
    
    float time_settled = 0; //新增：稳定计时器
    float settle_time_req = 200; //新增：稳定时间要求(ms)
+   unsigned int tick = control_tick; //执行器节拍
+   float dt = CONTROL_DT; //两次快照的实际间隔
+   MotionMeter meter("Turn_Gyro", now, error, errortolerance); //运动结果统计
+   bool settled = false;
 
    lasterror = error;
    
-   while (true)
+   while (!motion_cancelled())
    {
-    error = reduce_negative_180_to_180(target - Gyro.rotation(degrees)); //最短路径误差计算
-    V = error - lasterror; //计算角速度(微分)
+    SensorSnapshot snap = sensors(); //本节拍快照, 一次循环内只取一次
+    error = reduce_negative_180_to_180(target - snap.heading); //最短路径误差计算
+    meter.update(error);
+    V = (error - lasterror) * CONTROL_DT / dt; //计算角速度(微分, 按10ms节拍折算)
     lasterror = error;
 
   // 自适应kp/kd：调整以减少过冲和振荡
@@ -1381,22 +1690,28 @@ void Turn_Gyro(float target)
     
     //PD计算输出功率
    pow = kp * error + kd * V;
-   pow = fabs(pow) > lim ? sgn(pow) * lim : pow; //功率限幅
    
-   // 最低功率保底：只在误差较大时提供，误差很小时允许0功率，依靠动能和I/D项（如果有的话）自然停止，防止ping-pong
-   if (fabs(pow) < 12 && fabs(error) > 1.5) {
-       pow = sgn(pow) * 12; // 稍微降低最低功率从15到12
-   } else if (fabs(error) <= 1.5 && fabs(pow) < 5) {
+   // 静摩擦前馈：误差较大时按误差方向叠加原地转向的 kS(取代原 12 功率保底)，
+   // 不改变 PD 输出的方向，D 项刹车时不会被抬成同向推力，防止ping-pong
+   // 模型未拟合时沿用原最低功率保底 12
+   if (fabs(error) > 1.5) {
+       if (!drive_ff_fitted) {
+           if (fabs(pow) < FF_LEGACY_TURN_MIN) pow = sgn(pow) * FF_LEGACY_TURN_MIN;
+       } else if (pow * error > 0) {
+           pow += ff_turn_static(error);
+       }
+   } else if (fabs(pow) < 5) {
        pow = 0; // 误差极小时，如果计算功率很小，直接给0，依靠稳定时间退出
    }
+   pow = fabs(pow) > lim ? sgn(pow) * lim : pow; //功率限幅(含前馈)
 
     // 写入全局变量供测试日志读取
     current_telemetry.action = 1;
     current_telemetry.target = target;
-    current_telemetry.current = Gyro.rotation(degrees);
+    current_telemetry.current = snap.heading;
     current_telemetry.error = error;
     current_telemetry.error_deriv = V;
-    current_telemetry.dt = 0;
+    current_telemetry.dt = dt;
     current_telemetry.p_out = kp * error;
     current_telemetry.i_out = 0;
     current_telemetry.d_out = kd * V;
@@ -1404,24 +1719,27 @@ void Turn_Gyro(float target)
     current_telemetry.aux_error = 0;
     current_telemetry.aux_deriv = 0;
     current_telemetry.aux_out = 0;
+    telemetry_publish(current_telemetry);
 
     Turn(pow);
     
     // 稳定退出检测 (Settling Logic)
     if (fabs(error) <= errortolerance && fabs(V) <= dtol) {
-        time_settled += 10;
+        time_settled += dt * 1000;
     } else {
         time_settled = 0;
     }
 
-    if (time_settled >= settle_time_req || (Brain.timer(timeUnits::sec) - Time) >= timeout + 1) {
+    settled = time_settled >= settle_time_req;
+    if (settled || clock_since(Time) >= timeout + 1) {
         break;
     }
     
-    wait(10,msec);
+    dt = control_wait(tick);
   }
    RunStop(brake);
-
+   motion_end();
+   return meter.finish(settled);
 }
 
 /**
@@ -1429,9 +1747,14 @@ void Turn_Gyro(float target)
  * @param target 目标角度
  * 引入完整的PID控制，带抗积分饱和(start_i)、过零清空、稳定的Settle退出机制
  * 解决转向过冲、最后几度卡死、高频抖动等问题
+ * @return 运动结果(motion_result.h)
  */
-void Turn_Gyro_new(float target)
+MotionResult Turn_Gyro_new(float target)
 {
+   TraceSpan span("Turn_Gyro_new", (int)target);
+   bool chained = motion_begin();
+   MotionWatch watch("Turn_Gyro_new");
+   float chain_exit = chain_exit_error(CHAIN_TURN_EXIT);
    now = target;
    target = Side * target + Start; //根据场地方向调整目标角度
    
@@ -1448,22 +1771,23 @@ void Turn_Gyro_new(float target)
    // ===================================================
    
    float accumulated_error = 0;
-   float previous_error = reduce_negative_180_to_180(target - Gyro.rotation(degrees));
+   float previous_error = reduce_negative_180_to_180(target - sensors().heading);
+   float initial_error = previous_error; // 用于计算进度
    
    float time_spent_settled = 0;
    float time_spent_running = 0;
    
-   // 引入真实的计时器来计算 dt，解决 D 项失效问题
-   float last_time = Brain.timer(timeUnits::msec);
+   // dt 为两次快照的实际采样间隔(control_wait 返回, 微秒精度), D 项按真实时间求导
+   unsigned int tick = control_tick;
+   float dt = CONTROL_DT;
+   MotionMeter meter("Turn_Gyro_new", now, initial_error, settle_error);
+   bool settled = false, chain_hit = false;
    
-   while (true)
+   while (!motion_cancelled())
    {
-       float current_time = Brain.timer(timeUnits::msec);
-       float dt = (current_time - last_time) / 1000.0; // 转换为秒
-       if (dt <= 0.001) dt = 0.01; // 防止除零错误
-       last_time = current_time;
-
-       float error = reduce_negative_180_to_180(target - Gyro.rotation(degrees));
+       float error = reduce_negative_180_to_180(target - sensors().heading);
+       motion_progress(fabs(initial_error) - fabs(error), fabs(initial_error));
+       meter.update(error);
        
        // 1. 积分分离 (Integral windup prevention)
        if (fabs(error) < start_i) {
@@ -1483,6 +1807,10 @@ void Turn_Gyro_new(float target)
        float i_out = ki * accumulated_error;
        float d_out = kd * error_deriv;
        float output = p_out + i_out + d_out;
+       // 静摩擦前馈: 未进入稳定误差时按误差方向补 kS, 积分项只需处理模型残差(模型未拟合时不补)
+       if (drive_ff_fitted && fabs(error) > settle_error && output * error > 0) {
+           output += ff_turn_static(error);
+       }
        
        previous_error = error;
        
@@ -1494,7 +1822,7 @@ void Turn_Gyro_new(float target)
        // 写入全局变量供测试日志读取
        current_telemetry.action = 1;
        current_telemetry.target = target;
-       current_telemetry.current = Gyro.rotation(degrees);
+       current_telemetry.current = sensors().heading;
        current_telemetry.error = error;
        current_telemetry.error_deriv = error_deriv;
        current_telemetry.dt = dt;
@@ -1505,6 +1833,7 @@ void Turn_Gyro_new(float target)
        current_telemetry.aux_error = 0;
        current_telemetry.aux_deriv = 0;
        current_telemetry.aux_out = 0;
+       telemetry_publish(current_telemetry);
 
        // 6. 应用到底盘电机
        Turn(output);
@@ -1520,16 +1849,25 @@ void Turn_Gyro_new(float target)
        
        // 8. 退出判断
        if (time_spent_settled >= settle_time) {
+           settled = true;
            break; 
        }
        if (time_spent_running >= timeout && timeout != 0) {
+           capture_trigger(CAPTURE_JAR_TIMEOUT, error);
            break; 
        }
+       // 链式运动: 进入宽松误差即退出, 不等稳定
+       if (chained && fabs(error) < chain_exit) {
+           chain_hit = true;
+           break;
+       }
        
-       wait(10, msec);
+       dt = control_wait(tick);
    }
    
-   RunStop(brake);
+   if (motion_should_stop()) RunStop(brake);
+   motion_end(); // 原地转向没有直线速度, 交给下一段的输出和剩余距离都是 0
+   return meter.finish(settled, chain_hit);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1559,7 +1897,7 @@ void Anchor_Lock(bool enable)
     }
     
     // 计算航向误差
-    float current_heading = Gyro.rotation(degrees);
+    float current_heading = sensors().heading;
     float error = anchor_target_heading - current_heading;
     
     // P控制计算输出（只控制转向，不控制平移）
@@ -1581,12 +1919,7 @@ void Anchor_Lock(bool enable)
     
     // 输出到左右电机（差速转向）
     // 左转: 左负右正, 右转: 左正右负
-    m(LeftRun_1, (int)turn_power);
-    m(LeftRun_2, (int)turn_power);
-    m(LeftRun_3, (int)turn_power);
-    m(RightRun_1, (int)(-turn_power));
-    m(RightRun_2, (int)(-turn_power));
-    m(RightRun_3, (int)(-turn_power));
+    Run_Ctrl((int)turn_power, (int)(-turn_power));
 }
 
 /**
@@ -1595,7 +1928,18 @@ void Anchor_Lock(bool enable)
  */
 void Anchor_SetTarget()
 {
-    anchor_target_heading = Gyro.rotation(degrees);
+    anchor_target_heading = sensors().heading;
+}
+
+bool anchor_enabled = false; // 航向锁定是否激活(由手柄线程设置)
+
+/**
+ * @brief 航向锁定的执行器回调, 注册后每个 10ms 节拍调用一次
+ * @param dt 控制周期(秒), P控制不使用
+ */
+void Anchor_Job(float dt)
+{
+    Anchor_Lock(anchor_enabled);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -1604,12 +1948,15 @@ void Anchor_SetTarget()
  * @param target 目标角度
  * 通过控制单侧电机实现转向,转弯半径较大
  * target>0时控制左侧, target<0时控制右侧
+ * @return 运动结果(motion_result.h)
  */
-void Turn_Side(float target)
+MotionResult Turn_Side(float target)
 {
+   motion_begin(false);
+   MotionWatch watch("Turn_Side");
    now=target;
    target=Side*target+Start; //根据场地方向调整
-   float error = target - Gyro.rotation(degrees) ;//与目标角度距离
+   float error = target - sensors().heading ;//与目标角度距离
    
    //PD参数
    float kp =5;    //比例系数
@@ -1621,28 +1968,36 @@ void Turn_Side(float target)
    float lasterror;   //上一次角度误差
    float V= 0;        //角速度
    bool arrived;      //到达标志
-   float Time=Brain.timer(timeUnits::sec);
+   uint64_t Time=clock_us();
    float timeout=fabs(error/50);
    float pow;         //输出功率
    
    lasterror = error;
    arrived = error == 0;
+   unsigned int tick = control_tick; //执行器节拍
+   float dt = CONTROL_DT; //两次快照的实际间隔
+   MotionMeter meter("Turn_Side", now, error, errortolerance); //运动结果统计
+   bool timed_out = false;
    
-   while (!arrived)
+   while (!arrived && !motion_cancelled())
    {
-    error = target - Gyro.rotation(degrees) ;
-    V = error - lasterror; //计算角速度
+    SensorSnapshot snap = sensors(); //本节拍快照
+    error = target - snap.heading ;
+    meter.update(error);
+    V = (error - lasterror) * CONTROL_DT / dt; //计算角速度(按10ms节拍折算)
     lasterror = error;
     
     //提前退出判断
     if (fabs(error)<3)
     {
-      if(RightRun_1.velocity(velocityUnits::rpm)<3||LeftRun_1.velocity(velocityUnits::rpm)<3){break;}
+      if(snap.right_vel<3||snap.left_vel<3){break;}
     }
     
     //到达判断
-    if ((fabs(error) <= errortolerance && fabs(V) <= dtol) || (Brain.timer(timeUnits::sec)-Time)>=timeout+1)
+    if (fabs(error) <= errortolerance && fabs(V) <= dtol)
     {arrived = true;}
+    else if (clock_since(Time)>=timeout+1)
+    {arrived = timed_out = true;}
     
     //PD计算
     pow = kp * error + kd * V;
@@ -1654,10 +2009,11 @@ void Turn_Side(float target)
     else
     {Right_Ctrl(pow);} //右转(控制左侧电机)
     lasterror = error;
-    wait(10,msec);
+    dt = control_wait(tick);
   }
    RunStop(brake);
-
+   motion_end();
+   return meter.finish(!timed_out);
 }
 ///////////////////////////////////////
 /**
@@ -1666,25 +2022,38 @@ void Turn_Side(float target)
  * @param timeout 超时时间(毫秒)
  * @param err 允许的角度偏离误差
  * 当角度偏离超过err度时提前停止,防止卡死
+ * @return 运动结果(motion_result.h), 误差为相对进入时朝向的偏离量(度);
+ *         顶满 timeout 记为 settled, 偏离过大提前退出记为 timeout
  */
-void Run_wall(int spd,float timeout,int err)
+MotionResult Run_wall(int spd,float timeout,int err)
 {
-  float Time_1=Brain.timer(timeUnits::sec);
-  float ref = Gyro.rotation(degrees);  // 以进入时的当前朝向为直线参考,不依赖上一动是否到位
-  while((Brain.timer(timeUnits::sec)-Time_1<=timeout/1000))
+  TraceSpan span("Run_wall", spd);
+  motion_begin(false);
+  MotionWatch watch("Run_wall", timeout + WATCHDOG_MARGIN_MS, true);
+  uint64_t Time_1=clock_us();
+  float ref = sensors().heading;  // 以进入时的当前朝向为直线参考,不依赖上一动是否到位
+  unsigned int tick = control_tick;
+  MotionMeter meter("Run_wall", spd, 0, err);
+  bool deviated = false;
+  while(clock_since(Time_1)<=timeout/1000 && !motion_cancelled())
   {
     //检测角度偏离(相对进入时的朝向)
-    if (fabs(Gyro.rotation(degrees) - ref) > err)
+    float drift = fabs(sensors().heading - ref); //本节拍快照
+    meter.update(drift);
+    if (drift > err)
     {
+      deviated = true;
       break; //偏离过大,退出
     }
     else
     {
     Run(spd);
-    //wait(10,msec);
     }
+    control_wait(tick); //等待下一个10ms节拍
   }
   RunStop(brake);
+  motion_end();
+  return meter.finish(!deviated);
 }
 
 /////////////////////////////////////////////////////////////////////////
@@ -1693,32 +2062,45 @@ void Run_wall(int spd,float timeout,int err)
  * @param turnspd 转弯速度
  * @param encode 目标编码器值(度)
  * 使用编码器反馈实现固定角度转弯
+ * @return 运动结果(motion_result.h), 误差为剩余编码器度数
  */
-void Turnencode(int turnspd,int encode)
+MotionResult Turnencode(int turnspd,int encode)
 {
    // Turn(3,10*Side*abs(encode)/encode);
     //task::sleep(100);
+    motion_begin(false);
+    MotionWatch watch("Turnencode");
     RunStop(coast);
-    LeftRun_1.resetPosition();
-    RightRun_1.resetPosition();
-    while(1)
+    SensorSnapshot snap = sensors();
+    float left0 = snap.left_pos;  //起点编码器值
+    float right0 = snap.right_pos;
+    MotionMeter meter("Turnencode", encode, abs(encode), 2);
+    bool arrived = false;
+    unsigned int tick = control_tick; //执行器节拍
+    while(!motion_cancelled())
 	{
+    snap = sensors(); //本节拍快照
     //检查是否到达目标编码器值
-    if (((abs(LeftRun_1.position(rotationUnits::deg))+abs(RightRun_1.position(rotationUnits::deg)))/2)<abs(encode))
+    float menc = (fabs(snap.left_pos - left0)+fabs(snap.right_pos - right0))/2;
+    meter.update(abs(encode) - menc);
+    if (menc<abs(encode))
     {
      Turn((Side*abs(encode)/encode)*turnspd); //根据方向和编码器正负号确定转向
     }
     else
     {
      RunStop(brake);
+     arrived = true;
      break;
     }
-
+    control_wait(tick); //等待下一个10ms节拍
     }
     RunStop(brake);
     // task::sleep(100);
     // RunStop(coast);
     //  task::sleep(100);
+    motion_end();
+    return meter.finish(arrived);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1727,32 +2109,44 @@ void Turnencode(int turnspd,int encode)
  * @param speed 行驶速度(-100到100)
  * @param encode 目标编码器值(度)
  * 使用编码器反馈实现固定距离行驶,带超时保护
+ * @return 运动结果(motion_result.h), 误差为剩余编码器度数
  */
-void Runencode(int speed,int encode)
+MotionResult Runencode(int speed,int encode)
 {
     //Brain.resetTimer();
-    LeftRun_1.resetPosition();
-    RightRun_1.resetPosition();
+    motion_begin(false);
+    MotionWatch watch("Runencode");
+    SensorSnapshot snap = sensors();
+    float left0 = snap.left_pos;  //起点编码器值
+    float right0 = snap.right_pos;
 
-    float Timer=Brain.timer(timeUnits::sec);
+    uint64_t Timer=clock_us();
     float timeout=fabs((0.1*encode)/speed); //根据距离和速度计算超时时间
+    MotionMeter meter("Runencode", encode, abs(encode), 2);
+    bool arrived = false;
+    unsigned int tick = control_tick; //执行器节拍
     
-	while((Brain.timer(timeUnits::sec)-Timer)<=timeout+1)
+	while(clock_since(Timer)<=timeout+1 && !motion_cancelled())
 	{
+    snap = sensors(); //本节拍快照
     //检查是否到达目标编码器值
-    if (((abs(LeftRun_1.position(rotationUnits::deg))+abs(RightRun_1.position(rotationUnits::deg)))/2)<abs(encode))
+    float menc = (fabs(snap.left_pos - left0)+fabs(snap.right_pos - right0))/2;
+    meter.update(abs(encode) - menc);
+    if (menc<abs(encode))
 		{
 			Run_V5(speed,speed); //继续前进
 		}
 
 	  else
 		{
+			arrived = true;
 			break; //到达目标,退出循环
 		}
-
+    control_wait(tick); //等待下一个10ms节拍
 	}
     RunStop(brake);
-
+    motion_end();
+    return meter.finish(arrived);
 }
 ///////////////////////////////////////////////////////////////////////////////
 // 视觉传感器跟踪函数
@@ -1929,9 +2323,9 @@ int Print(){
       
       //显示陀螺仪角度
       Controller1.Screen.setCursor(3,8);
-      Controller1.Screen.print ("Gyro=%5.2f",Gyro.rotation(degrees));
+      Controller1.Screen.print ("Gyro=%5.2f",sensors().heading);
 
-    wait(50, msec); //刷新间隔50ms
+    task_wait("print", 50); //刷新间隔50ms
   }
 }
 
@@ -2250,6 +2644,11 @@ int AutoScreen()
   if (button==1){
   while(button==1){ //循环等待用户选择
     Auto_Ctrl(); //处理选择逻辑
+    //按手柄 X 进入球颜色标定(手柄屏幕提示, A 键开始每一段), 完成后回到选择界面
+    if(Controller1.ButtonX.pressing()){
+      while(Controller1.ButtonX.pressing()) wait(20,msec);
+      calibrate_ball_colors();
+    }
     //Auto_Controller_Choose();
     /*Controller1.Screen.clearLine(3);
     Controller1.Screen.setCursor(3,1);
@@ -2327,7 +2726,7 @@ int AutoScreen()
   double Ball_temperature=0;
   while(1){
     Brain.Screen.clearScreen();
-    base_motor_temperature=(LeftRun_1.temperature(temperatureUnits::celsius)+LeftRun_2.temperature(temperatureUnits::celsius)+LeftRun_3.temperature(temperatureUnits::celsius)+RightRun_1.temperature(temperatureUnits::celsius)+RightRun_2.temperature(temperatureUnits::celsius)+RightRun_3.temperature(temperatureUnits::celsius))/6;
+    base_motor_temperature=(drive_left.temperature()+drive_right.temperature())/2;
     Intake_temperature=Intake_1.temperature(temperatureUnits::celsius);
     Shoot_temperature=Shoot_1.temperature(temperatureUnits::celsius);
     Ball_temperature=Ball_1.temperature(temperatureUnits::celsius);
@@ -2361,44 +2760,32 @@ const int TEST_LOG_MAX = 2000; // 最大日志条目数
 TestLogEntry test_log_buf[TEST_LOG_MAX];
 int test_log_count = 0; // 当前已存条目数
 
+uint64_t test_log_start_us = 0;     // 本次日志起点(微秒)
+const int TEST_LOG_BATCH = 32;      // 日志任务每次最多取出的样本数
+const int TEST_LOG_PERIOD_MS = 50;  // 日志任务取样本的间隔
+
 /**
- * @brief 统一测试日志任务 — 仅采集数据到缓冲区,不做串口输出
+ * @brief 统一测试日志任务 — 按批取出遥测环里的样本存入缓冲区,不做串口输出
+ * 停止标志清除后把环里剩下的样本取完再退出
  * @return 0
  */
 int test_log_task_fn()
 {
-  float start_time = Brain.timer(timeUnits::msec);
-  test_log_count = 0; // 清零计数器
-
-  while(test_log_active && test_log_count < TEST_LOG_MAX)
+  TelemetrySample batch[TEST_LOG_BATCH];
+  while(test_log_count < TEST_LOG_MAX)
   {
-    // 从电机实时采样左右侧均速(取绝对值)
-    float l1 = fabs(LeftRun_1.velocity(velocityUnits::rpm));
-    float l2 = fabs(LeftRun_2.velocity(velocityUnits::rpm));
-    float l3 = fabs(LeftRun_3.velocity(velocityUnits::rpm));
-    float r1 = fabs(RightRun_1.velocity(velocityUnits::rpm));
-    float r2 = fabs(RightRun_2.velocity(velocityUnits::rpm));
-    float r3 = fabs(RightRun_3.velocity(velocityUnits::rpm));
-
-    float t = (Brain.timer(timeUnits::msec) - start_time) / 1000.0;
-    TestLogEntry &e = test_log_buf[test_log_count];
-    e.time_s = t;
-    e.left_avg  = (l1 + l2 + l3) / 3.0;
-    e.right_avg = (r1 + r2 + r3) / 3.0;
-    
-    // 如果是纯测速模式(action==99)，才覆盖(原本是3,和JAR直线冲突了)
-    if (current_telemetry.action == 99) {
-      float avg_abs_rpm = (l1 + l2 + l3 + r1 + r2 + r3) / 6.0;
-      float theoretical_rpm = 200.0 * current_telemetry.target / 100.0;
-      current_telemetry.current = avg_abs_rpm;
-      current_telemetry.error = avg_abs_rpm - theoretical_rpm;
+    bool active = test_log_active;
+    int n = telemetry_drain(batch, TEST_LOG_BATCH);
+    for (int i = 0; i < n && test_log_count < TEST_LOG_MAX; i++) {
+      TelemetrySample &s = batch[i];
+      TestLogEntry &e = test_log_buf[test_log_count++];
+      e.time_s = (int64_t)(s.time_us - test_log_start_us) / 1e6;
+      e.left_avg = s.left_avg;
+      e.right_avg = s.right_avg;
+      e.t = s.t;
     }
-
-    // 直接复制当前所有数据
-    e.t = current_telemetry;
-
-    test_log_count++;
-    vex::task::sleep(20); // 统一20ms高频采样
+    if (!active && n == 0) break;
+    if (n < TEST_LOG_BATCH) task_wait("test_log", TEST_LOG_PERIOD_MS);
   }
   return 0;
 }
@@ -2406,48 +2793,80 @@ int test_log_task_fn()
 task test_log_task_handle;
 
 /**
- * @brief 将缓冲区中的日志数据通过串口一次性输出(跑完后调用)
+ * @brief 开始记录: 清空缓冲区, 丢弃开始前遗留在遥测环里的样本, 启动日志任务
+ * 日志任务尚未运行, 这里代为消费者移动 tail
  */
-void test_log_dump()
+void test_log_start()
+{
+  telemetry_tail = telemetry_head;
+  telemetry_dropped = 0;
+  test_log_count = 0;
+  test_log_start_us = clock_us();
+  test_log_active = true;
+  test_log_task_handle = task(test_log_task_fn);
+}
+
+// 日志模式: 字段与 CSV 时代的 telemetry_v1 一致, 比例对应原 printf 的小数位数
+const int TELEMETRY_FIELDS_N = 17;
+const char *const TELEMETRY_FIELDS[TELEMETRY_FIELDS_N] = {
+  "time_s", "left_avg", "right_avg", "action", "target", "current", "error", "error_deriv", "dt",
+  "p_out", "i_out", "d_out", "total_out", "aux_error", "aux_deriv", "aux_out", "gyro_pitch"};
+const int TELEMETRY_SCALES[TELEMETRY_FIELDS_N] = {
+  100000, 10, 10, 1, 100, 100, 100, 1000, 1000000,
+  100, 100, 100, 100, 100, 1000, 100, 100};
+const LogSchema telemetry_schema = {"telemetry_v1", TELEMETRY_FIELDS_N, TELEMETRY_FIELDS, TELEMETRY_SCALES};
+
+unsigned int test_log_frames = 0;     // 本次输出的帧数
+
+void test_log_emit(const LogFrame &f)
+{
+  link_send(f);
+  test_log_frames++;
+}
+
+/**
+ * @brief 通过串口输出一段日志条目(telemetry_v2 块)
+ * 二进制帧编码(log_codec.h), 每帧 8 个样本一行; 2000 个样本约 6 秒输出完,
+ * 原 CSV 逐行限速需要 3 分钟以上。上位机 plot.py/app.py 按 telemetry_v2 块解码。
+ * 帧经 log_link.h 发送: 上位机运行 serial_rx.py 时逐帧确认、缺帧重发, 按窗口全速输出;
+ * 没有接收程序时退回限速输出。
+ * @param dropped 采集时丢弃的样本数(写进结束行)
+ */
+void log_dump_entries(const TestLogEntry *entries, int count, unsigned int dropped)
 {
-  // USB CDC 防丢策略: 60ms行间延迟 + 每8行300ms排空暂停
-  const int LINE_DELAY  = 60;   
-  const int CHUNK_SIZE  = 8;    
-  const int CHUNK_PAUSE = 300;  
-
-  // 输出统一CSV表头
-  vex::task::sleep(100); 
-  printf("telemetry_v1\n");
-  vex::task::sleep(LINE_DELAY);
-  printf("time_s,left_avg,right_avg,action,target,current,error,error_deriv,dt,p_out,i_out,d_out,total_out,aux_error,aux_deriv,aux_out,gyro_pitch\n");
-  vex::task::sleep(LINE_DELAY);
-
-  // 逐行输出所有缓冲数据, 分块限速
-  for(int i = 0; i < test_log_count; i++)
+  vex::task::sleep(100);
+  printf("telemetry_v2\n");
+  test_log_frames = 0;
+  LogEncoder enc;
+  link_begin();
+  log_encoder_begin(enc, telemetry_schema, test_log_emit);
+  for(int i = 0; i < count; i++)
   {
-    TestLogEntry &e = test_log_buf[i];
-    
-    printf("%.3f,%.1f,%.1f,%d,%.2f,%.2f,%.2f,%.3f,%.4f,%.2f,%.2f,%.2f,%.2f,%.2f,%.3f,%.2f,%.2f\n",
-            e.time_s, e.left_avg, e.right_avg,
-            e.t.action, e.t.target, e.t.current, e.t.error, e.t.error_deriv, e.t.dt,
-            e.t.p_out, e.t.i_out, e.t.d_out, e.t.total_out,
-            e.t.aux_error, e.t.aux_deriv, e.t.aux_out, e.t.gyro_pitch);
-
-    // 分块限速: 每CHUNK_SIZE行做一次长暂停让USB buffer排空
-    if((i + 1) % CHUNK_SIZE == 0)
-      vex::task::sleep(CHUNK_PAUSE);
-    else
-      vex::task::sleep(LINE_DELAY);
+    const TestLogEntry &e = entries[i];
+    float row[TELEMETRY_FIELDS_N] = {
+      e.time_s, e.left_avg, e.right_avg,
+      (float)e.t.action, e.t.target, e.t.current, e.t.error, e.t.error_deriv, e.t.dt,
+      e.t.p_out, e.t.i_out, e.t.d_out, e.t.total_out,
+      e.t.aux_error, e.t.aux_deriv, e.t.aux_out, e.t.gyro_pitch};
+    log_encoder_add(enc, row);
   }
+  log_encoder_finish(enc);
+  bool acked = link_end();
 
-  // 尾部: 等USB buffer完全排空后再输出footer
-  vex::task::sleep(500);
-  printf("\n");
-  vex::task::sleep(LINE_DELAY);
-  printf("--- log end (total %d samples) ---\n", test_log_count);
+  vex::task::sleep(100);
+  printf("--- log end (total %d samples, dropped %u, frames %u, link %s, resent %u) ---\n",
+         count, dropped, test_log_frames, acked ? "acked" : "paced", log_link.resent);
   vex::task::sleep(200);
 }
 
+/**
+ * @brief 将缓冲区中的日志数据通过串口一次性输出(跑完后调用)
+ */
+void test_log_dump()
+{
+  log_dump_entries(test_log_buf, test_log_count, telemetry_dropped);
+}
+
 /**
  * @brief 单侧转向测试函数 (含遥测日志)
  * 自动测试左侧转向和右侧转向，并将遥测数据写入缓冲区以供导出分析。
@@ -2455,14 +2874,13 @@ void test_log_dump()
 void test_turn_side()
 {
   Side = 1; 
-  Start = Gyro.rotation(degrees);
+  Start = sensors().heading;
 
   // === 动作1: 左侧向前 (右侧锁死，向右转) ===
   float target1 = Start + 90.0; 
   current_telemetry = {0};
   printf("test_turn_side (1. Left forward, target=%.1f)\n", target1);
-  test_log_active = true;
-  test_log_task_handle = task(test_log_task_fn);
+  test_log_start();
   vex::task::sleep(50);
   
   turn_side_JAR(target1, left); // left = 动左侧
@@ -2478,8 +2896,7 @@ void test_turn_side()
   float target2 = Start; 
   current_telemetry = {0};
   printf("test_turn_side (2. Left backward, target=%.1f)\n", target2);
-  test_log_active = true;
-  test_log_task_handle = task(test_log_task_fn);
+  test_log_start();
   vex::task::sleep(50);
   
   turn_side_JAR(target2, left); 
@@ -2495,8 +2912,7 @@ void test_turn_side()
   float target3 = Start - 90.0; 
   current_telemetry = {0};
   printf("test_turn_side (3. Right forward, target=%.1f)\n", target3);
-  test_log_active = true;
-  test_log_task_handle = task(test_log_task_fn);
+  test_log_start();
   vex::task::sleep(50);
   
   turn_side_JAR(target3, right); // right = 动右侧
@@ -2512,8 +2928,7 @@ void test_turn_side()
   float target4 = Start; 
   current_telemetry = {0};
   printf("test_turn_side (4. Right backward, target=%.1f)\n", target4);
-  test_log_active = true;
-  test_log_task_handle = task(test_log_task_fn);
+  test_log_start();
   vex::task::sleep(50);
   
   turn_side_JAR(target4, right); 
@@ -2545,14 +2960,13 @@ void test_straight(double enc, float g=0, bool use_jar = true)
 {
   double dist = fabs(enc);
   now = 0;
-  Start = Gyro.rotation(degrees);
+  Start = sensors().heading;
 
   current_telemetry = {0};
   if(use_jar) printf("test_straight_JAR_forward\n");
   else printf("test_straight_v2_forward\n");
   
-  test_log_active = true;
-  test_log_task_handle = task(test_log_task_fn);
+  test_log_start();
   
   if(use_jar) run_gyro_JAR(enc, g);
   else Run_gyro_new(dist, g);
@@ -2567,8 +2981,7 @@ void test_straight(double enc, float g=0, bool use_jar = true)
   if(use_jar) printf("test_straight_JAR_backward\n");
   else printf("test_straight_v2_backward\n");
   
-  test_log_active = true;
-  test_log_task_handle = task(test_log_task_fn);
+  test_log_start();
   
   if(use_jar) run_gyro_JAR(-enc, 0);
   else Run_gyro_new(-dist, 0);
@@ -2580,6 +2993,52 @@ void test_straight(double enc, float g=0, bool use_jar = true)
   vex::task::sleep(500);
 }
 
+/**
+ * @brief S 曲线直线测试函数(含遥测日志)
+ * @param enc 目标编码器值(度), 先前进再后退同距离
+ *
+ * 每段结束后刹停 300ms 再读编码器, 输出一行汇总:
+ * profile: enc=.. plan=曲线时间 time=实际用时 final_err=最终误差 overshoot=最大过冲
+ * 最终误差需落在 drive_profile.settle_error 以内
+ */
+void test_profile(double enc)
+{
+  now = 0;
+  Start = sensors().heading;
+
+  for (int dir = 1; dir >= -1; dir -= 2)
+  {
+    double target = dir * fabs(enc);
+    MotionProfile plan;
+    plan.plan(target, drive_profile.max_vel, drive_profile.max_accel, drive_profile.max_jerk);
+
+    current_telemetry = {0};
+    printf("test_profile_%s\n", dir > 0 ? "forward" : "backward");
+    test_log_start();
+
+    float enc0 = drive_position();
+    unsigned int t0 = timer::system();
+    run_gyro_profile(target, 0);
+    unsigned int t1 = timer::system();
+
+    test_log_active = false;
+    vex::task::sleep(300);
+    float pos = drive_position() - enc0;
+
+    // 过冲: 越过目标的最大距离(日志中 current 的极值)
+    float overshoot = 0;
+    for (int i = 0; i < test_log_count; i++) {
+      float over = (test_log_buf[i].t.current - target) * dir;
+      if (over > overshoot) overshoot = over;
+    }
+
+    test_log_dump();
+    printf("profile: enc=%.0f plan=%.3fs time=%.3fs final_err=%.2f overshoot=%.2f\n",
+           target, plan.total_time, (t1 - t0) / 1000.0, target - pos, overshoot);
+    vex::task::sleep(500);
+  }
+}
+
 /**
  * @brief 转向测试函数(含转向日志)
  * 
@@ -2590,14 +3049,12 @@ void test_straight(double enc, float g=0, bool use_jar = true)
 void test_turn()
 {
   Side=1; 
-  //记录起始角度作为参考
-  float start_angle = Gyro.rotation(degrees);
   
   //从20度开始,每次增加20度,直到180度
   for(int delta = 20; delta <= 180; delta += 20)
   {
     //计算目标角度 = 当前角度 + 角度差
-    float target_angle = Gyro.rotation(degrees) + delta;
+    float target_angle = sensors().heading + delta;
     
     //清零全局日志变量
     current_telemetry = {0};
@@ -2606,8 +3063,7 @@ void test_turn()
     printf("test_turn (delta=%d deg)\n", delta);
 
     //启动日志任务
-    test_log_active = true;
-    test_log_task_handle = task(test_log_task_fn);
+    test_log_start();
     vex::task::sleep(50); // 等待日志任务启动并开始记录
     
     //执行PID转向
@@ -2630,11 +3086,62 @@ void test_turn()
 
 
 /**
- * @brief 最小驱动功率测试函数
- * 
- * 从0%到30%功率,每2%递增,交替前后方向驱动机器人
- * 每次驱动5秒,停止2秒,同时后台日志任务每50ms采集数据
- * 以二维数组格式输出: {{time_s,power,diff},...}
+ * @brief 一段开环电压激励, 同时把样本加入左右两侧的拟合器
+ * @param dir 方向(1 前进, -1 后退)
+ * @param start 起始功率
+ * @param rate 功率斜率(功率/秒), 0 表示阶跃(恒定 start)
+ * @param duration 持续时间(ms)
+ * @param left_fit 左侧该方向的拟合器
+ * @param right_fit 右侧该方向的拟合器
+ *
+ * 每个节拍下发一次功率; 样本取上一节拍下发的功率、两节拍间的平均速度与加速度,
+ * 速度低于 30 度/秒(尚未起步)的样本不参与拟合。结束后刹停并静置 1 秒。
+ */
+void ff_excite(int dir, float start, float rate, int duration, FFFit &left_fit, FFFit &right_fit)
+{
+  unsigned int tick = control_tick;
+  float t = 0, power = 0, dt = CONTROL_DT;
+  float last_l = 0, last_r = 0;
+  bool first = true;
+  while (t * 1000 < duration) {
+    // 两侧速度(度/秒, 按行驶方向取正)
+    float vl = dir * sensors().left_vel * 6;
+    float vr = dir * sensors().right_vel * 6;
+    if (!first) {
+      float al = (vl - last_l) / dt, ar = (vr - last_r) / dt;
+      if ((vl + last_l) / 2 > 30) left_fit.add((vl + last_l) / 2, al, power);
+      if ((vr + last_r) / 2 > 30) right_fit.add((vr + last_r) / 2, ar, power);
+    }
+    first = false;
+    last_l = vl;
+    last_r = vr;
+
+    power = (int)(start + rate * t); // Run_Ctrl 按整数功率下发, 拟合用实际下发值
+    // 测速样本: target 为下发功率, current 为两侧均速, error 为与理论转速之差
+    SensorSnapshot snap = sensors();
+    current_telemetry.target = power;
+    current_telemetry.current = (snap.left_speed + snap.right_speed) / 2;
+    current_telemetry.error = current_telemetry.current - 200.0 * power / 100.0;
+    telemetry_publish(current_telemetry);
+    Run_Ctrl(dir * power, dir * power);
+    dt = control_wait(tick);
+    t += dt;
+  }
+  RunStop(brake);
+  vex::task::sleep(1000);
+}
+
+/**
+ * @brief 底盘前馈特性测试(原最小驱动功率测试)
+ *
+ * 前进、后退各做一遍:
+ * 1. 准静态斜坡: 功率从 0 按 8/秒 升到 48 (6 秒), 主要确定 kS 和 kV
+ * 2. 阶跃: 功率 60 保持 1.2 秒, 起步段的加速度确定 kA
+ * 左右两侧、前进后退分别最小二乘拟合 功率 = kS + kV*v + kA*a, 每组输出一行:
+ * ff: side=left dir=fwd kS=.. kV=.. kA=.. n=样本数
+ * 拟合成功后直接写入 drive_ff, 四组都成功时置 drive_ff_fitted; 需要长期保存时把数值抄回
+ * feedforward.h 并把 drive_ff_fitted 的初值改为 true。
+ * 日志 action=99, target 为当前下发功率。
  */
 void test_minspeed()
 {
@@ -2643,36 +3150,39 @@ void test_minspeed()
 
   //启动日志任务
   current_telemetry = {0};
-  current_telemetry.action = 3;
-  test_log_active = true;
-  test_log_task_handle = task(test_log_task_fn);
+  current_telemetry.action = 99;
+  test_log_start();
 
-  bool forward = true; //第一次往前走
+  FFFit fits[4]; // 左前, 左后, 右前, 右后
+  for (int i = 0; i < 4; i++) fits[i].reset();
 
-  for(float power = 0; power <= 30; power += 2)
-  {
-    current_telemetry.target = power; //更新当前功率,供日志任务读取
-
-    //驱动5秒
-    if(forward)
-      Run_Ctrl(power, power);   //前进
-    else
-      Run_Ctrl(-power, -power);   //后退
-
-    vex::task::sleep(5000);
-
-    //停止2秒
-    RunStop(brake);
-    vex::task::sleep(2000);
-
-    //下一次反方向
-    forward = !forward;
-  }
+  //前进/后退交替, 机器人大致回到出发点
+  ff_excite(1, 0, 8, 6000, fits[0], fits[2]);
+  ff_excite(-1, 0, 8, 6000, fits[1], fits[3]);
+  ff_excite(1, 60, 0, 1200, fits[0], fits[2]);
+  ff_excite(-1, 60, 0, 1200, fits[1], fits[3]);
 
   //停止采集任务
   test_log_active = false;
   vex::task::sleep(100); //等待采集任务退出
 
+  //拟合并写回前馈模型
+  int fitted = 0;
+  FFGains *gains[4] = {&drive_ff.left_fwd, &drive_ff.left_rev, &drive_ff.right_fwd, &drive_ff.right_rev};
+  const char *names[4] = {"side=left dir=fwd", "side=left dir=rev", "side=right dir=fwd", "side=right dir=rev"};
+  for (int i = 0; i < 4; i++) {
+    FFGains g;
+    if (fits[i].solve(g) && g.kS > 0 && g.kV > 0 && g.kA >= 0) {
+      *gains[i] = g;
+      fitted++;
+      printf("ff: %s kS=%.2f kV=%.4f kA=%.4f n=%.0f\n", names[i], g.kS, g.kV, g.kA, fits[i].n);
+    } else {
+      printf("ff: %s fit failed n=%.0f (keep kS=%.2f kV=%.4f kA=%.4f)\n", names[i], fits[i].n,
+             gains[i]->kS, gains[i]->kV, gains[i]->kA);
+    }
+  }
+  if (fitted == 4) drive_ff_fitted = true; //四组都拟合成功后控制器改用前馈模型
+
   //一次性输出所有缓冲数据
   test_log_dump();
   printf("--- test_minspeed complete ---\n");
@@ -2694,8 +3204,8 @@ void test_gyro(float gyro_kp, float gyro_kd)
   Start = Gyro.rotation(degrees);
   float g = Side * 0 + Start;        // 目标角度 = 当前朝向
 
-  LeftRun_1.resetPosition();
-  RightRun_1.resetPosition();
+  float left0 = LeftRun_1.position(deg);  // 起点编码器值
+  float right0 = RightRun_1.position(deg);
 
   // 清零全局日志变量
   current_telemetry = {0};
@@ -2703,25 +3213,22 @@ void test_gyro(float gyro_kp, float gyro_kd)
   printf("test_gyro_pd\n");   // 标识行
 
   // 启动日志采集
-  test_log_active = true;
-  test_log_task_handle = task(test_log_task_fn);
+  test_log_start();
 
   // --- gyro PD 变量（与 Run_gyro_new 一致）---
   float gyro_err = g - Gyro.rotation(degrees);
   float gyro_lasterror = gyro_err;
-  float Timer = Brain.timer(timeUnits::sec);
-  float last_time = Timer;
+  uint64_t Timer = clock_us();
+  uint64_t last_time = Timer;
   float base_power = 50;              // ~100 RPM（V5 自由转速 200 RPM 的 50%）
 
-  while ((Brain.timer(timeUnits::sec) - Timer) <= 3.0)
+  while (clock_since(Timer) <= 3.0)
   {
-    float current_time = Brain.timer(timeUnits::sec);
-    float dt = current_time - last_time;
-    if (dt < 0.002) { vex::task::sleep(1); continue; }
-    last_time = current_time;
+    if (clock_since_us(last_time) < 2000) { vex::task::sleep(1); continue; }
+    float dt = clock_dt(last_time);   // 微秒精度
 
-    float menc = (fabs(LeftRun_1.position(rotationUnits::deg))
-                + fabs(RightRun_1.position(rotationUnits::deg))) / 2;
+    float menc = (fabs(LeftRun_1.position(rotationUnits::deg) - left0)
+                + fabs(RightRun_1.position(rotationUnits::deg) - right0)) / 2;
     gyro_err = g - Gyro.rotation(degrees);
 
     float vg = (gyro_err - gyro_lasterror) / dt;   // °/s
@@ -2742,6 +3249,7 @@ void test_gyro(float gyro_kp, float gyro_kd)
     current_telemetry.aux_error = gyro_err;
     current_telemetry.aux_deriv = vg;
     current_telemetry.aux_out = turnpower;
+    telemetry_publish(current_telemetry);
 
     // 恒压驱动 + gyro 转向补偿
     Run_Ctrl(base_power + turnpower, base_power - turnpower);
@@ -2755,4 +3263,136 @@ void test_gyro(float gyro_kp, float gyro_kd)
   printf("--- test_gyro_pd complete, kp=%.2f, kd=%.3f ---\n", gyro_kp, gyro_kd);
   vex::task::sleep(500); // 块间间隔: 确保complete信息发完且USB buffer排空后再进入下一个test
 }
+/**
+ * @brief 链式衔接测试(motion.h): 两段直线链式相接, 第二段结束后总位移应等于两段目标之和
+ * 第一段在链式误差处提前退出, 剩余距离要加到第二段上, 第二段从当前速度起步
+ * 最后一组在链式直线后接一段不支持链式的 Run_gyro_new: 它不承接, 也不能把剩余距离留给再下一段
+ */
+void test_chain()
+{
+  now = 0;
+  Start = sensors().heading;
+  for (int k = 0; k < 4; k++) {
+    const char *name[4] = {"JAR>JAR", "Run_gyro>JAR", "profile>profile", "JAR>profile"};
+    float enc0 = drive_position();
+    uint64_t t0 = clock_us();
+    chain_next();
+    if (k == 1) Run_gyro(600, 60);
+    else if (k == 2) run_gyro_profile(600);
+    else run_gyro_JAR(600);
+    float left = chain_carry_distance;
+    if (k >= 2) run_gyro_profile(400);
+    else run_gyro_JAR(400);
+    float moved = drive_position() - enc0;
+    printf("chain: %-16s target=1000 moved=%.1f err=%.1f carried=%.1f time=%.2fs\n",
+           name[k], moved, 1000 - moved, left, clock_since(t0));
+    wait(300);
+    run_gyro_JAR(-moved);   // 回到起点
+    wait(300);
+  }
+
+  float enc0 = drive_position();
+  uint64_t t0 = clock_us();
+  chain_next();
+  run_gyro_JAR(600);
+  Run_gyro_new(300);
+  float carry_out = chain_carry_output, carry_dist = chain_carry_distance;
+  float mid = drive_position() - enc0;
+  run_gyro_JAR(400);
+  float last = drive_position() - enc0 - mid;
+  printf("chain: JAR>Run_gyro_new carry_out=%.1f carry_dist=%.1f last_target=400 last_moved=%.1f time=%.2fs\n",
+         carry_out, carry_dist, last, clock_since(t0));
+}
+
+/**
+ * @brief 里程计测试(odom.h): 以当前位置为原点走 直线-原地转向-单侧转向-倒车, 静置后输出位姿
+ * @param pose 输出终点位姿 {x, y, θ}(可为 0), 仿真里与模型真值比较
+ * 输出: odom: x=.. y=.. theta=..
+ */
+void test_odom(float *pose = 0)
+{
+  Side = 1;
+  Start = sensors().heading;
+  now = 0;
+  odom_set_pose(0, 0, 0);
+  run_gyro_JAR(800);
+  Turn_Gyro_new(90);
+  turn_side_JAR(45, left);
+  run_gyro_JAR(-500, 45);
+  wait(300);
+  Pose p = odom_pose();
+  printf("odom: x=%.1f y=%.1f theta=%.2f\n", p.x, p.y, p.theta);
+  if (pose) {
+    pose[0] = p.x;
+    pose[1] = p.y;
+    pose[2] = p.theta;
+  }
+}
+
+/**
+ * @brief 看门狗测试(watchdog.h): 依次跑几段原本会卡住的运动和两段正常运动
+ * Run_gyro 功率为 0(超时为 inf)、Runencode 速度为 0、Turnencode 速度为 0 都应在
+ * idle_ms 左右被结束; 正常的直线和转向不应触发
+ */
+void test_watchdog()
+{
+  int trips0 = watchdog_trips;
+  uint64_t t0 = clock_us();
+  Run_gyro(500, 0);          // power = 0: 超时为 inf, 原地不动
+  Runencode(0, 500);         // speed = 0: 超时为 inf
+  Turnencode(0, 300);        // 没有超时
+  run_gyro_JAR(600, 0, 80);  // 正常
+  Turn_Gyro_new(90);         // 正常
+  printf("watchdog: test trips=%d elapsed=%.2fs\n", watchdog_trips - trips0, clock_since(t0));
+}
+
+/**
+ * @brief 异步运动测试(motion.h): 取消后的下一段运动要照常执行, 阶段切换要结束后台运动
+ * 1. run_gyro_JAR_async 走到 30% 时取消, 随后的 Run_wall / Turn_Gyro 不能被残留的取消标志跳过
+ * 2. 后台运动途中 motion_reset()(usercontrol() 开头做的事), 之后同步运动不能卡在 motion_begin()
+ * 输出: async: ... 每项一行, 最后 async: ok=1/0
+ * @return 全部通过
+ */
+bool test_async()
+{
+  now = 0;
+  Start = sensors().heading;
+  bool ok = true;
+
+  float enc0 = drive_position();
+  MotionHandle h = run_gyro_JAR_async(900);
+  h.waitUntilProgress(0.3);
+  h.cancel();
+  h.wait();
+  float moved = drive_position() - enc0;
+  bool pass = motion_last_result.exit == MOTION_CANCELLED && moved > 200 && moved < 800;
+  printf("async: cancel moved=%.1f exit=%s pass=%d\n", moved, motion_exit_name(motion_last_result.exit), pass);
+  ok = ok && pass;
+
+  MotionResult r = Run_wall(50, 800, 5);
+  pass = r.exit == MOTION_SETTLED && r.elapsed > 0.7;
+  printf("async: Run_wall elapsed=%.3f exit=%s pass=%d\n", r.elapsed, motion_exit_name(r.exit), pass);
+  ok = ok && pass;
+
+  float h0 = sensors().heading;
+  r = Turn_Gyro(90);
+  float turned = sensors().heading - h0;
+  pass = r.exit == MOTION_SETTLED && fabs(turned - 90) < 3;
+  printf("async: Turn_Gyro elapsed=%.3f turned=%.1f exit=%s pass=%d\n", r.elapsed, turned, motion_exit_name(r.exit), pass);
+  ok = ok && pass;
+
+  run_gyro_JAR_async(2000, 90);
+  wait(300);
+  motion_reset();
+  pass = !drive_motion.async_busy && !drive_motion.running;
+  enc0 = drive_position();
+  r = run_gyro_JAR(-300, 90);
+  moved = drive_position() - enc0;
+  pass = pass && r.exit == MOTION_SETTLED && fabs(moved + 300) < 5;
+  printf("async: reset then run_gyro_JAR moved=%.1f exit=%s pass=%d\n", moved, motion_exit_name(r.exit), pass);
+  ok = ok && pass;
+
+  printf("async: ok=%d\n", ok);
+  return ok;
+}
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,162 @@
+/**
+ * @file watchdog.h
+ * @brief 运动看门狗: 每段底盘运动的硬截止时间 + 无进展检测, 触发后刹车结束运动并报告
+ *
+ * 1. 运动函数开头声明 MotionWatch watch("名字"), 离开函数时自动撤销; 嵌套调用只看最外层
+ * 2. 挂在 100Hz 执行器上, 用本节拍快照(sensors.h), 不额外读设备。两种触发:
+ *    - 截止: 运动已执行 deadline_ms(默认 watchdog_cfg.deadline_ms, 带超时参数的函数按自己的超时给)
+ *    - 无进展: 连续 idle_ms 内任一侧编码器变化都不到 idle_enc 度、航向变化不到 idle_deg 度
+ *      (撞墙类运动本来就会顶住不动, 声明时 may_stall = true 只查截止)
+ *    超时为 inf/NaN(如 Run_gyro 的 power 为 0)、编码器断线、转向卡在误差刚好不为 0 等情况都会落到这两条里
+ * 3. 触发后: 底盘刹车, drive_motion.abort 置位(motion_cancelled() 为真, 运动循环退出),
+ *    记一次 CAPTURE_WATCHDOG 异常窗口和 trace 标记; 运动函数返回时打印一行 watchdog: ...
+ * 4. 运动循环只需在循环条件里检查 motion_cancelled(), 不用各自处理截止和卡死
+ */
+
+///////////////////////////////////////////////////////////////////////////////
+// 参数(可在运行中修改)
+///////////////////////////////////////////////////////////////////////////////
+struct WatchdogConfig {
+    int deadline_ms;        // 默认硬截止时间
+    int idle_ms;            // 无进展持续多久触发, 0 关闭
+    float idle_enc;         // 任一侧编码器变化超过此值(度)算有进展
+    float idle_deg;         // 航向变化超过此值(度)算有进展
+};
+
+WatchdogConfig watchdog_cfg = {8000, 1000, 10, 1};
+
+const int WATCHDOG_MARGIN_MS = 500;     // 带超时参数的函数: 截止 = 超时 + 此余量
+
+enum WatchdogReason { WATCHDOG_NONE = 0, WATCHDOG_DEADLINE = 1, WATCHDOG_NO_PROGRESS = 2 };
+
+///////////////////////////////////////////////////////////////////////////////
+// 状态
+///////////////////////////////////////////////////////////////////////////////
+struct Watchdog {
+    volatile bool armed;      // 有运动在监视中
+    int depth;                // MotionWatch 嵌套层数(只由运动所在任务改)
+    const char *name;         // 最外层运动函数名
+    uint64_t start_us;        // 开始时刻
+    int deadline_ms;
+    bool may_stall;
+    float ref_left, ref_right, ref_heading; // 上次有进展时的编码器/航向
+    uint64_t ref_us;          // 上次有进展的时刻
+    volatile int reason;      // 本段运动的触发原因(WatchdogReason)
+    float elapsed;            // 触发时已执行的秒数
+    float progress;           // 触发时的 drive_motion.progress
+};
+
+Watchdog watchdog = {false, 0, 0, 0, 0, false, 0, 0, 0, 0, WATCHDOG_NONE, 0, 0};
+int watchdog_trips = 0;       // 累计触发次数
+
+const char *watchdog_reason_name(int reason)
+{
+  switch (reason) {
+    case WATCHDOG_DEADLINE: return "deadline";
+    case WATCHDOG_NO_PROGRESS: return "no_progress";
+    default: return "none";
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 监视
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief 开始监视一段运动(嵌套时只有最外层生效)
+ * @param name 运动函数名
+ * @param deadline_ms 硬截止时间, <=0 或非有限值用 watchdog_cfg.deadline_ms
+ * @param may_stall 运动本身会顶住不动(撞墙), 不做无进展检测
+ */
+void watchdog_arm(const char *name, float deadline_ms = 0, bool may_stall = false)
+{
+  if (watchdog.depth++ > 0) return;
+  SensorSnapshot snap = sensors();
+  watchdog.name = name;
+  watchdog.start_us = watchdog.ref_us = clock_us();
+  watchdog.deadline_ms = deadline_ms > 0 && deadline_ms < 1e9 ? (int)deadline_ms : watchdog_cfg.deadline_ms;
+  watchdog.may_stall = may_stall;
+  watchdog.ref_left = snap.left_pos;
+  watchdog.ref_right = snap.right_pos;
+  watchdog.ref_heading = snap.heading;
+  watchdog.reason = WATCHDOG_NONE;
+  drive_motion.abort = false;
+  __sync_synchronize();   // 参数写完再开始监视
+  watchdog.armed = true;
+}
+
+/**
+ * @brief 结束监视; 本段运动被看门狗结束过则打印报告
+ */
+void watchdog_disarm()
+{
+  if (watchdog.depth <= 0 || --watchdog.depth > 0) return;
+  watchdog.armed = false;
+  if (watchdog.reason != WATCHDOG_NONE) {
+    printf("watchdog: motion=%s reason=%s elapsed=%.2fs deadline=%dms progress=%.2f trips=%d\n",
+           watchdog.name, watchdog_reason_name(watchdog.reason), watchdog.elapsed,
+           watchdog.deadline_ms, watchdog.progress, watchdog_trips);
+  }
+  drive_motion.abort = false;
+}
+
+/**
+ * @brief 复位监视状态(motion_reset() 调用: 运动任务被直接停掉时 MotionWatch 没有析构)
+ */
+void watchdog_reset()
+{
+  watchdog.armed = false;
+  watchdog.depth = 0;
+  drive_motion.abort = false;
+}
+
+// 运动函数开头声明, 离开作用域自动撤销
+struct MotionWatch {
+    MotionWatch(const char *name, float deadline_ms = 0, bool may_stall = false) { watchdog_arm(name, deadline_ms, may_stall); }
+    ~MotionWatch() { watchdog_disarm(); }
+};
+
+/**
+ * @brief 触发: 刹车、结束运动、记录异常窗口
+ */
+void watchdog_trip(int reason, uint64_t now)
+{
+  watchdog.reason = reason;
+  watchdog.elapsed = (now - watchdog.start_us) / 1e6;
+  watchdog.progress = drive_motion.progress > 0 ? drive_motion.progress : 0;
+  watchdog_trips++;
+  drive_motion.abort = true;
+  drive_left.stop(brake);
+  drive_right.stop(brake);
+  trace_instant("watchdog", reason);
+  capture_trigger(CAPTURE_WATCHDOG, watchdog.elapsed);
+}
+
+/**
+ * @brief 执行器任务: 检查截止时间和进展
+ */
+void watchdog_job(float dt)
+{
+  if (!watchdog.armed || watchdog.reason != WATCHDOG_NONE) return;
+  SensorSnapshot snap = sensors();
+  uint64_t now = snap.time_us;
+  if (now < watchdog.start_us) return;  // 快照早于开始时刻
+
+  if (now - watchdog.start_us >= (uint64_t)watchdog.deadline_ms * 1000) {
+    watchdog_trip(WATCHDOG_DEADLINE, now);
+    return;
+  }
+  if (watchdog.may_stall || watchdog_cfg.idle_ms <= 0) return;
+
+  if (fabs(snap.left_pos - watchdog.ref_left) > watchdog_cfg.idle_enc ||
+      fabs(snap.right_pos - watchdog.ref_right) > watchdog_cfg.idle_enc ||
+      fabs(snap.heading - watchdog.ref_heading) > watchdog_cfg.idle_deg) {
+    watchdog.ref_left = snap.left_pos;
+    watchdog.ref_right = snap.right_pos;
+    watchdog.ref_heading = snap.heading;
+    watchdog.ref_us = now;
+  } else if (now - watchdog.ref_us >= (uint64_t)watchdog_cfg.idle_ms * 1000) {
+    watchdog_trip(WATCHDOG_NO_PROGRESS, now);
+  }
+}
+bool watchdog_started = control_register(watchdog_job);
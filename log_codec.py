@@ -0,0 +1,304 @@
+"""
+VEX V5 binary telemetry decoder (see include/log_codec.h)
+==========================================================
+The brain prints a `telemetry_v2` line followed by one `~<base64>` line per
+frame:
+
+  frame   = type(1) seq(u16 LE) payload crc16-ccitt(u16 LE, over type..payload)
+  'S'     = version(1) nfields(1) name(len+bytes) { scale(varint) field(len+bytes) } * nfields
+  'D'     = first_index(varint) count(1) { zigzag varint per field } * count
+            first sample of a frame is absolute, the rest are deltas to the previous sample
+
+Every data frame decodes on its own, so a stream with lost, truncated or
+corrupted lines still yields every intact frame. If the schema frame itself is
+lost, the built-in telemetry_v1 schema is assumed.
+
+Span traces (include/trace.h) use the same frames after a `trace_v1` line:
+
+  'N'     = count(1) { name_id(varint) name(len+bytes) } * count
+  'T'     = count(1) { task(varint) name_id(varint) } * count
+  'E'     = first_index(varint) count(1) { dts_us(varint) task(varint) phase(1) name_id(varint) arg(zigzag) } * count
+            first event of a frame carries its absolute time, the rest the delta to the previous event
+"""
+
+from __future__ import annotations
+import base64
+import binascii
+import re
+from dataclasses import dataclass, field
+
+TELEMETRY_V1_FIELDS = (
+    "time_s,left_avg,right_avg,action,target,current,error,error_deriv,dt,"
+    "p_out,i_out,d_out,total_out,aux_error,aux_deriv,aux_out,gyro_pitch"
+).split(",")
+TELEMETRY_V1_SCALES = [100000, 10, 10, 1, 100, 100, 100, 1000, 1000000,
+                       100, 100, 100, 100, 100, 1000, 100, 100]
+
+BINARY_MARKER = "telemetry_v2"
+TRACE_MARKER = "trace_v1"
+LOG_FRAME_BYTES = 384          # largest frame the brain emits (LOG_FRAME_BYTES in log_codec.h)
+
+
+@dataclass
+class Schema:
+    name: str
+    fields: list[str]
+    scales: list[int]
+
+
+DEFAULT_SCHEMA = Schema("telemetry_v1", TELEMETRY_V1_FIELDS, TELEMETRY_V1_SCALES)
+
+
+@dataclass
+class DecodeResult:
+    schema: Schema | None = None
+    rows: list[list[float]] = field(default_factory=list)
+    frames_ok: int = 0
+    frames_bad: int = 0          # bad base64 / CRC / truncated
+    missing_samples: int = 0     # gaps between first_index of consecutive frames
+    warnings: list[str] = field(default_factory=list)
+
+
+@dataclass
+class TraceResult:
+    names: dict[int, str] = field(default_factory=dict)
+    threads: dict[int, str] = field(default_factory=dict)      # task id -> thread name
+    events: list[tuple[int, int, str, str, int]] = field(default_factory=list)  # (ts_us, task, phase, name, arg)
+    frames_ok: int = 0
+    frames_bad: int = 0
+    missing_events: int = 0
+    warnings: list[str] = field(default_factory=list)
+
+
+def crc16_ccitt(data: bytes, crc: int = 0xFFFF) -> int:
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+class _Reader:
+    def __init__(self, data: bytes, pos: int = 0):
+        self.data, self.pos = data, pos
+
+    def u8(self) -> int:
+        if self.pos >= len(self.data):
+            raise ValueError("truncated")
+        v = self.data[self.pos]
+        self.pos += 1
+        return v
+
+    def varint(self) -> int:
+        v, shift = 0, 0
+        while True:
+            b = self.u8()
+            v |= (b & 0x7F) << shift
+            if not b & 0x80:
+                return v
+            shift += 7
+            if shift > 35:
+                raise ValueError("bad varint")
+
+    def svarint(self) -> int:
+        v = self.varint()
+        return (v >> 1) ^ -(v & 1)
+
+    def string(self) -> str:
+        n = self.u8()
+        s = self.data[self.pos:self.pos + n]
+        if len(s) != n:
+            raise ValueError("truncated")
+        self.pos += n
+        return s.decode("ascii", errors="replace")
+
+
+def decode_frame_bytes(raw: bytes) -> tuple[str, int, bytes] | None:
+    """Binary frame -> (type, seq, payload), or None if damaged."""
+    if len(raw) < 5:
+        return None
+    body, crc = raw[:-2], raw[-2] | (raw[-1] << 8)
+    if crc16_ccitt(body) != crc:
+        return None
+    return chr(body[0]), body[1] | (body[2] << 8), body[3:]
+
+
+def decode_frame(line: str) -> tuple[str, int, bytes] | None:
+    """'~base64' line -> (type, seq, payload), or None if damaged."""
+    text = line.strip()
+    if not text.startswith("~"):
+        return None
+    try:
+        raw = base64.b64decode(text[1:], validate=True)
+    except (binascii.Error, ValueError):
+        return None
+    return decode_frame_bytes(raw)
+
+
+def decode_lines(lines: list[str]) -> DecodeResult:
+    """Decode the '~' frame lines of one telemetry_v2 block."""
+    return decode_frames(decode_frame(line) for line in lines if line.strip().startswith("~"))
+
+
+def decode_frames(frames) -> DecodeResult:
+    """Decode one stream of frames (decode_frame results, None for a damaged frame)."""
+    res = DecodeResult()
+    schema = None
+    expected_index = None
+    pending: list[bytes] = []   # data frames seen before the schema frame
+
+    def decode_data(payload: bytes):
+        nonlocal expected_index
+        r = _Reader(payload)
+        first = r.varint()
+        count = r.u8()
+        n = len(schema.fields)
+        prev = [0] * n
+        rows = []
+        for k in range(count):
+            q = [r.svarint() for _ in range(n)]
+            if k > 0:
+                q = [p + d for p, d in zip(prev, q)]
+            prev = q
+            rows.append([v / s for v, s in zip(q, schema.scales)])
+        if expected_index is not None and first > expected_index:
+            res.missing_samples += first - expected_index
+            res.warnings.append(f"samples {expected_index}..{first - 1} missing")
+        expected_index = first + count
+        res.rows.extend(rows)
+
+    for frame in frames:
+        if frame is None:
+            res.frames_bad += 1
+            continue
+        ftype, _seq, payload = frame
+        try:
+            if ftype == "S":
+                r = _Reader(payload)
+                version = r.u8()
+                nfields = r.u8()
+                name = r.string()
+                scales, fields = [], []
+                for _ in range(nfields):
+                    scales.append(r.varint())
+                    fields.append(r.string())
+                if version != 1:
+                    res.warnings.append(f"unknown codec version {version}")
+                schema = Schema(name, fields, scales)
+                for p in pending:
+                    decode_data(p)
+                pending.clear()
+            elif ftype == "D":
+                if schema is None:
+                    pending.append(payload)
+                else:
+                    decode_data(payload)
+            else:
+                res.frames_bad += 1
+                continue
+            res.frames_ok += 1
+        except ValueError:
+            res.frames_bad += 1
+
+    if schema is None and pending:
+        res.warnings.append("schema frame lost, assuming telemetry_v1")
+        schema = DEFAULT_SCHEMA
+        for p in pending:
+            try:
+                decode_data(p)
+            except ValueError:
+                res.frames_bad += 1
+    res.schema = schema
+    if res.frames_bad:
+        res.warnings.append(f"{res.frames_bad} damaged frame(s) dropped")
+    return res
+
+
+def parse_binary_block(lines: list[str], i: int, stop_markers) -> tuple[DecodeResult, int, str, int]:
+    """Scan a telemetry_v2 block starting after its marker line at index i.
+
+    Frame lines are collected until a '---' footer, a new test marker or the end
+    of the text (partial stream). Returns (result, next index, meta, expected samples).
+    """
+    frame_lines: list[str] = []
+    while i < len(lines):
+        row = lines[i].strip()
+        if row.startswith("---") or row == BINARY_MARKER or any(row == k or row.startswith(k + " ") for k in stop_markers):
+            break
+        if row.startswith("~"):
+            frame_lines.append(row)
+        i += 1
+
+    meta, expected = "", -1
+    while i < len(lines):
+        row = lines[i].strip()
+        if not row:
+            i += 1
+            continue
+        if not row.startswith("---"):
+            break
+        if "complete" in row:
+            meta = row
+        m = re.search(r"total\s+(\d+)\s+samples", row)
+        if m:
+            expected = int(m.group(1))
+        i += 1
+    return decode_lines(frame_lines), i, meta, expected
+
+
+def decode_trace(frames) -> TraceResult:
+    """Decode one trace_v1 stream (decode_frame results, None for a damaged frame)."""
+    res = TraceResult()
+    event_frames: list[bytes] = []
+    thread_ids: dict[int, int] = {}
+    for frame in frames:
+        if frame is None:
+            res.frames_bad += 1
+            continue
+        ftype, _seq, payload = frame
+        try:
+            r = _Reader(payload)
+            if ftype == "N":
+                for _ in range(r.u8()):
+                    k = r.varint()
+                    res.names[k] = r.string()
+            elif ftype == "T":
+                for _ in range(r.u8()):
+                    task = r.varint()
+                    thread_ids[task] = r.varint()
+            elif ftype == "E":
+                event_frames.append(payload)
+            else:
+                res.frames_bad += 1
+                continue
+            res.frames_ok += 1
+        except ValueError:
+            res.frames_bad += 1
+
+    # names may arrive after the events that use them, so events are decoded last
+    res.threads = {task: res.names.get(k, f"task {task}") for task, k in thread_ids.items()}
+    decoded = []
+    for payload in event_frames:
+        try:
+            r = _Reader(payload)
+            first, count = r.varint(), r.u8()
+            ts, rows = 0, []
+            for _ in range(count):
+                ts += r.varint()
+                task = r.varint()
+                phase = chr(r.u8())
+                name = res.names.get(r.varint(), "?")
+                rows.append((ts, task, phase, name, r.svarint()))
+            decoded.append((first, rows))
+        except ValueError:
+            res.frames_bad += 1
+    expected = 0
+    for first, rows in sorted(decoded, key=lambda d: d[0]):
+        if first > expected:
+            res.missing_events += first - expected
+            res.warnings.append(f"events {expected}..{first - 1} missing")
+        expected = max(expected, first + len(rows))
+        res.events.extend(rows)
+    if res.frames_bad:
+        res.warnings.append(f"{res.frames_bad} damaged frame(s) dropped")
+    return res
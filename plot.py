@@ -8,6 +8,8 @@ Supported test types:
   - test_straight : Straight-line PD control log (10 columns)
   - test_turn     : PID turning log              (6 columns)
   - test_minspeed : Min drive power sweep log     (3 columns)
+  - telemetry_v2  : Binary frames from test_log_dump, decoded by log_codec.py
+                    (lost/corrupted frames are skipped, partial streams still plot)
 
 Usage:
   1. Default (out.csv):    python3 plot.py
@@ -15,6 +17,7 @@ Usage:
   3. From clipboard:       python3 plot.py --clipboard
   4. Watch terminal file:  python3 plot.py --watch <terminal_file>
   5. Save as PNG:          python3 plot.py --save output
+  6. Lossless capture:     python3 serial_rx.py --port <dev>  (writes out.csv, then option 1)
 
 Install deps:  pip3 install matplotlib pandas
 """
@@ -27,6 +30,8 @@ import argparse
 from pathlib import Path
 from dataclasses import dataclass, field
 
+from log_codec import BINARY_MARKER, parse_binary_block
+
 # --- Dependency check ---------------------------------------------------------
 _missing = []
 try:
@@ -133,6 +138,8 @@ def _try_salvage_csv(line: str, ncols: int) -> str | None:
     Handles cases like:
       '0.460,17.88,-1.791,-11.0,10.3,5.5d (total 44 samples) ---'
     where a data row was concatenated with footer text due to USB buffer loss.
+    Only old CSV logs need this; telemetry_v2 frames received with serial_rx.py
+    arrive complete.
     """
     parts = line.split(",")
     if len(parts) < ncols:
@@ -163,6 +170,18 @@ def parse_blocks(text: str) -> list[TestBlock]:
     while i < len(lines):
         line = lines[i].strip()
 
+        # Binary frames (test_log_dump since telemetry_v2); partial streams decode frame by frame
+        if line == BINARY_MARKER:
+            res, i, meta, expected_samples = parse_binary_block(lines, i + 1, TEST_HEADERS)
+            for w in res.warnings:
+                print(f"  [WARN] {BINARY_MARKER}: {w}")
+            if res.schema and res.rows:
+                df = pd.DataFrame(res.rows, columns=res.schema.fields)
+                blocks.append(TestBlock(test_type=res.schema.name, df=df, meta=meta))
+                if expected_samples > 0 and len(df) != expected_samples:
+                    print(f"  [WARN] {res.schema.name}: expected {expected_samples} samples but got {len(df)}")
+            continue
+
         if line not in TEST_HEADERS:
             i += 1
             continue
@@ -186,7 +205,7 @@ def parse_blocks(text: str) -> list[TestBlock]:
         corrupted = False
         while i < len(lines):
             row = lines[i].strip()
-            if not row or row.startswith("---") or row in TEST_HEADERS:
+            if not row or row.startswith("---") or row in TEST_HEADERS or row == BINARY_MARKER:
                 break
             if _is_csv_data(row, ncols):
                 csv_rows.append(row)
@@ -330,6 +349,46 @@ def plot_telemetry_v1(blk: TestBlock, idx: int) -> plt.Figure:
 
         axes[1, 1].axis("off") # hide 4th plot
 
+    elif action == 8: # Relay autotune (rows with action 9 hold the results)
+        fig.suptitle(f"Relay Autotune (telemetry_v1)  #{idx + 1}", fontsize=14, fontweight="bold", y=0.97)
+        osc = df[df["action"] == 8]
+        res = df[df["action"] == 9]
+        to = osc["time_s"]
+
+        ax = axes[0, 0]
+        ax.plot(to, osc["current"], color=C_BLUE, lw=1.5, label="Measured")
+        ax.plot(to, osc["target"], color=C_TEAL, lw=1.2, ls="--", label="Setpoint")
+        ax.set_ylabel("deg")
+        ax.set_title("Limit Cycle")
+        ax.legend(loc="upper right")
+
+        ax = axes[0, 1]
+        ax.step(to, osc["total_out"], color=C_PEACH, lw=1.5, where="post", label="Relay Output")
+        ax.set_ylabel("Power (%)")
+        ax.set_title("Relay Output")
+        ax.legend(loc="upper right")
+
+        ax = axes[1, 0]
+        ax.plot(to, osc["aux_error"], color=C_YELLOW, lw=1.5, label="Heading Err (deg)")
+        ax.set_xlabel("Time (s)")
+        ax.set_title("Heading Hold")
+        ax.legend(loc="upper right")
+
+        ax = axes[1, 1]
+        ax.axis("off")
+        rules = ["Z-N", "Pessen", "Some OS", "No OS"]
+        dirs = {0: "both", 1: "fwd", -1: "rev"}
+        lines = ["rule      dir    Ku      Tu     kp      ki      kd"]
+        for _, r in res.iterrows():
+            rule = rules[int(r["error"])] if 0 <= int(r["error"]) < len(rules) else str(int(r["error"]))
+            lines.append(f"{rule:9s} {dirs.get(int(r['aux_deriv']), '?'):5s} {r['target']:6.2f} {r['current']:6.3f} "
+                         f"{r['p_out']:6.3f} {r['i_out']:7.3f} {r['d_out']:7.4f}")
+        if res.empty:
+            lines.append("(no result rows: experiment failed)")
+        ax.text(0.0, 1.0, "\n".join(lines), va="top", family="monospace", fontsize=8, color="#cdd6f4",
+                transform=ax.transAxes)
+        ax.set_title("Proposed Gains (continuous units)")
+
     else: # Run (action == 2) or other
         fig.suptitle(f"Straight PID Test (telemetry_v1)  #{idx + 1}", fontsize=14, fontweight="bold", y=0.97)
         # TL: Distance & Error
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""
+VEX V5 match recorder reader (see include/recorder.h)
+=====================================================
+Reads rec_NNN.bin files copied from the brain's SD card. Each file holds one
+power-on session; every autonomous / driver period is a separate stream that
+starts with a schema frame.
+
+  record = 0xA5 len(u16 LE) frame      frame format: log_codec.h / log_codec.py
+
+A damaged record is skipped by scanning for the next 0xA5 whose frame passes
+its CRC, so a corrupted sector costs only the frames inside it.
+
+Usage:
+  python3 rec_read.py rec_000.bin                    # one line per period
+  python3 rec_read.py rec_000.bin --csv match        # also write match_0_auto.csv, match_1_driver.csv, ...
+"""
+
+from __future__ import annotations
+import argparse
+import csv
+from pathlib import Path
+
+from log_codec import LOG_FRAME_BYTES, decode_frame_bytes, decode_frames
+
+REC_SYNC = 0xA5
+MODE_NAMES = {0: "off", 1: "auto", 2: "driver"}
+
+
+def read_records(data: bytes) -> tuple[list[tuple[str, int, bytes]], int]:
+    """File bytes -> (intact frames in file order, damaged records skipped)."""
+    frames, bad, pos = [], 0, 0
+    while pos + 3 <= len(data):
+        if data[pos] != REC_SYNC:
+            pos += 1
+            continue
+        n = data[pos + 1] | (data[pos + 2] << 8)
+        frame = decode_frame_bytes(data[pos + 3:pos + 3 + n]) if 5 <= n <= LOG_FRAME_BYTES else None
+        if frame is None:
+            bad += 1
+            pos += 1            # resync on the next sync byte
+            # skip the rest of a damaged record without counting each byte again
+            while pos < len(data) and data[pos] != REC_SYNC:
+                pos += 1
+            continue
+        frames.append(frame)
+        pos += 3 + n
+    return frames, bad
+
+
+def split_periods(frames: list[tuple[str, int, bytes]]) -> list[list[tuple[str, int, bytes]]]:
+    """A schema frame with sequence 0 starts a new period."""
+    periods: list[list] = []
+    for f in frames:
+        if f[0] == "S" and f[1] == 0 or not periods:
+            periods.append([])
+        periods[-1].append(f)
+    return periods
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Decode VEX V5 match recorder files")
+    ap.add_argument("files", nargs="+", help="rec_NNN.bin files from the SD card")
+    ap.add_argument("--csv", metavar="PREFIX", help="write one CSV per period: PREFIX_<n>_<mode>.csv")
+    args = ap.parse_args()
+
+    n = 0
+    for path in args.files:
+        data = Path(path).read_bytes()
+        frames, bad = read_records(data)
+        print(f"{path}: {len(data)} bytes, {len(frames)} frames, {bad} damaged record(s)")
+        for period in split_periods(frames):
+            res = decode_frames(period)
+            if not res.rows:
+                continue
+            cols = res.schema.fields
+            t = cols.index("time_s") if "time_s" in cols else None
+            mode = MODE_NAMES.get(int(res.rows[0][cols.index("mode")]), "?") if "mode" in cols else "?"
+            span = f" t={res.rows[0][t]:.2f}..{res.rows[-1][t]:.2f}s" if t is not None else ""
+            print(f"  period {n}: {mode}{span} samples={len(res.rows)} missing={res.missing_samples} "
+                  f"schema={res.schema.name}")
+            for w in res.warnings:
+                print(f"    warning: {w}")
+            if args.csv:
+                out = f"{args.csv}_{n}_{mode}.csv"
+                with open(out, "w", newline="") as fp:
+                    w = csv.writer(fp)
+                    w.writerow(cols)
+                    w.writerows(res.rows)
+                print(f"    -> {out}")
+            n += 1
+
+
+if __name__ == "__main__":
+    main()
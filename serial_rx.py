@@ -0,0 +1,227 @@
+#!/usr/bin/env python3
+"""
+VEX V5 serial log receiver (see include/log_link.h)
+===================================================
+Reads the brain's USB serial output, acknowledges every log frame and asks
+for resends of missing or damaged ones, so test_log_dump runs at the link's
+full speed without lost rows. Writes a clean copy of the session (text lines
+plus every telemetry_v2 / trace_v1 block with its frames complete and in
+order) that plot.py / app.py / trace_export.py read directly.
+
+Host -> brain, one command per line:
+  !A <seq> <win>   cumulative ack: all frames before <seq> received, <win> frames may be in flight
+  !N <seq>         resend frame <seq>
+
+Usage:
+  python3 serial_rx.py --port /dev/ttyACM1                  # real brain (needs pyserial)
+  python3 serial_rx.py --sim "build/sim/repo_sim --test profile --link 1"
+  python3 serial_rx.py --sim "..." --loss 0.2               # drop/corrupt frames and acks for testing
+  python3 plot.py out.csv
+"""
+
+from __future__ import annotations
+import argparse
+import queue
+import random
+import re
+import shlex
+import subprocess
+import sys
+import threading
+import time
+
+from log_codec import BINARY_MARKER, TRACE_MARKER, decode_frame, decode_lines, decode_trace
+
+NAK_RETRY_S = 0.2   # re-request a still-missing frame after this long
+
+
+class SerialPort:
+    def __init__(self, dev: str, baud: int):
+        try:
+            import serial
+        except ImportError:
+            sys.exit("pyserial is required for --port:  pip3 install pyserial")
+        self.port = serial.Serial(dev, baud, timeout=0.1)
+
+    def readline(self) -> bytes | None:
+        while True:
+            line = self.port.readline()
+            if line:
+                return line
+
+    def write(self, data: bytes):
+        self.port.write(data)
+
+
+class SimProcess:
+    def __init__(self, cmd: str):
+        self.proc = subprocess.Popen(shlex.split(cmd), stdin=subprocess.PIPE, stdout=subprocess.PIPE, bufsize=0)
+
+    def readline(self) -> bytes | None:
+        line = self.proc.stdout.readline()
+        return line or None
+
+    def write(self, data: bytes):
+        try:
+            self.proc.stdin.write(data)
+            self.proc.stdin.flush()
+        except (BrokenPipeError, OSError):
+            pass
+
+
+class Receiver:
+    def __init__(self, link, out, window: int, loss: float, rng: random.Random):
+        self.link, self.out, self.window = link, out, window
+        self.loss, self.rng = loss, rng
+        self.frames: dict[int, str] = {}   # current stream: offset from stream start -> line
+        self.expected = 0                  # next in-order frame offset
+        self.nak_sent: dict[int, float] = {}
+        self.in_stream = False
+        self.trace = False                 # current stream is a trace_v1 block
+        self.stats = dict(streams=0, frames=0, dup=0, bad=0, naks=0, dropped=0, samples=0, events=0, missing=0)
+
+    # -- host -> brain ---------------------------------------------------------
+    def send(self, text: str):
+        if self.loss and self.rng.random() < self.loss:
+            return
+        self.link.write((text + "\n").encode())
+
+    def ack(self):
+        ahead = len(self.frames) - self.expected
+        self.send(f"!A {self.expected & 0xFFFF} {max(1, self.window - ahead)}")
+
+    def nak(self, k: int):
+        now = time.monotonic()
+        if k not in self.frames and now - self.nak_sent.get(k, 0) >= NAK_RETRY_S:
+            self.nak_sent[k] = now
+            self.stats["naks"] += 1
+            self.send(f"!N {k & 0xFFFF}")
+
+    def nak_missing(self):
+        """Request every hole below the newest frame received."""
+        if self.frames:
+            for k in range(self.expected, max(self.frames)):
+                self.nak(k)
+
+    # -- brain -> host ---------------------------------------------------------
+    def flush(self, footer: str = ""):
+        """End of a stream: write its frames in order and count what is still missing."""
+        if not self.in_stream:
+            return
+        lines = [self.frames[k] for k in sorted(self.frames)]
+        for line in lines:
+            self.out.write(line + "\n")
+        if self.trace:
+            res = decode_trace(decode_frame(line) for line in lines)
+            m = re.search(r"events\s+(\d+)", footer)
+            missing = max(res.missing_events, int(m.group(1)) - len(res.events) if m else 0)
+            self.stats["events"] += len(res.events)
+        else:
+            res = decode_lines(lines)
+            m = re.search(r"total\s+(\d+)\s+samples", footer)
+            missing = max(res.missing_samples, int(m.group(1)) - len(res.rows) if m else 0)
+            self.stats["samples"] += len(res.rows)
+        self.stats["streams"] += 1
+        self.stats["missing"] += missing
+        for w in res.warnings:
+            print(f"link: warning: {w}")
+        self.frames.clear()
+        self.nak_sent.clear()
+        self.expected = 0
+        self.in_stream = False
+        self.trace = False
+
+    def on_frame(self, line: str):
+        if self.loss:
+            r = self.rng.random()
+            if r < self.loss / 2:
+                self.stats["dropped"] += 1
+                return
+            if r < self.loss:
+                k = self.rng.randrange(1, len(line))
+                line = line[:k] + ("A" if line[k] != "A" else "B") + line[k + 1:]
+        frame = decode_frame(line)
+        if frame is None:
+            # the sequence number is unreadable too; the first missing frame is the best guess
+            self.stats["bad"] += 1
+            self.ack()
+            self.nak(self.expected)
+            return
+        self.in_stream = True
+        # 16-bit sequence -> offset in this stream, relative to the next expected frame
+        k = self.expected + (((frame[1] - self.expected) & 0xFFFF) ^ 0x8000) - 0x8000
+        if k < self.expected or k in self.frames:
+            self.stats["dup"] += 1
+        else:
+            self.frames[k] = line
+            self.stats["frames"] += 1
+            while self.expected in self.frames:
+                self.nak_sent.pop(self.expected, None)
+                self.expected += 1
+        self.ack()
+        self.nak_missing()
+
+    def on_line(self, raw: bytes):
+        line = raw.decode("ascii", errors="replace").rstrip("\r\n")
+        text = line.strip()
+        if text.startswith("~"):
+            self.on_frame(text)
+            return
+        if text in (BINARY_MARKER, TRACE_MARKER):
+            self.flush()
+            self.in_stream = True
+            self.trace = text == TRACE_MARKER
+        elif text.startswith("---"):
+            self.flush(text)
+        self.out.write(line + "\n")
+        self.out.flush()
+        print(line)
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Acknowledging receiver for VEX V5 log frames")
+    src = ap.add_mutually_exclusive_group(required=True)
+    src.add_argument("--port", help="serial device of the brain (e.g. /dev/ttyACM1, COM5)")
+    src.add_argument("--sim", help="simulator command line, run with --link 1")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--out", default="out.csv", help="clean session copy for plot.py/app.py (default out.csv)")
+    ap.add_argument("--window", type=int, default=8, help="frames the brain may send ahead of the ack")
+    ap.add_argument("--loss", type=float, default=0.0, help="test only: drop/corrupt this fraction of frames and acks")
+    ap.add_argument("--seed", type=int, default=1)
+    args = ap.parse_args()
+
+    link = SerialPort(args.port, args.baud) if args.port else SimProcess(args.sim)
+    lines: queue.Queue = queue.Queue()
+
+    def reader():
+        while True:
+            line = link.readline()
+            lines.put(line)
+            if line is None:
+                return
+
+    threading.Thread(target=reader, daemon=True).start()
+    with open(args.out, "w") as out:
+        rx = Receiver(link, out, args.window, args.loss, random.Random(args.seed))
+        try:
+            while True:
+                try:
+                    line = lines.get(timeout=NAK_RETRY_S)
+                except queue.Empty:
+                    rx.nak_missing()
+                    continue
+                if line is None:
+                    break
+                rx.on_line(line)
+        except KeyboardInterrupt:
+            pass
+        rx.flush()
+
+    s = rx.stats
+    print(f"link: streams={s['streams']} frames={s['frames']} dup={s['dup']} bad={s['bad']} "
+          f"dropped={s['dropped']} naks={s['naks']} samples={s['samples']} events={s['events']} "
+          f"missing={s['missing']}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,94 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       sim.h                                                     */
+/*    Description:  仿真器控制接口(仅 sim_main.cpp 使用)                      */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+#ifndef SIM_SIM_H
+#define SIM_SIM_H
+
+#include <stdint.h>
+#include "v5.h"
+
+namespace sim {
+
+/**
+ * @brief 底盘与场地模型参数
+ * 默认值对应 18:1 蓝齿轮直连 3.25 寸轮, 单位均为 mm / s / 度
+ */
+struct PlantConfig {
+  double wheel_mm_per_deg;  // 电机每转 1 度车轮走过的距离
+  double track_mm;          // 左右轮距
+  double turn_scrub;        // 原地转向时的打滑系数(>1 表示转得比理论慢)
+  double free_rpm;          // 12V 空载转速
+  double static_volt;       // 静摩擦对应的电压死区
+  double tau_drive;         // 电压模式一阶时间常数
+  double tau_brake;         // brake/hold 刹停时间常数
+  double tau_coast;         // coast 滑行时间常数
+  double field_mm;          // 场地边长
+  double robot_half_mm;     // 机器人半边长(撞墙判定)
+  double noise;             // 陀螺/编码器噪声幅值(0 为确定性仿真)
+  double ball_period;       // 吸球电机正转时的来球间隔(s), 上一个球没让出一个球径时顺延
+  double hue_shift;         // 场馆灯光造成的颜色传感器色相偏移(度)
+  uint32_t seed;            // 噪声与来球序列的随机种子
+};
+
+PlantConfig default_config();
+void configure(const PlantConfig &config);
+
+// 把工程里的设备对象挂到模型上(其余电机按独立机构处理)
+void attach_drive(vex::motor *left[3], vex::motor *right[3]);
+void attach_intake(vex::motor *intake, vex::motor *ball);
+void attach_distance(vex::distance &sensor, double forward_mm, double lateral_mm);
+void attach_optical(vex::optical &sensor, double path_mm);
+
+// 来球颜色: 0 随机, 1 全红, -1 全蓝(颜色标定时使用)
+void set_ball_colors(int mix);
+// 清空通道里的球并清零球的计数(来球/送出/排出)
+void reset_balls();
+
+// 卡球: 从 at_sec 起该电机正转被卡死(转速为 0, 扭矩/电流到堵转值),
+// 反转累计 0.05s 后解除; every_sec > 0 时解除后每隔 every_sec 再卡一次
+void set_jam(vex::motor *m, double at_sec, double every_sec);
+
+// 吸球通道上的分球口位置(mm): 之前由 Intake_1 带动, 之后由 Ball_1 带动,
+// Ball_1 反转把球退过此处即视为排出
+const double SORT_GATE_MM = 150;
+
+// 初始位姿(场地坐标, 航向 0 朝 +y, 顺时针为正, 与陀螺仪一致)
+void set_pose(double x_mm, double y_mm, double heading_deg);
+
+struct Pose { double x, y, heading; };
+Pose   pose();
+double now_sec();
+
+// 比赛状态(Competition.isAutonomous()/isEnabled() 的返回值)
+void set_competition(bool autonomous, bool enabled);
+
+// 虚拟时间上限, 超过后调用 on_limit 并结束进程
+void set_time_limit(double seconds, void (*on_limit)(void));
+
+// 串口上行: 打开后 vexSerialReadChar(1) 从 stdin 读(上位机 serial_rx.py 的确认), 关闭时总返回 -1
+void set_link(bool enabled);
+
+// Brain.SDcard 对应的主机目录, 传 0 表示没插卡
+void set_sd_dir(const char *dir);
+
+// 每 10ms 记录一行 CSV(t,x,y,heading,left_rpm,right_rpm), 传 0 关闭
+void set_trace_file(const char *path);
+
+// 统计: 气动动作次数、撞墙次数、经过传感器的球数,
+// 以及从通道末端送出(kept)与在分球口被反转排出(ejected)的红/蓝球数、卡球次数与解除次数
+struct Stats {
+  int pneumatic_changes; int wall_contacts; int balls_seen;
+  int kept_red; int kept_blue; int ejected_red; int ejected_blue;
+  int jams; int jams_cleared;
+};
+Stats stats();
+
+// 在当前线程上执行 fn 并把它纳入虚拟时钟调度(仿真入口)
+void run_main(void (*fn)(void));
+
+} // namespace sim
+
+#endif // SIM_SIM_H
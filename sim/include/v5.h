@@ -0,0 +1,407 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       v5.h (sim)                                                */
+/*    Description:  主机仿真用的 vex.h/v5.h 替身                              */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+//
+// 只实现本工程实际用到的 VEX V5 API 子集, 让 src/ 与 include/ 的代码
+// 不做任何修改即可在 Linux 上编译。设备读写全部转发到 sim/sim_runtime.cpp
+// 中的底盘/机构模型, 所有任务在虚拟时钟上协作调度, 一整套自动几毫秒跑完。
+//
+#ifndef SIM_V5_H
+#define SIM_V5_H
+
+#include <stdint.h>
+#include <stdarg.h>
+
+namespace sim { struct MotorState; struct TaskState; }
+
+// SDK 串口接口(v5_api.h): 从用户串口(USB, index 1)读一个字节, 没有数据返回 -1
+extern "C" int32_t vexSerialReadChar(uint32_t index);
+
+namespace vex {
+
+///////////////////////////////////////////////////////////////////////////////
+// 单位与枚举
+///////////////////////////////////////////////////////////////////////////////
+enum class timeUnits        { sec, msec };
+enum class rotationUnits    { deg, rev, raw };
+enum class velocityUnits    { pct, rpm, dps };
+enum class percentUnits     { pct };
+enum class voltageUnits     { volt, mV };
+enum class torqueUnits      { Nm, InLb };
+enum class currentUnits     { amp };
+enum class temperatureUnits { celsius, fahrenheit };
+enum class distanceUnits    { mm, in, cm };
+enum class directionType    { fwd, rev, undefined };
+enum class brakeType        { coast, brake, hold, undefined };
+enum class gearSetting      { ratio36_1, ratio18_1, ratio6_1 };
+enum class orientationType  { roll, pitch, yaw };
+enum class turnType         { left, right, undefined };
+enum class controllerType   { primary, partner };
+
+const timeUnits        sec       = timeUnits::sec;
+const timeUnits        msec      = timeUnits::msec;
+const timeUnits        seconds   = timeUnits::sec;
+const rotationUnits    deg       = rotationUnits::deg;
+const rotationUnits    degrees   = rotationUnits::deg;
+const rotationUnits    turns     = rotationUnits::rev;
+const velocityUnits    rpm       = velocityUnits::rpm;
+const velocityUnits    dps       = velocityUnits::dps;
+const percentUnits     percent   = percentUnits::pct;
+const voltageUnits     volt      = voltageUnits::volt;
+const directionType    fwd       = directionType::fwd;
+const directionType    forward   = directionType::fwd;
+const directionType    reverse   = directionType::rev;
+const brakeType        coast     = brakeType::coast;
+const brakeType        brake     = brakeType::brake;
+const brakeType        hold      = brakeType::hold;
+const gearSetting      ratio36_1 = gearSetting::ratio36_1;
+const gearSetting      ratio18_1 = gearSetting::ratio18_1;
+const gearSetting      ratio6_1  = gearSetting::ratio6_1;
+const orientationType  roll      = orientationType::roll;
+const orientationType  pitch     = orientationType::pitch;
+const orientationType  yaw       = orientationType::yaw;
+const turnType         left      = turnType::left;
+const turnType         right     = turnType::right;
+const controllerType   primary   = controllerType::primary;
+const controllerType   partner   = controllerType::partner;
+
+const int32_t PORT1  = 0,  PORT2  = 1,  PORT3  = 2,  PORT4  = 3,  PORT5  = 4,
+              PORT6  = 5,  PORT7  = 6,  PORT8  = 7,  PORT9  = 8,  PORT10 = 9,
+              PORT11 = 10, PORT12 = 11, PORT13 = 12, PORT14 = 13, PORT15 = 14,
+              PORT16 = 15, PORT17 = 16, PORT18 = 17, PORT19 = 18, PORT20 = 19,
+              PORT21 = 20, PORT22 = 21;
+
+///////////////////////////////////////////////////////////////////////////////
+// 颜色
+///////////////////////////////////////////////////////////////////////////////
+class color {
+  public:
+    uint32_t rgb;
+    constexpr color() : rgb(0) {}
+    constexpr explicit color(uint32_t value) : rgb(value) {}
+    bool operator==(const color &other) const { return rgb == other.rgb; }
+    bool operator!=(const color &other) const { return rgb != other.rgb; }
+
+    static const color black, white, red, green, blue, yellow, orange, purple, cyan, transparent;
+};
+
+const color black(0x000000);
+const color white(0xFFFFFF);
+const color red(0xFF0000);
+const color green(0x00FF00);
+const color blue(0x0000FF);
+const color yellow(0xFFFF00);
+
+///////////////////////////////////////////////////////////////////////////////
+// 任务与时间
+///////////////////////////////////////////////////////////////////////////////
+void wait(double time, timeUnits units);
+
+class timer {
+  public:
+    timer();
+    void     clear();
+    void     reset();
+    double   time(timeUnits units = timeUnits::msec);
+    double   value();
+
+    static uint32_t system();              // 开机以来的毫秒数(不受 clear 影响)
+    static uint64_t systemHighResolution(); // 开机以来的微秒数
+  private:
+    uint64_t _base_us;
+};
+
+class task {
+  public:
+    task();
+    task(int (*callback)(void));
+    task(int (*callback)(void), int32_t priority);
+    task(int (*callback)(void *), void *arg);
+    task(int (*callback)(void *), void *arg, int32_t priority);
+
+    void stop();
+    static void stop(const task &t);
+    static void stop(int (*callback)(void));
+    static void sleep(uint32_t time);
+
+    static const int32_t kPriorityLow     = 1;
+    static const int32_t kPriorityNormal  = 7;
+    static const int32_t kPriorityHigh    = 15;
+  private:
+    sim::TaskState *_task;
+};
+
+class thread {
+  public:
+    thread();
+    thread(void (*callback)(void));
+    thread(int (*callback)(void));
+    thread(void (*callback)(void *), void *arg);
+    thread(int (*callback)(void *), void *arg);
+
+    void join();
+    void interrupt();
+    void detach() {}
+    int32_t get_id();
+  private:
+    sim::TaskState *_task;
+};
+
+namespace this_thread {
+  void     sleep_for(uint32_t time_ms);
+  void     yield();
+  int32_t  get_id();
+}
+
+class mutex {
+  public:
+    mutex() : _owned(false) {}
+    void lock();
+    bool try_lock();
+    void unlock();
+  private:
+    volatile bool _owned;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Brain / 屏幕 / 三线口
+///////////////////////////////////////////////////////////////////////////////
+class lcd {
+  public:
+    void clearScreen() {}
+    void clearScreen(const color &) {}
+    void clearLine() {}
+    void clearLine(int32_t) {}
+    void newLine() {}
+    void setCursor(int32_t, int32_t) {}
+    void setPenColor(const color &) {}
+    void setFillColor(const color &) {}
+    void print(const char *, ...) {}
+    template <class T> void print(T) {}
+    void printAt(int32_t, int32_t, const char *, ...) {}
+    void drawCircle(int32_t, int32_t, int32_t) {}
+    void drawCircle(int32_t, int32_t, int32_t, const color &) {}
+    void drawRectangle(int32_t, int32_t, int32_t, int32_t) {}
+    void drawRectangle(int32_t, int32_t, int32_t, int32_t, const color &) {}
+    bool pressing() { return false; }
+    int32_t xPosition() { return 0; }
+    int32_t yPosition() { return 0; }
+};
+
+class triport {
+  public:
+    class port {
+      public:
+        int32_t index;
+        explicit port(int32_t i) : index(i) {}
+    };
+    triport() : A(0), B(1), C(2), D(3), E(4), F(5), G(6), H(7) {}
+    port A, B, C, D, E, F, G, H;
+};
+
+class brain {
+  public:
+    brain() {}
+    double timer(timeUnits units);
+    void   resetTimer();
+
+    // SD 卡: 文件放在 sim::set_sd_dir() 指定的主机目录, 未指定时视为没插卡
+    class sdcard {
+      public:
+        bool    isInserted();
+        bool    exists(const char *name);
+        int32_t size(const char *name);
+        int32_t savefile(const char *name, uint8_t *buffer, int32_t len);
+        int32_t appendfile(const char *name, uint8_t *buffer, int32_t len);
+        int32_t loadfile(const char *name, uint8_t *buffer, int32_t len);
+    };
+
+    lcd         Screen;
+    sdcard      SDcard;
+    vex::timer  Timer;
+    triport     ThreeWirePort;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// 手柄(仿真中没有操作手, 所有输入恒为 0)
+///////////////////////////////////////////////////////////////////////////////
+class controller {
+  public:
+    class axis {
+      public:
+        int32_t value() { return 0; }
+        int32_t position() { return 0; }
+        int32_t position(percentUnits) { return 0; }
+    };
+    class button {
+      public:
+        bool pressing() { return false; }
+    };
+    class lcd {
+      public:
+        void clearScreen() {}
+        void clearLine(int32_t) {}
+        void setCursor(int32_t, int32_t) {}
+        void newLine() {}
+        void print(const char *, ...) {}
+        template <class T> void print(T) {}
+    };
+
+    controller() {}
+    explicit controller(controllerType) {}
+    void rumble(const char *) {}
+
+    axis   Axis1, Axis2, Axis3, Axis4;
+    button ButtonL1, ButtonL2, ButtonR1, ButtonR2;
+    button ButtonUp, ButtonDown, ButtonLeft, ButtonRight;
+    button ButtonX, ButtonB, ButtonY, ButtonA;
+    lcd    Screen;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// 电机
+///////////////////////////////////////////////////////////////////////////////
+class motor {
+  public:
+    motor(int32_t index);
+    motor(int32_t index, bool reverse);
+    motor(int32_t index, gearSetting gears, bool reverse);
+
+    void   spin(directionType dir);
+    void   spin(directionType dir, double velocity, velocityUnits units);
+    void   spin(directionType dir, double voltage, voltageUnits units);
+    void   setVelocity(double velocity, velocityUnits units);
+    void   setVelocity(double velocity, percentUnits units);
+    void   setMaxTorque(double value, percentUnits units);
+    void   setStopping(brakeType mode);
+    void   stop();
+    void   stop(brakeType mode);
+
+    void   resetPosition();
+    void   setPosition(double value, rotationUnits units);
+    double position(rotationUnits units);
+    double velocity(velocityUnits units);
+    double velocity(percentUnits units);
+    double torque(torqueUnits units = torqueUnits::Nm);
+    double current(currentUnits units = currentUnits::amp);
+    double voltage(voltageUnits units = voltageUnits::volt);
+    double temperature(temperatureUnits units);
+    int32_t index();
+
+    sim::MotorState *simState() const { return _state; }
+  private:
+    sim::MotorState *_state;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// 传感器与气动
+///////////////////////////////////////////////////////////////////////////////
+class digital_out {
+  public:
+    digital_out(triport::port &port);
+    void set(bool value);
+    int32_t value();
+  private:
+    int32_t _port;
+    bool    _value;
+};
+
+class inertial {
+  public:
+    inertial(int32_t index);
+    void   startCalibration(int32_t value = 0);
+    void   calibrate(int32_t value = 0) { startCalibration(value); }
+    bool   isCalibrating();
+    void   setRotation(double value, rotationUnits units);
+    void   setHeading(double value, rotationUnits units);
+    void   resetRotation();
+    double rotation(rotationUnits units = rotationUnits::deg);
+    double heading(rotationUnits units = rotationUnits::deg);
+    double orientation(orientationType axis, rotationUnits units);
+    double pitch(rotationUnits units = rotationUnits::deg);
+    double roll(rotationUnits units = rotationUnits::deg);
+    double yaw(rotationUnits units = rotationUnits::deg);
+  private:
+    double _rotation_offset;
+};
+
+class optical {
+  public:
+    struct rgbc { double red, green, blue, brightness; };
+
+    optical(int32_t index);
+    vex::color color();
+    bool   isNearObject();
+    double hue();
+    double brightness(bool readRaw = false);
+    rgbc   getRgb(bool raw = true);
+    void   setLightPower(int32_t value, percentUnits units);
+    void   integrationTime(double timeMs);
+    void   objectDetected(void (*callback)(void));   // 接近检测上升沿, 在事件线程中回调
+    void   objectLost(void (*callback)(void));       // 接近检测下降沿
+    int32_t index() const { return _index; }
+  private:
+    int32_t _index;
+};
+
+class distance {
+  public:
+    distance(int32_t index);
+    double objectDistance(distanceUnits units);
+    bool   isObjectDetected();
+    int32_t index() const { return _index; }
+  private:
+    int32_t _index;
+};
+
+class vision {
+  public:
+    class signature {};
+    class code {};
+};
+
+class aivision {
+  public:
+    class colordesc {
+      public:
+        colordesc(int32_t id, uint8_t r, uint8_t g, uint8_t b, float hangle, float hdsat)
+          : id(id) { (void)r; (void)g; (void)b; (void)hangle; (void)hdsat; }
+        int32_t id;
+    };
+    class object {
+      public:
+        object() : centerX(0), centerY(0), width(0), height(0), exists(false) {}
+        int32_t centerX, centerY, width, height;
+        bool    exists;
+    };
+
+    aivision(int32_t index, colordesc &desc) : objectCount(0) { (void)index; (void)desc; }
+    int32_t takeSnapshot(const colordesc &desc) { (void)desc; objectCount = 0; return 0; }
+
+    int32_t objectCount;
+    object  largestObject;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// 比赛状态
+///////////////////////////////////////////////////////////////////////////////
+class competition {
+  public:
+    competition() {}
+    void autonomous(void (*callback)(void));
+    void drivercontrol(void (*callback)(void));
+    bool isAutonomous();
+    bool isDriverControl();
+    bool isEnabled();
+    bool isCompetitionSwitch() { return false; }
+    bool isFieldControl() { return false; }
+
+    static bool bStopTasksBetweenModes;
+};
+
+} // namespace vex
+
+#endif // SIM_V5_H
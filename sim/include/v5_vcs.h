@@ -0,0 +1,12 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       v5_vcs.h (sim)                                            */
+/*    Description:  主机仿真替身, 所有声明都在 v5.h 中                        */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+#ifndef SIM_V5_VCS_H
+#define SIM_V5_VCS_H
+
+#include "v5.h"
+
+#endif // SIM_V5_VCS_H
@@ -0,0 +1,269 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       sim_main.cpp                                              */
+/*    Description:  仿真入口: 选自动 -> 跑 autonomous() -> 打印结果           */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+//
+// 用法: build/sim/<工程名>_sim [--auto N] [--alliance 1|-1|0] [--limit 秒]
+//                             [--x mm] [--y mm] [--heading 度]
+//                             [--noise k] [--seed n] [--trace out.csv]
+//                             [--test profile --enc 度 | --test pursuit | --test zigzag
+//                              | --test boomerang | --test three_step | --test minspeed
+//                              | --test autotune_turn | --test autotune_drive [--relay 功率] [--rule 0-3]
+//                              | --test sorter [--ball-period 秒] | --test calibrate [--hue-shift 度]
+//                              | --test jam [--jam intake|ball|shoot] [--jam-at 秒] [--jam-every 秒]
+//                              | --test capture | --test trace | --test taskprof | --test watchdog
+//                              | --test chain | --test odom | --test async]
+//                             [--link 1]  (日志帧等待 stdin 上的确认, 配合 serial_rx.py --sim)
+//                             [--sd 目录] (Brain.SDcard 的主机目录, 比赛记录仪写到这里)
+//
+// src/main.cpp 在仿真构建里以 -Dmain=vex_main 编译, 这里不走 pre_auton()
+// 的屏幕选择, 直接设置 Auto/Alliance 后调用 autonomous()。
+// --test 改为运行 void.h 中对应的测试函数(如 test_profile)。
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+
+#include "vex.h"
+#include "sim.h"
+
+extern int Auto, Alliance, Side;
+extern bool drive_ff_fitted;
+void autonomous(void);
+void test_profile(double enc);
+void test_pursuit(bool zigzag);
+void test_boomerang(bool three_step);
+void test_minspeed();
+void test_autotune_turn(float relay, int rule);
+void test_autotune_drive(float relay, int rule);
+void test_sorter();
+void Get_Ball(float spd);
+void ball_calib_reset();
+void ball_calib_capture(int color, int ms);
+void ball_calib_finish();
+bool ball_models_load();
+void test_jam();
+void test_capture();
+void test_watchdog();
+bool test_async();
+void test_chain();
+void test_odom(float *pose);
+void trace_dump();
+void task_prof_reset();
+void task_prof_report();
+void recorder_close();
+void recorder_report();
+
+static int sim_auto = 1;
+static int sim_alliance = 1;
+static const char *sim_test = 0;
+static double sim_enc = 1000;
+static float sim_relay = 30;
+static int sim_rule = 3;   // TUNE_NO_OVERSHOOT
+static const char *sim_jam = "intake";
+static double sim_jam_at = 0, sim_jam_every = 0;
+static const char *sim_sd = 0;
+
+static void report(const char *result)
+{
+  // 超时是在调度器内部回调的, 不能再等写卡任务, 只在正常结束时收尾
+  if (sim_sd && strcmp(result, "timeout")) {
+    recorder_close();
+    recorder_report();
+  }
+  sim::Pose p = sim::pose();
+  sim::Stats s = sim::stats();
+  printf("sim: auto=%d alliance=%d result=%s time=%.3fs pose=(%.0f,%.0f,%.1f) walls=%d pneumatics=%d balls=%d\n",
+         sim_auto, sim_alliance, result, sim::now_sec(), p.x, p.y, p.heading,
+         s.wall_contacts, s.pneumatic_changes, s.balls_seen);
+  fflush(stdout);
+}
+
+static void report_timeout() { report("timeout"); }
+
+static void run_autonomous()
+{
+  // pre_auton() 中与屏幕无关的部分
+  Gyro.setRotation(0.0, degrees);
+  Auto = sim_auto;
+  Alliance = sim_alliance;
+  Side = 1;
+  drive_ff_fitted = true;            // feedforward.h 的默认值即模型常数
+  if (sim_sd) ball_models_load();    // 插了卡才读上次的颜色标定
+
+  if (sim_test && !strcmp(sim_test, "profile")) {
+    test_profile(sim_enc);
+    report("done");
+    _exit(0);
+  }
+  if (sim_test && (!strcmp(sim_test, "pursuit") || !strcmp(sim_test, "zigzag"))) {
+    test_pursuit(!strcmp(sim_test, "zigzag"));
+    report("done");
+    _exit(0);
+  }
+  if (sim_test && (!strcmp(sim_test, "boomerang") || !strcmp(sim_test, "three_step"))) {
+    test_boomerang(!strcmp(sim_test, "three_step"));
+    report("done");
+    _exit(0);
+  }
+  if (sim_test && !strcmp(sim_test, "autotune_turn")) {
+    test_autotune_turn(sim_relay, sim_rule);
+    report("done");
+    _exit(0);
+  }
+  if (sim_test && !strcmp(sim_test, "autotune_drive")) {
+    test_autotune_drive(sim_relay, sim_rule);
+    report("done");
+    _exit(0);
+  }
+  if (sim_test && (!strcmp(sim_test, "sorter") || !strcmp(sim_test, "calibrate"))) {
+    if (!strcmp(sim_test, "calibrate")) {
+      // 颜色标定: 先只来红球、再只来蓝球, 标定结果直接用于随后的分球测试
+      ball_calib_reset();
+      Get_Ball(1);
+      sim::set_ball_colors(1);
+      ball_calib_capture(1, 4000);
+      sim::set_ball_colors(-1);
+      vex::task::sleep(1500);        // 先把通道里的红球送完
+      ball_calib_capture(-1, 4000);
+      Get_Ball(0);
+      ball_calib_finish();
+      vex::task::sleep(500);
+      sim::set_ball_colors(0);
+      sim::reset_balls();            // 标定留在通道里的球不计入分球结果
+    }
+    test_sorter();
+    // 模型侧真值: 己方球应全部送出, 对方球应全部排出
+    sim::Stats s = sim::stats();
+    bool red = sim_alliance != -1;
+    printf("sorter: alliance=%d balls=%d own_kept=%d own_ejected=%d opp_kept=%d opp_ejected=%d\n",
+           sim_alliance, s.balls_seen,
+           red ? s.kept_red : s.kept_blue, red ? s.ejected_red : s.ejected_blue,
+           red ? s.kept_blue : s.kept_red, red ? s.ejected_blue : s.ejected_red);
+    report("done");
+    _exit(0);
+  }
+  if (sim_test && !strcmp(sim_test, "jam")) {
+    test_jam();
+    sim::Stats s = sim::stats();
+    printf("jam: motor=%s jams=%d cleared=%d balls=%d\n", sim_jam, s.jams, s.jams_cleared, s.balls_seen);
+    report("done");
+    _exit(0);
+  }
+  if (sim_test && !strcmp(sim_test, "capture")) {
+    test_capture();
+    report("done");
+    _exit(0);
+  }
+  if (sim_test && !strcmp(sim_test, "chain")) {
+    test_chain();
+    report("done");
+    _exit(0);
+  }
+  if (sim_test && !strcmp(sim_test, "odom")) {
+    // 模型真值换到出发点坐标系(原点为出发位置, 航向 0 为出发航向), 与里程计比较
+    sim::Pose p0 = sim::pose();
+    float odom[3];
+    test_odom(odom);
+    sim::Pose p1 = sim::pose();
+    double h0 = p0.heading * M_PI / 180.0, dx = p1.x - p0.x, dy = p1.y - p0.y;
+    double tx = dx * cos(h0) - dy * sin(h0), ty = dx * sin(h0) + dy * cos(h0);
+    printf("odom: true x=%.1f y=%.1f theta=%.2f pos_err=%.2fmm heading_err=%.2f\n",
+           tx, ty, p1.heading - p0.heading, hypot(odom[0] - tx, odom[1] - ty),
+           odom[2] - (p1.heading - p0.heading));
+    report("done");
+    _exit(0);
+  }
+  if (sim_test && !strcmp(sim_test, "watchdog")) {
+    test_watchdog();
+    report("done");
+    _exit(0);
+  }
+  if (sim_test && !strcmp(sim_test, "async")) {
+    bool ok = test_async();
+    report(ok ? "done" : "fail");
+    _exit(ok ? 0 : 1);
+  }
+  if (sim_test && !strcmp(sim_test, "trace")) {
+    autonomous();                    // AutoPro() 记录时间线
+    trace_dump();
+    report("done");
+    _exit(0);
+  }
+  if (sim_test && !strcmp(sim_test, "taskprof")) {
+    task_prof_reset();
+    autonomous();
+    task_prof_report();
+    report("done");
+    _exit(0);
+  }
+  if (sim_test && !strcmp(sim_test, "minspeed")) {
+    test_minspeed();
+    report("done");
+    _exit(0);
+  }
+  autonomous();
+  report("done");
+  _exit(0);
+}
+
+int main(int argc, char **argv)
+{
+  sim::PlantConfig cfg = sim::default_config();
+  double limit = 15, x = 900, y = 450, heading = 0;
+  const char *trace = 0;
+  bool link = false;
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const char *key = argv[i], *val = argv[i + 1];
+    if (!strcmp(key, "--auto")) sim_auto = atoi(val);
+    else if (!strcmp(key, "--alliance")) sim_alliance = atoi(val);
+    else if (!strcmp(key, "--limit")) limit = atof(val);
+    else if (!strcmp(key, "--x")) x = atof(val);
+    else if (!strcmp(key, "--y")) y = atof(val);
+    else if (!strcmp(key, "--heading")) heading = atof(val);
+    else if (!strcmp(key, "--noise")) cfg.noise = atof(val);
+    else if (!strcmp(key, "--seed")) cfg.seed = (uint32_t)atoi(val);
+    else if (!strcmp(key, "--ball-period")) cfg.ball_period = atof(val);
+    else if (!strcmp(key, "--hue-shift")) cfg.hue_shift = atof(val);
+    else if (!strcmp(key, "--jam")) sim_jam = val;
+    else if (!strcmp(key, "--jam-at")) sim_jam_at = atof(val);
+    else if (!strcmp(key, "--jam-every")) sim_jam_every = atof(val);
+    else if (!strcmp(key, "--trace")) trace = val;
+    else if (!strcmp(key, "--link")) link = atoi(val) != 0;
+    else if (!strcmp(key, "--sd")) sim_sd = val;
+    else if (!strcmp(key, "--test")) sim_test = val;
+    else if (!strcmp(key, "--enc")) sim_enc = atof(val);
+    else if (!strcmp(key, "--relay")) sim_relay = atof(val);
+    else if (!strcmp(key, "--rule")) sim_rule = atoi(val);
+    else { fprintf(stderr, "unknown option %s\n", key); return 1; }
+  }
+
+  sim::configure(cfg);
+  motor *left[3]  = { &LeftRun_1, &LeftRun_2, &LeftRun_3 };
+  motor *right[3] = { &RightRun_1, &RightRun_2, &RightRun_3 };
+  sim::attach_drive(left, right);
+  sim::attach_intake(&Intake_1, &Ball_1);
+  sim::attach_optical(Color_2, 100);  // 进球口下方
+  sim::attach_optical(Color, 180);    // 进球口上方
+  sim::attach_optical(Color_3, 320);  // 吐球口
+  sim::attach_distance(Distance1, 200, -100);
+  sim::attach_distance(Distance2, 200, 100);
+  if (sim_jam_at > 0) {
+    motor *jam = !strcmp(sim_jam, "ball") ? &Ball_1 : !strcmp(sim_jam, "shoot") ? &Shoot_1 : &Intake_1;
+    sim::set_jam(jam, sim_jam_at, sim_jam_every);
+  }
+  sim::set_pose(x, y, heading);
+  sim::set_trace_file(trace);
+  sim::set_link(link);
+  sim::set_sd_dir(sim_sd);
+  sim::set_competition(true, true);
+  sim::set_time_limit(limit, report_timeout);
+
+  sim::run_main(run_autonomous);
+  return 0;
+}
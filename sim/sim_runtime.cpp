@@ -0,0 +1,1052 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       sim_runtime.cpp                                           */
+/*    Description:  虚拟时钟任务调度 + 底盘/机构/传感器模型                   */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+//
+// 调度模型: 每个 vex::task/thread 对应一个宿主线程, 但同一时刻只有一个持有
+// 运行令牌。任务 sleep 时把令牌交给唤醒时间最早的任务, 虚拟时钟直接跳到该时刻,
+// 途中以 1ms 步长推进物理模型。不 sleep 的忙等循环靠每次设备读取计费
+// (SIM_CALL_US) 推进时间, 不会卡死仿真。
+//
+#include "sim.h"
+
+#include <math.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sim {
+
+///////////////////////////////////////////////////////////////////////////////
+// 调度器
+///////////////////////////////////////////////////////////////////////////////
+const uint64_t SIM_CALL_US = 20;   // 每次设备/计时器调用计入的虚拟耗时
+const uint64_t PHYS_STEP_US = 1000; // 物理模型步长
+
+struct TaskState {
+  int32_t id;
+  int  (*int_fn)(void);
+  void (*void_fn)(void);
+  int  (*int_arg_fn)(void *);
+  void (*void_arg_fn)(void *);
+  void *arg;
+  uint64_t wake_us;
+  uint64_t seq;
+  bool finished;
+  bool killed;
+  std::condition_variable cv;
+};
+
+struct KillSignal {};
+
+static std::mutex              g_mtx;
+static TaskState              *g_current = 0;
+static uint64_t                g_now_us = 0;
+static uint64_t                g_seq = 0;
+static uint64_t                g_next_other_wake = ~0ull;
+static int32_t                 g_next_id = 0;
+static thread_local TaskState *t_self = 0;
+
+static uint64_t  g_limit_us = ~0ull;
+static void    (*g_on_limit)(void) = 0;
+
+static void advance_to(uint64_t target_us);
+
+// 全局 task/thread 对象在静态初始化阶段就会创建任务, 列表必须先于它们构造
+static std::vector<TaskState*> &tasks()
+{
+  static std::vector<TaskState*> list;
+  return list;
+}
+
+static TaskState *new_task()
+{
+  TaskState *t = new TaskState();
+  t->id = g_next_id++;
+  t->int_fn = 0; t->void_fn = 0; t->int_arg_fn = 0; t->void_arg_fn = 0; t->arg = 0;
+  t->wake_us = g_now_us;
+  t->seq = ++g_seq;
+  t->finished = false;
+  t->killed = false;
+  return t;
+}
+
+// 选出下一个运行的任务(唤醒时间最早, 同时刻先来先服务)并交出令牌
+static void schedule(std::unique_lock<std::mutex> &lk, TaskState *self)
+{
+  std::vector<TaskState*> &list = tasks();
+  TaskState *next = 0;
+  for (size_t i = 0; i < list.size(); i++) {
+    TaskState *t = list[i];
+    if (t->finished) continue;
+    if (!next || t->wake_us < next->wake_us || (t->wake_us == next->wake_us && t->seq < next->seq))
+      next = t;
+  }
+  if (!next) return;
+  if (next->wake_us > g_now_us) advance_to(next->wake_us);
+
+  g_next_other_wake = ~0ull;
+  for (size_t i = 0; i < list.size(); i++) {
+    TaskState *t = list[i];
+    if (t != next && !t->finished && t->wake_us < g_next_other_wake) g_next_other_wake = t->wake_us;
+  }
+
+  g_current = next;
+  if (next == self) return;
+  next->cv.notify_one();
+  if (self && !self->finished) {
+    self->cv.wait(lk, [self] { return g_current == self; });
+  }
+}
+
+static void check_killed(TaskState *self)
+{
+  if (self && self->killed) throw KillSignal();
+}
+
+static void sleep_us(uint64_t us)
+{
+  TaskState *self = t_self;
+  if (!self) return;
+  {
+    std::unique_lock<std::mutex> lk(g_mtx);
+    self->wake_us = g_now_us + us;
+    self->seq = ++g_seq;
+    schedule(lk, self);
+  }
+  check_killed(self);
+}
+
+// 忙等循环的计费: 推进虚拟时间, 有其他任务到期就让出
+static void charge()
+{
+  TaskState *self = t_self;
+  if (!self) return;
+  advance_to(g_now_us + SIM_CALL_US);
+  if (g_next_other_wake <= g_now_us) sleep_us(0);
+}
+
+static void task_entry(TaskState *self)
+{
+  t_self = self;
+  {
+    std::unique_lock<std::mutex> lk(g_mtx);
+    self->cv.wait(lk, [self] { return g_current == self; });
+  }
+  try {
+    check_killed(self);
+    if (self->int_fn) self->int_fn();
+    else if (self->void_fn) self->void_fn();
+    else if (self->int_arg_fn) self->int_arg_fn(self->arg);
+    else if (self->void_arg_fn) self->void_arg_fn(self->arg);
+  } catch (KillSignal &) {
+  }
+  std::unique_lock<std::mutex> lk(g_mtx);
+  self->finished = true;
+  schedule(lk, self);
+}
+
+static TaskState *spawn(TaskState *t)
+{
+  {
+    std::lock_guard<std::mutex> lk(g_mtx);
+    t->wake_us = g_now_us;
+    t->seq = ++g_seq;
+    tasks().push_back(t);
+    if (t->wake_us < g_next_other_wake) g_next_other_wake = t->wake_us;
+  }
+  std::thread(task_entry, t).detach();
+  return t;
+}
+
+static void kill(TaskState *t)
+{
+  if (!t || t->finished) return;
+  t->killed = true;
+  check_killed(t == t_self ? t : 0);
+}
+
+void run_main(void (*fn)(void))
+{
+  TaskState *self = new_task();
+  t_self = self;
+  {
+    std::lock_guard<std::mutex> lk(g_mtx);
+    tasks().push_back(self);
+    g_current = self;
+  }
+  fn();
+}
+
+void set_time_limit(double seconds, void (*on_limit)(void))
+{
+  g_limit_us = (uint64_t)(seconds * 1e6);
+  g_on_limit = on_limit;
+}
+
+double now_sec() { return g_now_us / 1e6; }
+
+///////////////////////////////////////////////////////////////////////////////
+// 模型状态
+///////////////////////////////////////////////////////////////////////////////
+enum MotorMode { MODE_STOPPED, MODE_VOLTAGE, MODE_VELOCITY };
+enum MotorRole { ROLE_FREE, ROLE_LEFT, ROLE_RIGHT };
+
+struct MotorState {
+  int32_t         port;
+  vex::gearSetting gears;
+  MotorMode       mode;
+  vex::brakeType  brake_mode;
+  double          command;        // 电压模式: V; 速度模式: rpm
+  double          max_torque_pct;
+  double          pos_deg;        // 物理累计位置
+  double          pos_offset;     // resetPosition 记录的零点
+  double          hold_deg;
+  double          vel_rpm;
+  double          target_rpm;     // 本步期望转速(用于估算扭矩/电流)
+  MotorRole       role;
+};
+
+struct Ball {
+  double s;     // 沿吸球通道的位置(mm)
+  bool   red;
+};
+
+static const double BALL_MM = 50;   // 球径: 通道里相邻两球的最小间距
+
+struct OpticalMount { vex::optical *sensor; double path_mm; };
+struct DistanceMount { vex::distance *sensor; double forward_mm, lateral_mm; };
+
+static PlantConfig g_cfg = default_config();
+
+static std::vector<MotorState*> &motors()
+{
+  static std::vector<MotorState*> list;
+  return list;
+}
+
+static MotorState *g_left[3], *g_right[3];
+static MotorState *g_intake = 0, *g_ball = 0;
+static std::vector<OpticalMount>  g_opticals;
+static std::vector<DistanceMount> g_distances;
+
+static double g_x = 900, g_y = 450, g_heading = 0, g_heading0 = 0;
+static double g_left_rpm = 0, g_right_rpm = 0;
+static double g_pitch = 0;
+static bool   g_in_wall = false;
+static uint64_t g_phys_us = 0;
+
+static std::vector<Ball> g_balls;
+static double g_spawn_accum = 0;
+static int g_ball_mix = 0;
+static uint32_t g_rand = 1;
+
+static Stats g_stats = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+static MotorState *g_jam_motor = 0;
+static double g_jam_at = 0, g_jam_every = 0, g_jam_rev = 0;
+static bool g_jammed = false;
+static FILE *g_trace = 0;
+
+static bool g_comp_auto = true, g_comp_enabled = true;
+static void (*g_auto_cb)(void) = 0;
+static void (*g_driver_cb)(void) = 0;
+
+static uint64_t g_brain_base_us = 0;
+
+PlantConfig default_config()
+{
+  PlantConfig c;
+  c.wheel_mm_per_deg = M_PI * 82.55 / 360.0;
+  c.track_mm = 290;
+  c.turn_scrub = 1.25;
+  c.free_rpm = 200;
+  c.static_volt = 0.9;
+  c.tau_drive = 0.16;
+  c.tau_brake = 0.04;
+  c.tau_coast = 0.6;
+  c.field_mm = 3658;
+  c.robot_half_mm = 200;
+  c.noise = 0;
+  c.ball_period = 0.35;
+  c.hue_shift = 0;
+  c.seed = 1;
+  return c;
+}
+
+void configure(const PlantConfig &config)
+{
+  g_cfg = config;
+  g_rand = config.seed ? config.seed : 1;
+}
+
+static double frand() // [-1, 1)
+{
+  g_rand = g_rand * 1103515245u + 12345u;
+  return ((g_rand >> 8) & 0xFFFF) / 32768.0 - 1.0;
+}
+
+static double noise(double scale) { return g_cfg.noise > 0 ? frand() * g_cfg.noise * scale : 0; }
+
+static double cartridge_rpm(vex::gearSetting g)
+{
+  if (g == vex::gearSetting::ratio36_1) return 100;
+  if (g == vex::gearSetting::ratio6_1) return 600;
+  return 200;
+}
+
+// 单个电机在当前指令下的目标转速与时间常数
+static void motor_target(MotorState *m, double free_rpm, double tau_load, double &target, double &tau)
+{
+  double torque_scale = m->max_torque_pct / 100.0;
+  if (torque_scale < 0.05) torque_scale = 0.05;
+  if (m->mode == MODE_VOLTAGE) {
+    double v = m->command;
+    if (v > 12) v = 12;
+    if (v < -12) v = -12;
+    // 摩擦电压: 转动时总是阻碍转动方向; 静止时为死区
+    double eff;
+    if (fabs(m->vel_rpm) > 1) eff = v - (m->vel_rpm > 0 ? 1 : -1) * g_cfg.static_volt;
+    else if (fabs(v) > g_cfg.static_volt) eff = v - (v > 0 ? 1 : -1) * g_cfg.static_volt;
+    else eff = 0;
+    target = eff / (12 - g_cfg.static_volt) * free_rpm;
+    tau = tau_load;
+  } else if (m->mode == MODE_VELOCITY) {
+    target = m->command;
+    if (target > free_rpm) target = free_rpm;
+    if (target < -free_rpm) target = -free_rpm;
+    tau = tau_load * 0.6 / torque_scale;
+  } else if (m->brake_mode == vex::brakeType::hold) {
+    target = -(m->pos_deg - m->hold_deg) * 10.0;
+    tau = g_cfg.tau_brake;
+  } else if (m->brake_mode == vex::brakeType::brake) {
+    target = 0;
+    tau = g_cfg.tau_brake;
+  } else {
+    target = 0;
+    tau = g_cfg.tau_coast;
+  }
+  m->target_rpm = target;
+}
+
+static double side_accel(MotorState **side, double rpm)
+{
+  double acc = 0;
+  int n = 0;
+  for (int i = 0; i < 3; i++) {
+    if (!side[i]) continue;
+    double target, tau;
+    motor_target(side[i], g_cfg.free_rpm, g_cfg.tau_drive, target, tau);
+    acc += (target - rpm) / tau;
+    n++;
+  }
+  return n ? acc / n : 0;
+}
+
+static void step_balls(double dt)
+{
+  if (!g_intake) return;
+  double intake_speed = g_intake->vel_rpm * 0.5; // mm/s
+  double ball_speed = g_ball ? g_ball->vel_rpm * 0.5 : intake_speed;
+
+  if (g_intake->vel_rpm > 100) {
+    g_spawn_accum += dt;
+    // 新球要等上一个球让出一个球径才进得来(吸球减速时来球间隔随之拉长, 球不会叠在一起)
+    bool room = g_balls.empty() || g_balls.back().s >= BALL_MM;
+    if (g_spawn_accum > g_cfg.ball_period && room) {
+      g_spawn_accum = 0;
+      Ball b;
+      b.s = 0;
+      b.red = g_ball_mix ? g_ball_mix > 0 : frand() >= 0;
+      g_balls.push_back(b);
+      g_stats.balls_seen++;
+    }
+  }
+  for (size_t i = 0; i < g_balls.size();) {
+    Ball &b = g_balls[i];
+    double prev = b.s;
+    b.s += (b.s < SORT_GATE_MM ? intake_speed : ball_speed) * dt;
+    if (prev >= SORT_GATE_MM && b.s < SORT_GATE_MM) { // 被 Ball_1 退回分球口
+      if (b.red) g_stats.ejected_red++; else g_stats.ejected_blue++;
+      g_balls.erase(g_balls.begin() + i);
+    } else if (b.s > 420) {                            // 从通道末端送出
+      if (b.red) g_stats.kept_red++; else g_stats.kept_blue++;
+      g_balls.erase(g_balls.begin() + i);
+    } else if (b.s < -20) {
+      g_balls.erase(g_balls.begin() + i);
+    } else {
+      i++;
+    }
+  }
+}
+
+static void write_trace()
+{
+  if (!g_trace) return;
+  fprintf(g_trace, "%.3f,%.1f,%.1f,%.2f,%.1f,%.1f\n", g_phys_us / 1e6, g_x, g_y, g_heading,
+          g_left_rpm, g_right_rpm);
+}
+
+// 卡球: 卡住时正转被挡死, 反转一段时间把球退开后解除
+static void step_jam(MotorState *m, double dt)
+{
+  double t = g_phys_us / 1e6;
+  if (!g_jammed && g_jam_at > 0 && t >= g_jam_at && m->target_rpm > 0) {
+    g_jammed = true;
+    g_jam_rev = 0;
+    g_stats.jams++;
+  }
+  if (!g_jammed) return;
+  if (m->vel_rpm > 0) m->vel_rpm = 0;
+  if (m->vel_rpm < -30) g_jam_rev += dt;
+  if (g_jam_rev >= 0.05) {
+    g_jammed = false;
+    g_stats.jams_cleared++;
+    g_jam_at = g_jam_every > 0 ? t + g_jam_every : 0;
+  }
+}
+
+static void step_plant(double dt)
+{
+  // 底盘: 左右侧各自一阶响应, 差速部分受打滑系数拖慢
+  double al = side_accel(g_left, g_left_rpm);
+  double ar = side_accel(g_right, g_right_rpm);
+  double a_lin = (al + ar) / 2, a_ang = (al - ar) / 2 / g_cfg.turn_scrub;
+  g_left_rpm  += (a_lin + a_ang) * dt;
+  g_right_rpm += (a_lin - a_ang) * dt;
+
+  double mm_per_rpm_s = 6.0 * g_cfg.wheel_mm_per_deg;
+  double vl = g_left_rpm * mm_per_rpm_s, vr = g_right_rpm * mm_per_rpm_s;
+  double v = (vl + vr) / 2;
+  g_heading += (vl - vr) / g_cfg.track_mm * 180.0 / M_PI * dt;
+  double h = g_heading * M_PI / 180.0;
+  g_x += v * sin(h) * dt;
+  g_y += v * cos(h) * dt;
+  g_pitch = -a_lin * mm_per_rpm_s * 0.001;
+
+  // 撞墙: 夹住位置并吃掉直线速度, 电机近似堵转
+  double lo = g_cfg.robot_half_mm, hi = g_cfg.field_mm - g_cfg.robot_half_mm;
+  bool hit = false;
+  if (g_x < lo) { g_x = lo; hit = true; }
+  if (g_x > hi) { g_x = hi; hit = true; }
+  if (g_y < lo) { g_y = lo; hit = true; }
+  if (g_y > hi) { g_y = hi; hit = true; }
+  if (hit) {
+    double diff = (g_left_rpm - g_right_rpm) / 2;
+    g_left_rpm = diff;
+    g_right_rpm = -diff;
+    if (!g_in_wall) g_stats.wall_contacts++;
+  }
+  g_in_wall = hit;
+
+  for (int i = 0; i < 3; i++) {
+    if (g_left[i])  { g_left[i]->vel_rpm = g_left_rpm;   g_left[i]->pos_deg += g_left_rpm * 6 * dt; }
+    if (g_right[i]) { g_right[i]->vel_rpm = g_right_rpm; g_right[i]->pos_deg += g_right_rpm * 6 * dt; }
+  }
+
+  // 其余电机: 独立一阶响应
+  std::vector<MotorState*> &list = motors();
+  for (size_t i = 0; i < list.size(); i++) {
+    MotorState *m = list[i];
+    if (m->role != ROLE_FREE) continue;
+    double target, tau;
+    motor_target(m, cartridge_rpm(m->gears), 0.05, target, tau);
+    m->vel_rpm += (target - m->vel_rpm) / tau * dt;
+    if (m == g_jam_motor) step_jam(m, dt);
+    m->pos_deg += m->vel_rpm * 6 * dt;
+  }
+
+  step_balls(dt);
+}
+
+static void advance_to(uint64_t target_us)
+{
+  while (g_phys_us + PHYS_STEP_US <= target_us) {
+    g_phys_us += PHYS_STEP_US;
+    step_plant(PHYS_STEP_US / 1e6);
+    if (g_phys_us % 10000 == 0) write_trace();
+    if (g_phys_us >= g_limit_us) {
+      g_now_us = g_phys_us;
+      if (g_on_limit) g_on_limit();
+      fflush(stdout);
+      _exit(2);
+    }
+  }
+  if (target_us > g_now_us) g_now_us = target_us;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 仿真控制接口
+///////////////////////////////////////////////////////////////////////////////
+void attach_drive(vex::motor *left[3], vex::motor *right[3])
+{
+  for (int i = 0; i < 3; i++) {
+    g_left[i] = left[i]->simState();
+    g_right[i] = right[i]->simState();
+    g_left[i]->role = ROLE_LEFT;
+    g_right[i]->role = ROLE_RIGHT;
+  }
+}
+
+void attach_intake(vex::motor *intake, vex::motor *ball)
+{
+  g_intake = intake->simState();
+  g_ball = ball ? ball->simState() : 0;
+}
+
+void attach_distance(vex::distance &sensor, double forward_mm, double lateral_mm)
+{
+  DistanceMount m = { &sensor, forward_mm, lateral_mm };
+  g_distances.push_back(m);
+}
+
+void attach_optical(vex::optical &sensor, double path_mm)
+{
+  OpticalMount m = { &sensor, path_mm };
+  g_opticals.push_back(m);
+}
+
+void set_pose(double x_mm, double y_mm, double heading_deg)
+{
+  g_x = x_mm;
+  g_y = y_mm;
+  g_heading = g_heading0 = heading_deg;
+}
+
+Pose pose()
+{
+  Pose p = { g_x, g_y, g_heading };
+  return p;
+}
+
+void set_competition(bool autonomous, bool enabled)
+{
+  g_comp_auto = autonomous;
+  g_comp_enabled = enabled;
+}
+
+void set_trace_file(const char *path)
+{
+  if (g_trace) fclose(g_trace);
+  g_trace = path ? fopen(path, "w") : 0;
+  if (g_trace) fprintf(g_trace, "t,x,y,heading,left_rpm,right_rpm\n");
+}
+
+static bool g_link = false;
+
+void set_link(bool enabled)
+{
+  g_link = enabled;
+  if (enabled) setvbuf(stdout, NULL, _IOLBF, 0);   // 上位机按行收帧, 不能攒在缓冲里
+}
+
+static const char *g_sd_dir = 0;
+
+void set_sd_dir(const char *dir) { g_sd_dir = dir; }
+
+// SD 卡文件名 -> 主机路径
+static bool sd_path(const char *name, char *path, size_t n)
+{
+  if (!g_sd_dir) return false;
+  snprintf(path, n, "%s/%s", g_sd_dir, name);
+  return true;
+}
+
+Stats stats() { return g_stats; }
+
+void set_ball_colors(int mix) { g_ball_mix = mix; }
+
+void set_jam(vex::motor *m, double at_sec, double every_sec)
+{
+  g_jam_motor = m ? m->simState() : 0;
+  g_jam_at = at_sec;
+  g_jam_every = every_sec;
+  g_jammed = false;
+}
+
+void reset_balls()
+{
+  g_balls.clear();
+  g_spawn_accum = 0;
+  g_stats.balls_seen = 0;
+  g_stats.kept_red = g_stats.kept_blue = 0;
+  g_stats.ejected_red = g_stats.ejected_blue = 0;
+}
+
+static const OpticalMount *optical_mount(const vex::optical *sensor)
+{
+  for (size_t i = 0; i < g_opticals.size(); i++)
+    if (g_opticals[i].sensor == sensor) return &g_opticals[i];
+  return 0;
+}
+
+static const Ball *ball_at(const vex::optical *sensor)
+{
+  const OpticalMount *mount = optical_mount(sensor);
+  if (!mount) return 0;
+  for (size_t i = 0; i < g_balls.size(); i++)
+    if (fabs(g_balls[i].s - mount->path_mm) < 25) return &g_balls[i];
+  return 0;
+}
+
+// 颜色传感器事件: 与 VEX 的事件线程一样, 由独立任务每 1ms 检查一次接近状态的跳变
+struct OpticalEvents {
+  const vex::optical *sensor;
+  void (*detected)(void);
+  void (*lost)(void);
+  bool near;
+};
+static std::vector<OpticalEvents> g_optical_events;
+static vex::thread *g_event_thread = 0;
+
+static void optical_event_loop()
+{
+  while (true) {
+    for (size_t i = 0; i < g_optical_events.size(); i++) {
+      OpticalEvents &e = g_optical_events[i];
+      bool near = ball_at(e.sensor) != 0;
+      if (near != e.near) {
+        e.near = near;
+        if (near && e.detected) e.detected();
+        if (!near && e.lost) e.lost();
+      }
+    }
+    sleep_us(1000);
+  }
+}
+
+static OpticalEvents &optical_events(const vex::optical *sensor)
+{
+  for (size_t i = 0; i < g_optical_events.size(); i++)
+    if (g_optical_events[i].sensor == sensor) return g_optical_events[i];
+  OpticalEvents e = { sensor, 0, 0, false };
+  g_optical_events.push_back(e);
+  if (!g_event_thread) g_event_thread = new vex::thread(optical_event_loop);
+  return g_optical_events.back();
+}
+
+static double distance_reading(const vex::distance *sensor)
+{
+  for (size_t i = 0; i < g_distances.size(); i++) {
+    const DistanceMount &m = g_distances[i];
+    if (m.sensor != sensor) continue;
+    double h = g_heading * M_PI / 180.0;
+    double dx = sin(h), dy = cos(h);
+    double px = g_x + dx * m.forward_mm + dy * m.lateral_mm;
+    double py = g_y + dy * m.forward_mm - dx * m.lateral_mm;
+    double t = 1e9;
+    if (dx > 1e-6)  t = fmin(t, (g_cfg.field_mm - px) / dx);
+    if (dx < -1e-6) t = fmin(t, -px / dx);
+    if (dy > 1e-6)  t = fmin(t, (g_cfg.field_mm - py) / dy);
+    if (dy < -1e-6) t = fmin(t, -py / dy);
+    if (t < 0) t = 0;
+    return t > 2000 ? 9999 : t + noise(2);
+  }
+  return 9999;
+}
+
+} // namespace sim
+
+///////////////////////////////////////////////////////////////////////////////
+// vex API 实现
+///////////////////////////////////////////////////////////////////////////////
+namespace vex {
+
+using sim::MotorState;
+using sim::TaskState;
+
+const color color::black(0x000000);
+const color color::white(0xFFFFFF);
+const color color::red(0xFF0000);
+const color color::green(0x00FF00);
+const color color::blue(0x0000FF);
+const color color::yellow(0xFFFF00);
+const color color::orange(0xFFA500);
+const color color::purple(0xFF00FF);
+const color color::cyan(0x00FFFF);
+const color color::transparent(0x00000000);
+
+bool competition::bStopTasksBetweenModes = true;
+
+void wait(double time, timeUnits units)
+{
+  sim::sleep_us((uint64_t)(units == timeUnits::sec ? time * 1e6 : time * 1e3));
+}
+
+// ---- timer ----
+timer::timer() : _base_us(sim::g_now_us) {}
+void     timer::clear() { _base_us = sim::g_now_us; }
+void     timer::reset() { clear(); }
+double   timer::time(timeUnits units)
+{
+  sim::charge();
+  double us = (double)(sim::g_now_us - _base_us);
+  return units == timeUnits::sec ? us / 1e6 : us / 1e3;
+}
+double   timer::value() { return time(timeUnits::sec); }
+uint32_t timer::system() { sim::charge(); return (uint32_t)(sim::g_now_us / 1000); }
+uint64_t timer::systemHighResolution() { sim::charge(); return sim::g_now_us; }
+
+// ---- task / thread ----
+task::task() : _task(0) {}
+task::task(int (*callback)(void)) : _task(sim::new_task())
+{
+  _task->int_fn = callback;
+  sim::spawn(_task);
+}
+task::task(int (*callback)(void), int32_t) : task(callback) {}
+task::task(int (*callback)(void *), void *arg) : _task(sim::new_task())
+{
+  _task->int_arg_fn = callback;
+  _task->arg = arg;
+  sim::spawn(_task);
+}
+task::task(int (*callback)(void *), void *arg, int32_t) : task(callback, arg) {}
+
+void task::stop() { sim::kill(_task); }
+void task::stop(const task &t) { sim::kill(t._task); }
+void task::stop(int (*callback)(void))
+{
+  std::vector<TaskState*> &list = sim::tasks();
+  for (size_t i = 0; i < list.size(); i++)
+    if (list[i]->int_fn == callback && list[i] != sim::t_self) sim::kill(list[i]);
+}
+void task::sleep(uint32_t time) { sim::sleep_us((uint64_t)time * 1000); }
+
+thread::thread() : _task(0) {}
+thread::thread(void (*callback)(void)) : _task(sim::new_task())
+{
+  _task->void_fn = callback;
+  sim::spawn(_task);
+}
+thread::thread(int (*callback)(void)) : _task(sim::new_task())
+{
+  _task->int_fn = callback;
+  sim::spawn(_task);
+}
+thread::thread(void (*callback)(void *), void *arg) : _task(sim::new_task())
+{
+  _task->void_arg_fn = callback;
+  _task->arg = arg;
+  sim::spawn(_task);
+}
+thread::thread(int (*callback)(void *), void *arg) : _task(sim::new_task())
+{
+  _task->int_arg_fn = callback;
+  _task->arg = arg;
+  sim::spawn(_task);
+}
+void thread::join()
+{
+  while (_task && !_task->finished) sim::sleep_us(1000);
+}
+void thread::interrupt() { sim::kill(_task); }
+int32_t thread::get_id() { return _task ? _task->id : -1; }
+
+namespace this_thread {
+  void    sleep_for(uint32_t time_ms) { sim::sleep_us((uint64_t)time_ms * 1000); }
+  void    yield() { sim::sleep_us(0); }
+  int32_t get_id() { return sim::t_self ? sim::t_self->id : -1; }
+}
+
+void mutex::lock()
+{
+  while (_owned) sim::sleep_us(0);
+  _owned = true;
+}
+bool mutex::try_lock()
+{
+  if (_owned) return false;
+  _owned = true;
+  return true;
+}
+void mutex::unlock() { _owned = false; }
+
+// ---- brain ----
+double brain::timer(timeUnits units)
+{
+  sim::charge();
+  double us = (double)(sim::g_now_us - sim::g_brain_base_us);
+  return units == timeUnits::sec ? us / 1e6 : us / 1e3;
+}
+void brain::resetTimer() { sim::g_brain_base_us = sim::g_now_us; }
+
+// ---- motor ----
+motor::motor(int32_t index) : motor(index, gearSetting::ratio18_1, false) {}
+motor::motor(int32_t index, bool reverse) : motor(index, gearSetting::ratio18_1, reverse) {}
+motor::motor(int32_t index, gearSetting gears, bool reverse)
+{
+  (void)reverse; // 仿真只关心用户坐标系, 反转在真机上由固件处理
+  _state = new MotorState();
+  _state->port = index;
+  _state->gears = gears;
+  _state->mode = sim::MODE_STOPPED;
+  _state->brake_mode = brakeType::coast;
+  _state->command = 0;
+  _state->max_torque_pct = 100;
+  _state->pos_deg = 0;
+  _state->pos_offset = 0;
+  _state->hold_deg = 0;
+  _state->vel_rpm = 0;
+  _state->target_rpm = 0;
+  _state->role = sim::ROLE_FREE;
+  sim::motors().push_back(_state);
+}
+
+void motor::spin(directionType dir)
+{
+  _state->mode = sim::MODE_VELOCITY;
+  if (dir == directionType::rev) _state->command = -fabs(_state->command);
+  sim::charge();
+}
+void motor::spin(directionType dir, double velocity, velocityUnits units)
+{
+  setVelocity(velocity, units);
+  if (dir == directionType::rev) _state->command = -_state->command;
+  _state->mode = sim::MODE_VELOCITY;
+}
+void motor::spin(directionType dir, double voltage, voltageUnits units)
+{
+  double v = units == voltageUnits::mV ? voltage / 1000.0 : voltage;
+  _state->command = dir == directionType::rev ? -v : v;
+  _state->mode = sim::MODE_VOLTAGE;
+  sim::charge();
+}
+void motor::setVelocity(double velocity, velocityUnits units)
+{
+  double rpm = velocity;
+  if (units == velocityUnits::pct) rpm = velocity / 100.0 * sim::cartridge_rpm(_state->gears);
+  else if (units == velocityUnits::dps) rpm = velocity / 6.0;
+  _state->command = rpm;
+  sim::charge();
+}
+void motor::setVelocity(double velocity, percentUnits) { setVelocity(velocity, velocityUnits::pct); }
+void motor::setMaxTorque(double value, percentUnits) { _state->max_torque_pct = value; sim::charge(); }
+void motor::setStopping(brakeType mode) { _state->brake_mode = mode; }
+void motor::stop() { stop(_state->brake_mode); }
+void motor::stop(brakeType mode)
+{
+  if (_state->mode != sim::MODE_STOPPED || _state->brake_mode != mode) _state->hold_deg = _state->pos_deg;
+  _state->mode = sim::MODE_STOPPED;
+  _state->brake_mode = mode;
+  sim::charge();
+}
+void motor::resetPosition() { _state->pos_offset = _state->pos_deg; sim::charge(); }
+void motor::setPosition(double value, rotationUnits units)
+{
+  double d = units == rotationUnits::rev ? value * 360 : value;
+  _state->pos_offset = _state->pos_deg - d;
+  sim::charge();
+}
+double motor::position(rotationUnits units)
+{
+  sim::charge();
+  double d = _state->pos_deg - _state->pos_offset + sim::noise(0.5);
+  return units == rotationUnits::rev ? d / 360.0 : d;
+}
+double motor::velocity(velocityUnits units)
+{
+  sim::charge();
+  double rpm = _state->vel_rpm;
+  if (units == velocityUnits::pct) return rpm / sim::cartridge_rpm(_state->gears) * 100.0;
+  if (units == velocityUnits::dps) return rpm * 6.0;
+  return rpm;
+}
+double motor::velocity(percentUnits) { return velocity(velocityUnits::pct); }
+double motor::torque(torqueUnits)
+{
+  sim::charge();
+  double slip = fabs(_state->target_rpm - _state->vel_rpm) / sim::cartridge_rpm(_state->gears);
+  return fmin(slip, 1.0) * 2.1 * _state->max_torque_pct / 100.0;
+}
+double motor::current(currentUnits) { return torque() / 2.1 * 2.5; }
+double motor::voltage(voltageUnits units)
+{
+  double v = _state->mode == sim::MODE_VOLTAGE ? _state->command : 0;
+  return units == voltageUnits::mV ? v * 1000 : v;
+}
+double motor::temperature(temperatureUnits) { return 35; }
+int32_t motor::index() { return _state->port; }
+
+// ---- digital_out ----
+digital_out::digital_out(triport::port &port) : _port(port.index), _value(false) {}
+void digital_out::set(bool value)
+{
+  if (value != _value) sim::g_stats.pneumatic_changes++;
+  _value = value;
+  sim::charge();
+}
+int32_t digital_out::value() { return _value ? 1 : 0; }
+
+// ---- inertial ----
+inertial::inertial(int32_t) : _rotation_offset(0) {}
+void   inertial::startCalibration(int32_t) {}
+bool   inertial::isCalibrating() { return false; }
+void   inertial::setRotation(double value, rotationUnits)
+{
+  _rotation_offset = value - (sim::g_heading - sim::g_heading0);
+}
+void   inertial::setHeading(double value, rotationUnits units) { setRotation(value, units); }
+void   inertial::resetRotation() { setRotation(0, rotationUnits::deg); }
+double inertial::rotation(rotationUnits)
+{
+  sim::charge();
+  return sim::g_heading - sim::g_heading0 + _rotation_offset + sim::noise(0.05);
+}
+double inertial::heading(rotationUnits units)
+{
+  double h = fmod(rotation(units), 360.0);
+  return h < 0 ? h + 360 : h;
+}
+double inertial::orientation(orientationType axis, rotationUnits units)
+{
+  if (axis == orientationType::pitch) return pitch(units);
+  if (axis == orientationType::yaw) return yaw(units);
+  return roll(units);
+}
+double inertial::pitch(rotationUnits) { sim::charge(); return sim::g_pitch; }
+double inertial::roll(rotationUnits) { sim::charge(); return 0; }
+double inertial::yaw(rotationUnits units)
+{
+  double h = heading(units);
+  return h > 180 ? h - 360 : h;
+}
+
+// ---- optical ----
+optical::optical(int32_t index) : _index(index) {}
+color optical::color()
+{
+  sim::charge();
+  const sim::Ball *b = sim::ball_at(this);
+  if (!b) return vex::color::black;
+  return b->red ? vex::color::red : vex::color::blue;
+}
+bool optical::isNearObject() { sim::charge(); return sim::ball_at(this) != 0; }
+double optical::hue()
+{
+  sim::charge();
+  const sim::Ball *b = sim::ball_at(this);
+  double h = (b ? (b->red ? 5 : 215) + sim::noise(8) : 40 + sim::noise(10)) + sim::g_cfg.hue_shift;
+  return fmod(fmod(h, 360) + 360, 360);
+}
+double optical::brightness(bool) { sim::charge(); return sim::ball_at(this) ? 60 : 5; }
+optical::rgbc optical::getRgb(bool)
+{
+  // 球: 饱和度约 0.7; 无球(看到对面的结构): 饱和度约 0.1, 按 HSV 换算成 RGB
+  sim::charge();
+  const sim::Ball *b = sim::ball_at(this);
+  double h = (b ? (b->red ? 5 : 215) + sim::noise(8) : 40 + sim::noise(10)) + sim::g_cfg.hue_shift;
+  double sat = b ? 0.7 + sim::noise(0.1) : 0.1 + sim::noise(0.05);
+  double v = b ? 0.6 : 0.05;
+  h = fmod(fmod(h, 360) + 360, 360) / 60;
+  double c = v * sat, x = c * (1 - fabs(fmod(h, 2) - 1)), m = v - c;
+  double r = 0, g = 0, bl = 0;
+  if (h < 1) { r = c; g = x; } else if (h < 2) { r = x; g = c; } else if (h < 3) { g = c; bl = x; }
+  else if (h < 4) { g = x; bl = c; } else if (h < 5) { r = x; bl = c; } else { r = c; bl = x; }
+  rgbc out = { (r + m) * 255, (g + m) * 255, (bl + m) * 255, v * 100 };
+  return out;
+}
+void optical::setLightPower(int32_t, percentUnits) {}
+void optical::integrationTime(double) {}
+void optical::objectDetected(void (*callback)(void)) { sim::optical_events(this).detected = callback; }
+void optical::objectLost(void (*callback)(void)) { sim::optical_events(this).lost = callback; }
+
+// ---- distance ----
+distance::distance(int32_t index) : _index(index) {}
+double distance::objectDistance(distanceUnits units)
+{
+  sim::charge();
+  double mm = sim::distance_reading(this);
+  if (mm >= 9999) return 9999;
+  if (units == distanceUnits::in) return mm / 25.4;
+  if (units == distanceUnits::cm) return mm / 10.0;
+  return mm;
+}
+bool distance::isObjectDetected() { return objectDistance(distanceUnits::mm) < 9999; }
+
+// ---- brain::sdcard ----
+bool brain::sdcard::isInserted() { sim::charge(); return sim::g_sd_dir != 0; }
+
+bool brain::sdcard::exists(const char *name)
+{
+  sim::charge();
+  char path[512];
+  return sim::sd_path(name, path, sizeof(path)) && access(path, F_OK) == 0;
+}
+
+int32_t brain::sdcard::size(const char *name)
+{
+  sim::charge();
+  char path[512];
+  if (!sim::sd_path(name, path, sizeof(path))) return 0;
+  FILE *f = fopen(path, "rb");
+  if (!f) return 0;
+  fseek(f, 0, SEEK_END);
+  int32_t n = (int32_t)ftell(f);
+  fclose(f);
+  return n;
+}
+
+static int32_t sd_write(const char *name, uint8_t *buffer, int32_t len, const char *mode)
+{
+  sim::charge();
+  char path[512];
+  if (!sim::sd_path(name, path, sizeof(path))) return 0;
+  FILE *f = fopen(path, mode);
+  if (!f) return 0;
+  int32_t n = (int32_t)fwrite(buffer, 1, len, f);
+  fclose(f);
+  return n;
+}
+
+int32_t brain::sdcard::savefile(const char *name, uint8_t *buffer, int32_t len) { return sd_write(name, buffer, len, "wb"); }
+int32_t brain::sdcard::appendfile(const char *name, uint8_t *buffer, int32_t len) { return sd_write(name, buffer, len, "ab"); }
+
+int32_t brain::sdcard::loadfile(const char *name, uint8_t *buffer, int32_t len)
+{
+  sim::charge();
+  char path[512];
+  if (!sim::sd_path(name, path, sizeof(path))) return 0;
+  FILE *f = fopen(path, "rb");
+  if (!f) return 0;
+  int32_t n = (int32_t)fread(buffer, 1, len, f);
+  fclose(f);
+  return n;
+}
+
+// ---- competition ----
+void competition::autonomous(void (*callback)(void)) { sim::g_auto_cb = callback; }
+void competition::drivercontrol(void (*callback)(void)) { sim::g_driver_cb = callback; }
+bool competition::isAutonomous() { return sim::g_comp_auto; }
+bool competition::isDriverControl() { return !sim::g_comp_auto; }
+bool competition::isEnabled() { return sim::g_comp_enabled; }
+
+} // namespace vex
+
+///////////////////////////////////////////////////////////////////////////////
+// SDK C 接口
+///////////////////////////////////////////////////////////////////////////////
+
+// 上位机的确认是真实时间到达的, 没有数据时最多等 1ms 真实时间,
+// 主控侧每次等待也是 1ms 虚拟时间, 两边的超时大致对得上
+extern "C" int32_t vexSerialReadChar(uint32_t index)
+{
+  sim::charge();
+  if (index != 1 || !sim::g_link) return -1;
+  struct pollfd p = { 0, POLLIN, 0 };
+  if (poll(&p, 1, 1) <= 0) return -1;
+  unsigned char c;
+  if (read(0, &c, 1) != 1) {
+    sim::g_link = false;   // 上位机已关闭
+    return -1;
+  }
+  return c;
+}
@@ -62,6 +62,13 @@ extern bool auto_stop;
 //int auto_start=0;
 #include "vex.h"
 #include "void.h"
+#include "ball_color.h"
+#include "sorter.h"
+#include "jam.h"
+#include "capture.h"
+#include "pursuit.h"
+#include "boomerang.h"
+#include "autotune.h"
 #include "auto_All.h"
 //#include "auto_backup.h"
 #include "mainauto.h"
@@ -77,12 +84,14 @@ Brain.resetTimer();
 
 //Turn_Gyro(20);
 AutoPro();//手动放自动的点
+trace_dump();//输出时间线, 上位机 trace_export.py 转成 Chrome trace
 //////////////////////////////////////////////////////////////////////
 //button=2;
 }
 #include "joystick.h"
 // A global instance of competition
 competition Competition;
+#include "recorder.h"   // 按 Competition 的阶段记录, 放在它之后
 
 // define your global instances of motors and other devices here
 
@@ -106,6 +115,7 @@ void pre_auton(void) {
   while (Gyro.isCalibrating()) { task::sleep(50); }
   Gyro.setRotation(0.0, degrees);
   start_roll=Gyro.orientation(roll, degrees);
+  ball_models_load();   // 上次现场标定的颜色阈值(ball_color.h), 没有时用默认值
   wait(100);
   if (Gyro.rotation(degrees)!=0)
   { Controller1.rumble("-");
@@ -153,7 +163,7 @@ void autonomous(void) {
   Basket.set(true);
   auto_control=1;
   driver_control=0;
-  ColorThread=thread(Color_Control);
+  // 分球线程(sorter.h 的 ColorThread)上电时已启动, 这里不再重复创建
 // ..........................................................................
   AutoPro();
   //Side=1;
@@ -177,6 +187,8 @@ void autonomous(void) {
   //test_turn_side();
   //Run_wall(-50,2000,3);
   //test_minspeed();
+  //test_autotune_turn();
+  //test_autotune_drive();
 
   // Insert autonomous user code here.
   // ..........................................................................
@@ -196,6 +208,7 @@ void usercontrol(void) {
   // User control code here, inside the loop
   Up.set(false);
   Basket.set(true);
+  motion_reset();   // 自动阶段没走完的后台运动在这里结束
   RunStop(coast);
 
   task::stop (AutoTask);
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+"""
+VEX V5 span trace exporter (see include/trace.h)
+================================================
+Finds every trace_v1 block in a captured session (terminal copy, or the
+out.csv written by serial_rx.py) and writes Chrome trace_event JSON. Open the
+result in chrome://tracing or https://ui.perfetto.dev to see the autonomous
+as a flame chart, one row per task.
+
+  B/E events -> duration spans (Run_gyro, Turn_Gyro_new, wait, ...)
+  i events   -> instant markers (Get_Ball, ball_low, ball_up)
+  thread names from trace_thread() become thread_name metadata
+
+A span still open at the end of the trace (cut off by the time limit) is
+closed at the last event; an end without its begin (span started before
+trace_start) is dropped. Each trace_v1 block becomes its own process row.
+
+Usage:
+  python3 trace_export.py                       # out.csv -> trace.json
+  python3 trace_export.py session.txt -o auto.json
+"""
+
+from __future__ import annotations
+import argparse
+import json
+import re
+from pathlib import Path
+
+from log_codec import TRACE_MARKER, decode_frame, decode_trace
+
+
+def parse_traces(lines: list[str]) -> list[tuple[list, int]]:
+    """Text lines -> [(frames of one trace_v1 block, events announced by its footer or -1)]."""
+    blocks, i = [], 0
+    while i < len(lines):
+        if lines[i].strip() != TRACE_MARKER:
+            i += 1
+            continue
+        i += 1
+        frames, expected = [], -1
+        while i < len(lines):
+            row = lines[i].strip()
+            if row == TRACE_MARKER:
+                break
+            i += 1
+            if row.startswith("~"):
+                frames.append(decode_frame(row))
+            elif row.startswith("---"):
+                m = re.search(r"events\s+(\d+)", row)
+                expected = int(m.group(1)) if m else -1
+                break
+        blocks.append((frames, expected))
+    return blocks
+
+
+def to_chrome(res, pid: int) -> list[dict]:
+    """One decoded trace -> trace_event dicts (timestamps in microseconds)."""
+    out = [{"name": "process_name", "ph": "M", "pid": pid, "tid": 0, "args": {"name": f"trace {pid}"}}]
+    for task, name in sorted(res.threads.items()):
+        out.append({"name": "thread_name", "ph": "M", "pid": pid, "tid": task, "args": {"name": name}})
+    open_spans: dict[int, list[str]] = {}
+    last = 0
+    for ts, task, phase, name, arg in res.events:
+        last = max(last, ts)
+        ev = {"name": name, "ph": phase, "ts": ts, "pid": pid, "tid": task}
+        if phase == "B":
+            open_spans.setdefault(task, []).append(name)
+            ev["args"] = {"arg": arg}
+        elif phase == "E":
+            stack = open_spans.get(task, [])
+            if name not in stack:
+                continue
+            # spans nest per task; close anything left open inside this one first
+            while stack[-1] != name:
+                out.append({"name": stack.pop(), "ph": "E", "ts": ts, "pid": pid, "tid": task})
+            stack.pop()
+        elif phase == "i":
+            ev["s"] = "t"
+            ev["args"] = {"arg": arg}
+        out.append(ev)
+    for task, stack in open_spans.items():
+        while stack:
+            out.append({"name": stack.pop(), "ph": "E", "ts": last, "pid": pid, "tid": task,
+                        "args": {"truncated": True}})
+    return out
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Convert VEX V5 trace_v1 blocks to Chrome trace_event JSON")
+    ap.add_argument("file", nargs="?", default="out.csv", help="captured session (default out.csv)")
+    ap.add_argument("-o", "--out", default="trace.json", help="output JSON (default trace.json)")
+    args = ap.parse_args()
+
+    lines = Path(args.file).read_text(errors="replace").splitlines()
+    events: list[dict] = []
+    blocks = parse_traces(lines)
+    for pid, (frames, expected) in enumerate(blocks, 1):
+        res = decode_trace(frames)
+        missing = max(res.missing_events, expected - len(res.events) if expected >= 0 else 0)
+        spans = sum(1 for e in res.events if e[2] == "B")
+        end = res.events[-1][0] / 1e6 if res.events else 0
+        print(f"trace {pid}: events={len(res.events)} spans={spans} threads={len(res.threads)} "
+              f"span={end:.3f}s missing={missing}")
+        for w in res.warnings:
+            print(f"  warning: {w}")
+        events.extend(to_chrome(res, pid))
+    if not blocks:
+        raise SystemExit(f"no {TRACE_MARKER} block in {args.file}")
+
+    with open(args.out, "w") as fp:
+        json.dump({"traceEvents": events, "displayTimeUnit": "ms"}, fp)
+    print(f"-> {args.out}")
+
+
+if __name__ == "__main__":
+    main()
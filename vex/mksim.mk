@@ -0,0 +1,165 @@
+# host-side simulation build (make sim)
+#
+# 用主机 g++ 编译 src/ 与 include/ 的全部代码, vex.h 中的 v5.h/v5_vcs.h
+# 由 sim/include 下的替身提供, 设备全部接到 sim/sim_runtime.cpp 的模型上。
+
+SIM_BUILD = $(BUILD)/sim
+SIM_BIN   = $(SIM_BUILD)/$(PROJECT)_sim
+SIM_CXX   = g++
+SIM_FLAGS = -std=gnu++11 -O2 -pthread -DVEX_SIM -Wall
+SIM_INC   = -Isim/include $(addprefix -I, ${INC_F})
+
+SIM_SRC   = $(wildcard sim/*.cpp)
+SIM_OBJ   = $(addprefix $(SIM_BUILD)/, $(addsuffix .o, $(basename $(SRC_C))))
+SIM_OBJ  += $(addprefix $(SIM_BUILD)/, $(addsuffix .o, $(basename $(SIM_SRC))))
+SIM_H     = $(SRC_H) $(wildcard sim/include/*.h)
+
+# 工程代码: main() 改名, 由 sim_main.cpp 接管入口
+$(SIM_BUILD)/src/%.o: src/%.cpp $(SIM_H) $(SRC_A)
+	$(Q)$(MKDIR)
+	$(ECHO) "SIM $<"
+	$(Q)$(SIM_CXX) $(SIM_FLAGS) -Dmain=vex_main $(SIM_INC) -c -o $@ $<
+
+$(SIM_BUILD)/sim/%.o: sim/%.cpp $(SIM_H) $(SRC_A)
+	$(Q)$(MKDIR)
+	$(ECHO) "SIM $<"
+	$(Q)$(SIM_CXX) $(SIM_FLAGS) $(SIM_INC) -c -o $@ $<
+
+$(SIM_BIN): $(SIM_OBJ)
+	$(ECHO) "LINK $@"
+	$(Q)$(SIM_CXX) $(SIM_FLAGS) -o $@ $^
+
+sim: $(SIM_BIN)
+
+# 结果检查: 在输出文件里找匹配 $(1) 的行, 按 key=value 拆字段(数值在 f[], 原文在 s[]),
+# 条件 $(2) 成立即判越界并打印该行; 一行都没找到也算失败(测试没跑完)。条件里不能有逗号
+SIM_CHECK = awk '/$(1)/ { n++; split("", f); split("", s); \
+	  for (i = 1; i <= NF; i++) { j = index($$i, "="); if (j) { k = substr($$i, 1, j - 1); s[k] = substr($$i, j + 1); f[k] = s[k] + 0 } } \
+	  if ($(2)) { bad++; print "out of bound: " $$0 } } \
+	  END { if (!n) print "no line matching: $(1)"; exit (bad || !n) }'
+
+# 红蓝两方依次跑完 8 套自动, 每套一行结果, 超时判失败;
+# auto 5 的路线本身超过 15 秒(加仿真时就是 18 秒), 超时只提示, 路线改短后去掉这个例外
+sim-run: $(SIM_BIN)
+	$(Q)st=0; for a in 1 2 3 4 5 6 7 8; do for c in 1 -1; do \
+	  $(SIM_BIN) --auto $$a --alliance $$c $(SIM_ARGS) > $(SIM_BUILD)/run.out; cat $(SIM_BUILD)/run.out; \
+	  $(call SIM_CHECK,^sim:,s["result"] != "done" && !(f["auto"] == 5 && s["result"] == "timeout")) $(SIM_BUILD)/run.out || st=1; \
+	done; done; exit $$st
+
+# S 曲线直线: 不同距离前进+后退, 每段一行汇总(final_err 需在 3.5 度以内)
+sim-profile: $(SIM_BIN)
+	$(Q)st=0; for e in 100 300 600 1000 1500; do \
+	  $(SIM_BIN) --test profile --enc $$e --limit 60 $(SIM_ARGS) > $(SIM_BUILD)/profile.out; grep '^profile:' $(SIM_BUILD)/profile.out; \
+	  $(call SIM_CHECK,^profile:,f["final_err"] > 3.5 || f["final_err"] < -3.5) $(SIM_BUILD)/profile.out || st=1; \
+	done; exit $$st
+
+# 纯追踪 S 形路线, 与原地转向+直线逐段走的对照(end_err 需在 10mm 以内)
+sim-pursuit: $(SIM_BIN)
+	$(Q)st=0; for m in pursuit zigzag; do \
+	  $(SIM_BIN) --test $$m --limit 60 $(SIM_ARGS) > $(SIM_BUILD)/pursuit.out; grep '^pursuit:' $(SIM_BUILD)/pursuit.out; \
+	  $(call SIM_CHECK,^pursuit:,f["end_err"] > 10) $(SIM_BUILD)/pursuit.out || st=1; \
+	done; exit $$st
+
+# 到位姿一次到位, 与转向-直线-转向三段的对照(两种都要 pos_err 40mm、heading_err 3 度以内)
+sim-boomerang: $(SIM_BIN)
+	$(Q)st=0; for m in boomerang three_step; do \
+	  $(SIM_BIN) --test $$m --limit 60 $(SIM_ARGS) > $(SIM_BUILD)/boomerang.out; grep '^boomerang:' $(SIM_BUILD)/boomerang.out; \
+	  $(call SIM_CHECK,^boomerang:,f["pos_err"] > 40 || f["heading_err"] > 3 || f["heading_err"] < -3) $(SIM_BUILD)/boomerang.out || st=1; \
+	done; exit $$st
+
+# 底盘前馈特性: 电压斜坡+阶跃, 四组 kS/kV/kA 拟合结果(与模型常数 7.5/0.077/0.012 相差 10% 以内)
+sim-ff: $(SIM_BIN)
+	$(Q)$(SIM_BIN) --test minspeed --limit 200 $(SIM_ARGS) > $(SIM_BUILD)/ff.out; grep '^ff:' $(SIM_BUILD)/ff.out; \
+	$(call SIM_CHECK,^ff:,f["kS"] < 6.75 || f["kS"] > 8.25 || f["kV"] < 0.0693 || f["kV"] > 0.0847 || f["kA"] < 0.0108 || f["kA"] > 0.0132) $(SIM_BUILD)/ff.out
+
+# 继电自整定: 转向与直线各一次, 输出建议 PID 参数(要测到振荡: Ku > 0, Tu 在 0.2~1 秒)
+sim-autotune: $(SIM_BIN)
+	$(Q)st=0; for m in autotune_turn autotune_drive; do \
+	  $(SIM_BIN) --test $$m --limit 120 $(SIM_ARGS) > $(SIM_BUILD)/autotune.out; grep '^autotune:' $(SIM_BUILD)/autotune.out; \
+	  $(call SIM_CHECK,^autotune:,f["Ku"] <= 0 || f["Tu"] < 0.2 || f["Tu"] > 1) $(SIM_BUILD)/autotune.out || st=1; \
+	done; exit $$st
+
+# 分球: 红蓝两方在不同来球间隔下吸球 10 秒, 己方球应全部送出、对方球全部排出
+sim-sorter: $(SIM_BIN)
+	$(Q)st=0; for p in 0.35 0.25; do for c in 1 -1; do \
+	  $(SIM_BIN) --test sorter --alliance $$c --ball-period $$p --limit 60 $(SIM_ARGS) > $(SIM_BUILD)/sorter.out; grep '^sorter' $(SIM_BUILD)/sorter.out; \
+	  $(call SIM_CHECK,^sorter:,f["own_ejected"] > 0 || f["opp_kept"] > 0) $(SIM_BUILD)/sorter.out || st=1; \
+	done; done; exit $$st
+
+# 颜色标定: 场馆灯光色相偏移 40 度, 默认阈值与现场标定后的分球结果对照(默认阈值一轮只做对照, 不判);
+# 标定结果存到模拟 SD 卡, 再开机一次(同一张卡)只跑分球, 应读回标定值, 两轮都要分对
+sim-calibrate: $(SIM_BIN)
+	$(Q)st=0; for c in 1 -1; do rm -rf $(SIM_BUILD)/calib_sd; mkdir -p $(SIM_BUILD)/calib_sd; \
+	  $(SIM_BIN) --test sorter --alliance $$c --hue-shift 40 --limit 60 $(SIM_ARGS) | grep -E '^(sorter:|ball_model)'; \
+	  $(SIM_BIN) --test calibrate --alliance $$c --hue-shift 40 --limit 60 --sd $(SIM_BUILD)/calib_sd $(SIM_ARGS) > $(SIM_BUILD)/calibrate.out; \
+	  grep -E '^(sorter:|ball_model)' $(SIM_BUILD)/calibrate.out; \
+	  $(call SIM_CHECK,^(sorter:|ball_model: saved),f["own_ejected"] > 0 || f["opp_kept"] > 0 || (/saved/ && f["saved"] != 1)) $(SIM_BUILD)/calibrate.out || st=1; \
+	  $(SIM_BIN) --test sorter --alliance $$c --hue-shift 40 --limit 60 --sd $(SIM_BUILD)/calib_sd $(SIM_ARGS) > $(SIM_BUILD)/calibrate.out; \
+	  grep -E '^(sorter:|ball_model)' $(SIM_BUILD)/calibrate.out; \
+	  $(call SIM_CHECK,^(sorter:|ball_model: loaded),f["own_ejected"] > 0 || f["opp_kept"] > 0 || (/loaded/ && f["loaded"] != 1)) $(SIM_BUILD)/calibrate.out || st=1; \
+	done; exit $$st
+
+# 卡球保护: 吸球/分球电机分别在 1 秒时卡住, 之后每 1.5 秒再卡一次;
+# 每次都要解开(6 秒停机后才卡上的最后一次除外), 且没有电机被锁住
+sim-jam: $(SIM_BIN)
+	$(Q)st=0; for m in intake ball; do \
+	  $(SIM_BIN) --test jam --jam $$m --jam-at 1 --jam-every 1.5 --limit 60 $(SIM_ARGS) > $(SIM_BUILD)/jam.out; grep '^jam' $(SIM_BUILD)/jam.out; \
+	  $(call SIM_CHECK,^jam(_robot:|: motor=),f["hold"] > 0 || f["cleared"] < f["jams"] - 1) $(SIM_BUILD)/jam.out || st=1; \
+	done; exit $$st
+
+# 可靠串口传输: serial_rx.py 接收并确认日志帧, 人为丢弃/损坏 20% 的帧和确认, 应无缺失样本
+sim-link: $(SIM_BIN)
+	$(Q)python3 serial_rx.py --sim "$(SIM_BIN) --test profile --enc 1000 --limit 60 --link 1 $(SIM_ARGS)" \
+	  --out $(SIM_BUILD)/link.txt --loss 0.2 > $(SIM_BUILD)/link.out; grep -E '^(link|--- log end)' $(SIM_BUILD)/link.out; \
+	$(call SIM_CHECK,^link:,f["missing"] > 0 || f["samples"] == 0) $(SIM_BUILD)/link.out
+
+# 比赛记录仪: 跑一套自动, SD 卡写到 build/sim/sd, 再用 rec_read.py 解码(不能有丢帧、写错、损坏记录或缺失样本)
+sim-recorder: $(SIM_BIN)
+	$(Q)rm -rf $(SIM_BUILD)/sd && mkdir -p $(SIM_BUILD)/sd
+	$(Q)$(SIM_BIN) --auto 1 --sd $(SIM_BUILD)/sd $(SIM_ARGS) > $(SIM_BUILD)/recorder.out; grep -E '^(recorder|sim):' $(SIM_BUILD)/recorder.out; \
+	$(call SIM_CHECK,^(recorder|sim):,f["dropped"] > 0 || f["errors"] > 0 || (/^sim:/ && s["result"] != "done")) $(SIM_BUILD)/recorder.out
+	$(Q)python3 rec_read.py $(SIM_BUILD)/sd/rec_000.bin > $(SIM_BUILD)/rec_read.out; cat $(SIM_BUILD)/rec_read.out; \
+	$(call SIM_CHECK,damaged|missing=,(/damaged/ && !/ 0 damaged/) || f["missing"] > 0) $(SIM_BUILD)/rec_read.out
+
+# 异常窗口抓取: 倒车撞墙(堵转)后再往墙里开(关掉看门狗无进展检测, JAR 超时), 输出 wall_stall 和 jar_timeout 两个窗口
+sim-capture: $(SIM_BIN)
+	$(Q)$(SIM_BIN) --test capture --limit 60 $(SIM_ARGS) > $(SIM_BUILD)/capture.out; grep -E '^(capture|--- log end)' $(SIM_BUILD)/capture.out; \
+	$(call SIM_CHECK,^capture: windows=,f["windows"] != 2 || f["missed"] > 0) $(SIM_BUILD)/capture.out && \
+	$(call SIM_CHECK,^capture: window=1 reason=jar_timeout,0) $(SIM_BUILD)/capture.out
+
+# 时间线追踪: 跑一套自动后经可靠串口输出, 转成 build/sim/trace.json(chrome://tracing / Perfetto 打开)
+sim-trace: $(SIM_BIN)
+	$(Q)python3 serial_rx.py --sim "$(SIM_BIN) --test trace --auto 1 --limit 60 --link 1 $(SIM_ARGS)" \
+	  --out $(SIM_BUILD)/trace.txt > $(SIM_BUILD)/trace.out; grep -E '^(link|--- trace end)' $(SIM_BUILD)/trace.out; \
+	$(call SIM_CHECK,^link:,f["missing"] > 0 || f["events"] == 0) $(SIM_BUILD)/trace.out
+	$(Q)python3 trace_export.py $(SIM_BUILD)/trace.txt -o $(SIM_BUILD)/trace.json
+
+# 任务剖析: 跑一套自动后输出每个任务的运行时间/唤醒延迟/周期分布(自动要跑完, 统计表不能满)
+sim-taskprof: $(SIM_BIN)
+	$(Q)$(SIM_BIN) --test taskprof --auto 1 --limit 30 $(SIM_ARGS) > $(SIM_BUILD)/taskprof.out; grep -E '^(taskprof|sim):' $(SIM_BUILD)/taskprof.out; \
+	$(call SIM_CHECK,^(taskprof: window|sim:),f["full"] > 0 || (/^sim:/ && s["result"] != "done")) $(SIM_BUILD)/taskprof.out
+
+# 运动看门狗: 三段会卡住的运动(功率/速度为 0)应各在约 1 秒内(不超过 1.5 秒)被结束, 正常运动不触发
+sim-watchdog: $(SIM_BIN)
+	$(Q)$(SIM_BIN) --test watchdog --limit 30 $(SIM_ARGS) > $(SIM_BUILD)/watchdog.out; grep -E '^(watchdog|sim):' $(SIM_BUILD)/watchdog.out; \
+	$(call SIM_CHECK,^(watchdog|sim):,f["elapsed"] > 1.5 && /motion=/ || (/test/ && f["trips"] != 3) || (/^sim:/ && s["result"] != "done")) $(SIM_BUILD)/watchdog.out
+
+# 异步运动: 取消后的 Run_wall / Turn_Gyro 照常执行, motion_reset() 后同步运动不卡住(失败时退出码非 0)
+sim-async: $(SIM_BIN)
+	$(Q)$(SIM_BIN) --test async --limit 30 $(SIM_ARGS) > $(SIM_BUILD)/async.out; rc=$$?; \
+	grep -E '^(async|sim):' $(SIM_BUILD)/async.out; exit $$rc
+
+# 链式衔接: 两段直线链式相接, 总位移应等于两段目标之和(err 在稳定误差 3.5 以内);
+# 链式直线后接不支持链式的 Run_gyro_new, carry 应清零, 最后一段走 400
+sim-chain: $(SIM_BIN)
+	$(Q)$(SIM_BIN) --test chain --limit 60 $(SIM_ARGS) > $(SIM_BUILD)/chain.out; grep -E '^(chain|sim):' $(SIM_BUILD)/chain.out; \
+	$(call SIM_CHECK,^(chain|sim):,f["err"] > 3.5 || f["err"] < -3.5 || f["carry_out"] != 0 || f["carry_dist"] != 0 || (/last_moved/ && (f["last_moved"] > 403.5 || f["last_moved"] < 396.5)) || (/^sim:/ && s["result"] != "done")) $(SIM_BUILD)/chain.out
+
+# 里程计: 直线/转向/单侧转向/倒车后与模型真值对比(pos_err 应在 2mm、heading_err 0.5 度以内), 无噪声与有噪声各一次
+sim-odom: $(SIM_BIN)
+	$(Q)st=0; for n in 0 1; do \
+	  $(SIM_BIN) --test odom --noise $$n --seed 7 --limit 60 $(SIM_ARGS) > $(SIM_BUILD)/odom.out; grep '^odom: true' $(SIM_BUILD)/odom.out; \
+	  $(call SIM_CHECK,^odom: true,f["pos_err"] > 2 || f["heading_err"] > 0.5 || f["heading_err"] < -0.5) $(SIM_BUILD)/odom.out || st=1; \
+	done; exit $$st
+
+.PHONY: sim sim-run sim-profile sim-pursuit sim-boomerang sim-ff sim-autotune sim-sorter sim-calibrate sim-jam sim-link sim-recorder sim-capture sim-trace sim-taskprof sim-watchdog sim-chain sim-odom sim-async